@@ -0,0 +1,1981 @@
+/*
+ * @file bench.c
+ * @brief Throughput and latency benchmarks for jlite.
+ *
+ * Build from the repository root by compiling every .c file of bench/ and
+ * jlite/ and jlite/jsmn/, see README.md.
+ *
+ * Every corpus is generated in memory (see corpus.c), so runs need no data
+ * files. Results are written as one JSON object per line, which is stable
+ * across runs and easy to diff. Pass a previous result file with -b to get
+ * per-benchmark deltas printed on stderr.
+ *
+ * With -i DIR every document is also written to its own file under DIR
+ * and read back: ingest_read_parse is the plain open/read/jlite_parse_init
+ * loop, ingest_uring and ingest_pread use jlite_ingest_files(). The _cold
+ * variants first drop the files from the page cache, ingest_evict times
+ * that step alone so it can be subtracted.
+ *
+ * With -p every measurement also records cycles, instructions, branch and
+ * cache misses through perf_event_open (Linux), normalized per byte and per
+ * call. The phases are split so tokenizer and getter changes can be judged
+ * separately: tokenize_count (jsmn_parse without tokens), tokenize
+ * (jsmn_parse), their jsmn_variants.h counterparts tokenize_count_tpl,
+ * tokenize_tpl and tokenize_compact, parse (jlite_parse_init), traverse,
+ * hash (jlite_hash_tokens), project_first_key (jlite_parse_project),
+ * query_descend_first_key (jlite_query_run), cache_hit (jlite_cache_parse
+ * on repeats), msgpack_encode and msgpack_read (jlite_msgpack.h, bytes are
+ * those of the JSON form), inflate, inflate_then_parse, inflate_parse and
+ * inflate_parse_threaded (zlib input, jlite_inflate.h, bytes are those of
+ * the JSON form) and the get_* probes, get_last_key_shape with a
+ * jlite_shape_t attached, intern_document and the *_interned probes with
+ * the keys interned (jlite_intern.h).
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "corpus.h"
+#include "perf.h"
+#include "../jlite/jlite.h"
+#include "../jlite/jlite_lazy.h"
+#include "../jlite/jlite_validate.h"
+#include "../jlite/jlite_minify.h"
+#include "../jlite/jlite_hash.h"
+#include "../jlite/jlite_cache.h"
+#include "../jlite/jlite_shape.h"
+#include "../jlite/jlite_project.h"
+#include "../jlite/jlite_query.h"
+#include "../jlite/jlite_aggregate.h"
+#include "../jlite/jlite_columns.h"
+#include "../jlite/jlite_msgpack.h"
+#include "../jlite/jlite_inflate.h"
+#include "../jlite/jlite_ingest.h"
+#include "../jlite/jlite_index.h"
+#include "../jlite/jlite_intern.h"
+#include "../jlite/jsmn/jsmn_variants.h"
+
+#define BENCH_DEFAULT_WARMUP 2
+#define BENCH_DEFAULT_RUNS 10
+#define BENCH_MAX_RUNS 1000
+#define BENCH_PROBE_MIN_NS 2000000ULL
+#define BENCH_KEY_MAX 128
+#define BENCH_SHAPE_ENTRIES 256
+#define BENCH_INDEX_BYTES 4096
+#define BENCH_INTERN_ENTRIES 4096
+#define BENCH_INTERN_BYTES 65536
+#define BENCH_INGEST_DEPTH 32
+
+typedef struct
+{
+  int warmup;
+  int runs;
+  int scale;
+  FILE *out;
+  const char *baseline;
+  int profile;
+  const char *ingest_dir;
+  perf_group_t perf;
+} bench_opts_t;
+
+typedef struct
+{
+  uint64_t min_ns;
+  uint64_t median_ns;
+  uint64_t mean_ns;
+  perf_sample_t counters;
+} bench_result_t;
+
+/* One parsed document or NDJSON record. */
+typedef struct
+{
+  char *str;
+  int len;
+  jlitetok_t *tokens;
+  int num_tokens;
+  jliteobj_t obj;
+} bench_doc_t;
+
+typedef struct
+{
+  const char *name;
+  bench_doc_t *docs;
+  int num_docs;
+  size_t bytes;
+  long total_tokens;
+  jsmntok_compact_t *compact;
+  int max_tokens;
+  char *scratch;
+  int max_len;
+  jlite_hash_t *hashes;
+  jlite_cache_t cache;
+  jlitetok_t *project_tokens;
+  jlite_path_t project_path;
+  jlite_query_t query;
+  uint8_t *msgpack;
+  size_t *msgpack_off;
+  size_t *msgpack_len;
+  size_t msgpack_size;
+  char *msgpack_text;
+  int msgpack_text_len;
+  uint8_t *deflated;
+  size_t *deflated_off;
+  size_t *deflated_len;
+} bench_corpus_t;
+
+typedef struct
+{
+  char key[BENCH_KEY_MAX];
+  char field[BENCH_KEY_MAX];
+  jsmntype_t type;
+  jsmntype_t elem_type;
+  jsmntype_t field_type;
+  int elem_pos;
+} bench_probe_t;
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int bench_cmp_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+
+  return (x > y) - (x < y);
+}
+
+static void bench_summarize(uint64_t *samples, int runs, bench_result_t *res)
+{
+  uint64_t sum = 0;
+  int i = 0;
+
+  qsort(samples, (size_t) runs, sizeof(*samples), bench_cmp_u64);
+  for (i = 0; i < runs; i++)
+  {
+    sum += samples[i];
+  }
+  res->min_ns = samples[0];
+  res->median_ns = samples[runs / 2];
+  res->mean_ns = sum / (uint64_t) runs;
+}
+
+/*
+ * Split the corpus into documents and size a token array for each one with
+ * a counting pass of the tokenizer. None of this is timed.
+ */
+static int bench_corpus_load(bench_corpus_t *bc, const corpus_desc_t *desc,
+    corpus_buf_t *buf)
+{
+  jsmn_parser parser;
+  char *p = NULL;
+  char *end = NULL;
+  char *nl = NULL;
+  int cap = 0;
+  int ret = 0;
+  bench_doc_t *doc = NULL;
+
+  memset(bc, 0, sizeof(*bc));
+  bc->name = desc->name;
+  bc->bytes = buf->len;
+
+  p = buf->data;
+  end = buf->data + buf->len;
+  while (p < end)
+  {
+    nl = desc->ndjson ? memchr(p, '\n', (size_t) (end - p)) : NULL;
+    if (!nl)
+    {
+      nl = end;
+    }
+    if (nl == p)
+    {
+      p++;
+      continue;
+    }
+
+    if (bc->num_docs == cap)
+    {
+      cap = cap ? cap * 2 : 64;
+      bc->docs = realloc(bc->docs, (size_t) cap * sizeof(*bc->docs));
+      if (!bc->docs)
+      {
+        return -1;
+      }
+    }
+    doc = &bc->docs[bc->num_docs++];
+    memset(doc, 0, sizeof(*doc));
+    doc->str = p;
+    doc->len = (int) (nl - p);
+
+    jsmn_init(&parser);
+    ret = jsmn_parse(&parser, doc->str, (size_t) doc->len, NULL, 0);
+    if (ret <= 0)
+    {
+      fprintf(stderr, "%s: document %d does not tokenize (%d)\n",
+          desc->name, bc->num_docs - 1, ret);
+      return -1;
+    }
+    doc->num_tokens = ret;
+    doc->tokens = malloc((size_t) ret * sizeof(*doc->tokens));
+    if (!doc->tokens)
+    {
+      return -1;
+    }
+    bc->total_tokens += ret;
+    if (ret > bc->max_tokens)
+    {
+      bc->max_tokens = ret;
+    }
+    if (doc->len > bc->max_len)
+    {
+      bc->max_len = doc->len;
+    }
+    p = nl + 1;
+  }
+
+  /*
+   * Compact tokens, minified text, hashes and projected tokens are scratch
+   * for all documents.
+   */
+  bc->compact = malloc((size_t) bc->max_tokens * sizeof(*bc->compact));
+  bc->scratch = malloc((size_t) bc->max_len);
+  bc->hashes = malloc((size_t) bc->max_tokens * sizeof(*bc->hashes));
+  bc->project_tokens = malloc((size_t) bc->max_tokens *
+      sizeof(*bc->project_tokens));
+  if (!bc->compact || !bc->scratch || !bc->hashes || !bc->project_tokens)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+static void bench_corpus_free(bench_corpus_t *bc)
+{
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    free(bc->docs[i].tokens);
+  }
+  free(bc->docs);
+  free(bc->compact);
+  free(bc->scratch);
+  free(bc->hashes);
+  free(bc->project_tokens);
+  memset(bc, 0, sizeof(*bc));
+}
+
+typedef int (*bench_work_fn)(void *ctx);
+
+/*
+ * Run fn warmup + runs times, timing each run and, in profiling mode,
+ * accumulating hardware counters over the measured runs.
+ */
+static int bench_measure(bench_opts_t *opts, bench_work_fn fn, void *ctx,
+    bench_result_t *res)
+{
+  uint64_t samples[BENCH_MAX_RUNS];
+  uint64_t t0 = 0;
+  int measured = 0;
+  int ret = 0;
+  int i = 0;
+
+  memset(res, 0, sizeof(*res));
+  for (i = 0; i < opts->warmup + opts->runs; i++)
+  {
+    measured = i >= opts->warmup;
+    if (measured && opts->profile)
+    {
+      perf_group_start(&opts->perf);
+    }
+    t0 = bench_now_ns();
+    ret = fn(ctx);
+    if (measured)
+    {
+      samples[i - opts->warmup] = bench_now_ns() - t0;
+      if (opts->profile)
+      {
+        perf_group_stop(&opts->perf, &res->counters);
+      }
+    }
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+
+  bench_summarize(samples, opts->runs, res);
+  for (i = 0; i < PERF_NUM_COUNTERS; i++)
+  {
+    res->counters.values[i] /= (uint64_t) opts->runs;
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_tokenize_count(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jsmn_parser parser;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    jsmn_init(&parser);
+    if (jsmn_parse(&parser, bc->docs[i].str, (size_t) bc->docs[i].len,
+        NULL, 0) < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_tokenize_count_tpl(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jsmn_parser parser;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    jsmn_init(&parser);
+    if (jsmn_parse_count(&parser, bc->docs[i].str, (size_t) bc->docs[i].len,
+        NULL, 0) < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_validate(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_validate(bc->docs[i].str, bc->docs[i].len, NULL);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_minify_flags(bench_corpus_t *bc, int flags)
+{
+  int out_len = 0;
+  int ret = 0;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_minify(bc->docs[i].str, bc->docs[i].len, bc->scratch,
+        &out_len, flags);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_minify(void *ctx)
+{
+  return bench_work_minify_flags(ctx, 0);
+}
+
+static int bench_work_minify_validate(void *ctx)
+{
+  return bench_work_minify_flags(ctx, JLITE_MINIFY_VALIDATE);
+}
+
+static int bench_work_tokenize(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  bench_doc_t *doc = NULL;
+  jsmn_parser parser;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    doc = &bc->docs[i];
+    jsmn_init(&parser);
+    if (jsmn_parse(&parser, doc->str, (size_t) doc->len, doc->tokens,
+        (unsigned int) doc->num_tokens) < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_tokenize_tpl(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  bench_doc_t *doc = NULL;
+  jsmn_parser parser;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    doc = &bc->docs[i];
+    jsmn_init(&parser);
+    if (jsmn_parse_lenient(&parser, doc->str, (size_t) doc->len, doc->tokens,
+        (unsigned int) doc->num_tokens) < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_tokenize_compact(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  bench_doc_t *doc = NULL;
+  jsmn_parser parser;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    doc = &bc->docs[i];
+    jsmn_init(&parser);
+    if (jsmn_parse_compact(&parser, doc->str, (size_t) doc->len, bc->compact,
+        (unsigned int) doc->num_tokens) < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_parse(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  bench_doc_t *doc = NULL;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    doc = &bc->docs[i];
+    ret = jlite_parse_init(&doc->obj, doc->tokens, doc->num_tokens,
+        doc->str, doc->len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+/*
+ * Visit every token and convert every scalar the way the getters do, which
+ * approximates the cost of an application reading the whole document.
+ */
+static double bench_traverse(bench_doc_t *doc)
+{
+  char value_str[32];
+  double acc = 0;
+  int len = 0;
+  int i = 0;
+  jlitetok_t *tok = NULL;
+
+  for (i = 0; i < doc->obj.num_tokens; i++)
+  {
+    tok = &doc->obj.tokens[i];
+    len = tok->end - tok->start;
+    switch (tok->type)
+    {
+      case JSMN_PRIMITIVE:
+        if (len >= (int) sizeof(value_str))
+        {
+          len = sizeof(value_str) - 1;
+        }
+        memcpy(value_str, doc->str + tok->start, (size_t) len);
+        value_str[len] = '\0';
+        acc += atof(value_str);
+        break;
+      case JSMN_STRING:
+        acc += len;
+        break;
+      default:
+        acc += tok->size;
+        break;
+    }
+  }
+  return acc;
+}
+
+static int bench_work_traverse(void *ctx)
+{
+  static volatile double sink;
+  bench_corpus_t *bc = ctx;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    sink += bench_traverse(&bc->docs[i]);
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_hash(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_hash_tokens(&bc->docs[i].obj, bc->hashes, bc->max_tokens);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_project(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jliteobj_t obj;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_parse_project(&obj, bc->project_tokens, bc->max_tokens,
+        bc->docs[i].str, bc->docs[i].len, &bc->project_path, 1);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_query_count(jliteobj_t *jsonobj, int pos, void *ctx)
+{
+  (void) jsonobj;
+  (void) pos;
+  (*(long *) ctx)++;
+  return 0;
+}
+
+static int bench_work_query(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  long matches = 0;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_query_run(&bc->query, &bc->docs[i].obj, bench_query_count,
+        &matches, NULL);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_cache(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jliteobj_t obj;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_cache_parse(&bc->cache, &obj, bc->docs[i].str,
+        bc->docs[i].len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+    jlite_cache_release(&bc->cache, &obj);
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_msgpack_encode(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  size_t len = 0;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    bc->docs[i].obj.cur_pos = 1;
+    ret = jlite_msgpack_encode(&bc->docs[i].obj,
+        bc->msgpack + bc->msgpack_off[i], bc->msgpack_size -
+        bc->msgpack_off[i], &len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_msgpack_read(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jliteobj_t obj;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_msgpack_parse_init(&obj, bc->project_tokens, bc->max_tokens,
+        bc->msgpack + bc->msgpack_off[i], bc->msgpack_len[i],
+        bc->msgpack_text, bc->msgpack_text_len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_inflate(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  uLongf len = 0;
+  int i = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    len = (uLongf) bc->max_len;
+    if (uncompress((Bytef *) bc->scratch, &len, bc->deflated +
+        bc->deflated_off[i], (uLong) bc->deflated_len[i]) != Z_OK)
+    {
+      return -JLITE_ERR;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_inflate_then_parse(void *ctx)
+{
+  bench_corpus_t *bc = ctx;
+  jliteobj_t obj;
+  uLongf len = 0;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    len = (uLongf) bc->max_len;
+    if (uncompress((Bytef *) bc->scratch, &len, bc->deflated +
+        bc->deflated_off[i], (uLong) bc->deflated_len[i]) != Z_OK)
+    {
+      return -JLITE_ERR;
+    }
+    ret = jlite_parse_init(&obj, bc->project_tokens, bc->max_tokens,
+        bc->scratch, (int) len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_inflate_parse(bench_corpus_t *bc, int flags)
+{
+  jliteobj_t obj;
+  int i = 0;
+  int ret = 0;
+
+  for (i = 0; i < bc->num_docs; i++)
+  {
+    ret = jlite_inflate_parse_buffer(&obj, bc->project_tokens,
+        bc->max_tokens, bc->scratch, bc->max_len, bc->deflated +
+        bc->deflated_off[i], bc->deflated_len[i], flags);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_inflate_parse(void *ctx)
+{
+  return bench_inflate_parse(ctx, 0);
+}
+
+static int bench_work_inflate_parse_threaded(void *ctx)
+{
+  return bench_inflate_parse(ctx, JLITE_INFLATE_THREADED);
+}
+
+static void bench_emit(bench_opts_t *opts, const char *corpus,
+    const char *bench, size_t bytes, long calls, bench_result_t *res)
+{
+  double seconds = (double) res->median_ns / 1e9;
+  double value = 0;
+  int i = 0;
+
+  fprintf(opts->out, "{\"corpus\":\"%s\",\"bench\":\"%s\",\"bytes\":%zu,"
+      "\"calls\":%ld,\"runs\":%d,\"min_ns\":%llu,\"median_ns\":%llu,"
+      "\"mean_ns\":%llu", corpus, bench, bytes, calls, opts->runs,
+      (unsigned long long) res->min_ns, (unsigned long long) res->median_ns,
+      (unsigned long long) res->mean_ns);
+  if (bytes && seconds > 0)
+  {
+    fprintf(opts->out, ",\"mb_s\":%.2f", (double) bytes / 1e6 / seconds);
+  }
+  if (calls)
+  {
+    fprintf(opts->out, ",\"ns_per_call\":%.2f",
+        (double) res->median_ns / (double) calls);
+  }
+
+  if (opts->profile)
+  {
+    for (i = 0; i < PERF_NUM_COUNTERS; i++)
+    {
+      value = (double) res->counters.values[i];
+      fprintf(opts->out, ",\"%s\":%.0f", perf_counter_names[i], value);
+      if (bytes)
+      {
+        fprintf(opts->out, ",\"%s_per_byte\":%.4f", perf_counter_names[i],
+            value / (double) bytes);
+      }
+      if (calls)
+      {
+        fprintf(opts->out, ",\"%s_per_call\":%.3f", perf_counter_names[i],
+            value / (double) calls);
+      }
+    }
+    if (res->counters.values[PERF_CYCLES])
+    {
+      fprintf(opts->out, ",\"ipc\":%.3f",
+          (double) res->counters.values[PERF_INSTRUCTIONS] /
+          (double) res->counters.values[PERF_CYCLES]);
+    }
+  }
+
+  fprintf(opts->out, "}\n");
+  fflush(opts->out);
+}
+
+static int bench_run_phase(bench_opts_t *opts, bench_corpus_t *bc,
+    const char *name, bench_work_fn fn, long calls)
+{
+  bench_result_t res;
+  int ret = 0;
+
+  ret = bench_measure(opts, fn, bc, &res);
+  if (ret != JLITE_OK)
+  {
+    fprintf(stderr, "%s: %s failed %d\n", bc->name, name, ret);
+    return ret;
+  }
+  bench_emit(opts, bc->name, name, bc->bytes, calls, &res);
+  return JLITE_OK;
+}
+
+/*
+ * Describe a probe for the root member at token position pos (the key).
+ */
+static void bench_probe_from_key(bench_doc_t *doc, int pos,
+    bench_probe_t *probe)
+{
+  jlitetok_t *tokens = doc->obj.tokens;
+  int len = tokens[pos].end - tokens[pos].start;
+
+  memset(probe, 0, sizeof(*probe));
+  if (len >= BENCH_KEY_MAX)
+  {
+    len = BENCH_KEY_MAX - 1;
+  }
+  memcpy(probe->key, doc->str + tokens[pos].start, (size_t) len);
+  probe->type = tokens[pos + 1].type;
+  if (probe->type == JSMN_ARRAY && tokens[pos + 1].size > 0)
+  {
+    probe->elem_type = tokens[pos + 2].type;
+    probe->elem_pos = tokens[pos + 1].size / 2;
+    if (probe->elem_type == JSMN_OBJECT && tokens[pos + 2].size > 0)
+    {
+      len = tokens[pos + 3].end - tokens[pos + 3].start;
+      if (len >= BENCH_KEY_MAX)
+      {
+        len = BENCH_KEY_MAX - 1;
+      }
+      memcpy(probe->field, doc->str + tokens[pos + 3].start, (size_t) len);
+      probe->field_type = tokens[pos + 4].type;
+    }
+  }
+}
+
+static int bench_probe_key(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static char value_str[1 << 16];
+  float value_float = 0;
+  int size = 0;
+  int ret = 0;
+
+  switch (probe->type)
+  {
+    case JSMN_STRING:
+      return jlite_get_value_str(obj, probe->key, value_str, sizeof(value_str));
+    case JSMN_PRIMITIVE:
+      return jlite_get_value_float(obj, probe->key, &value_float);
+    case JSMN_OBJECT:
+      ret = jlite_get_json_object(obj, probe->key);
+      if (ret != JLITE_OK)
+      {
+        return ret;
+      }
+      return jlite_release_json_object(obj);
+    default:
+      return jlite_get_json_array_size(obj, probe->key, &size);
+  }
+}
+
+static int bench_probe_element(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static char value_str[1 << 16];
+  float value_float = 0;
+  int size = 0;
+  int ret = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  switch (probe->elem_type)
+  {
+    case JSMN_STRING:
+      ret = jlite_get_json_array_element_str(obj, probe->elem_pos, value_str,
+          sizeof(value_str));
+      break;
+    case JSMN_PRIMITIVE:
+      ret = jlite_get_json_array_element_float(obj, probe->elem_pos,
+          &value_float);
+      break;
+    case JSMN_OBJECT:
+      ret = jlite_get_array_element_object(obj, probe->elem_pos);
+      break;
+    default:
+      ret = jlite_get_array_element_array(obj, probe->elem_pos, &size);
+      break;
+  }
+  return ret;
+}
+
+/*
+ * Convert the whole array with one bulk call, compared against one element
+ * getter call per element.
+ */
+static int bench_probe_bulk(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static double values[1 << 20];
+  int num_values = 0;
+  int size = 0;
+  int ret = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+  return jlite_get_json_array_doubles(obj, values, 1 << 20, &num_values);
+}
+
+/* Aggregate the array, or the first field of its object elements. */
+static int bench_probe_aggregate(jliteobj_t *obj, bench_probe_t *probe)
+{
+  jlite_agg_t agg;
+  int size = 0;
+  int ret = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+  if (probe->elem_type == JSMN_OBJECT)
+  {
+    return jlite_aggregate_field(obj, probe->field, &agg);
+  }
+  return jlite_aggregate_array(obj, &agg);
+}
+
+#define BENCH_COLUMN_ROWS (1 << 20)
+
+/*
+ * Extract the first field of the object elements as one column, compared
+ * against a getter loop reading the field of each element.
+ */
+static int bench_probe_columns(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static double values[BENCH_COLUMN_ROWS + 1];
+  static uint8_t validity[BENCH_COLUMN_ROWS / 8];
+  static char data[1 << 24];
+  jlite_column_t column;
+  int num_rows = 0;
+  int size = 0;
+  int ret = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  memset(&column, 0, sizeof(column));
+  column.key = probe->field;
+  column.type = probe->field_type == JSMN_STRING ? JLITE_COLUMN_STRING :
+      JLITE_COLUMN_DOUBLE;
+  column.validity = validity;
+  column.values = values;
+  column.data = data;
+  column.data_size = sizeof(data);
+  return jlite_extract_columns(obj, &column, 1, BENCH_COLUMN_ROWS,
+      &num_rows);
+}
+
+static int bench_probe_getter_loop(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static char value_str[1 << 16];
+  float value_float = 0;
+  int array_pos = 0;
+  int size = 0;
+  int ret = 0;
+  int i = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  array_pos = obj->cur_pos;
+  for (i = 0; i < size; i++)
+  {
+    obj->cur_pos = array_pos;
+    if (jlite_get_array_element_object(obj, i) != JLITE_OK)
+    {
+      continue;
+    }
+    if (probe->field_type == JSMN_STRING)
+    {
+      jlite_get_value_str(obj, probe->field, value_str, sizeof(value_str));
+    }
+    else
+    {
+      jlite_get_value_float(obj, probe->field, &value_float);
+    }
+  }
+  obj->cur_pos = array_pos;
+  return JLITE_OK;
+}
+
+/*
+ * The same probes through the on-demand API, reading the raw text of the
+ * parsed document. They include all scanning work, so they compare against
+ * parse + get_* of the tokenized path.
+ */
+static int bench_probe_lazy_key(jliteobj_t *obj, bench_probe_t *probe)
+{
+  static char value_str[1 << 16];
+  jlitelazy_t root;
+  jlitelazy_t member;
+  float value_float = 0;
+  int ret = 0;
+
+  ret = jlite_lazy_init(&root, obj->jsonstr, obj->jsonstr_len);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_find(&root, probe->key, &member);
+  }
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  switch (probe->type)
+  {
+    case JSMN_STRING:
+      return jlite_lazy_to_str(&member, value_str, sizeof(value_str));
+    case JSMN_PRIMITIVE:
+      return jlite_lazy_to_float(&member, &value_float);
+    default:
+      return JLITE_OK;
+  }
+}
+
+static int bench_probe_lazy_element(jliteobj_t *obj, bench_probe_t *probe)
+{
+  jlitelazy_t root;
+  jlitelazy_t array;
+  jlitelazy_t element;
+  int ret = 0;
+
+  ret = jlite_lazy_init(&root, obj->jsonstr, obj->jsonstr_len);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_find(&root, probe->key, &array);
+  }
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_element(&array, probe->elem_pos, &element);
+  }
+  return ret;
+}
+
+typedef int (*bench_probe_fn)(jliteobj_t *obj, bench_probe_t *probe);
+
+typedef struct
+{
+  bench_probe_fn fn;
+  bench_probe_t *probe;
+  jliteobj_t *obj;
+  long calls;
+} bench_probe_ctx_t;
+
+static int bench_work_probe(void *ctx)
+{
+  bench_probe_ctx_t *pc = ctx;
+  int saved_pos = pc->obj->cur_pos;
+  long c = 0;
+
+  for (c = 0; c < pc->calls; c++)
+  {
+    pc->fn(pc->obj, pc->probe);
+    pc->obj->cur_pos = saved_pos;
+  }
+  return JLITE_OK;
+}
+
+static int bench_run_probe(bench_opts_t *opts, bench_corpus_t *bc,
+    const char *name, bench_probe_fn fn, bench_probe_t *probe)
+{
+  bench_probe_ctx_t pc;
+  bench_result_t res;
+  uint64_t t0 = 0;
+  int ret = 0;
+
+  pc.fn = fn;
+  pc.probe = probe;
+  pc.obj = &bc->docs[0].obj;
+  pc.calls = 1;
+
+  ret = fn(pc.obj, probe);
+  pc.obj->cur_pos = 1;
+  if (ret != JLITE_OK)
+  {
+    fprintf(stderr, "%s: probe %s(%s) failed %d\n", bc->name, name,
+        probe->key, ret);
+    return ret;
+  }
+
+  /* Grow the batch until one run is long enough to time reliably. */
+  for (;;)
+  {
+    t0 = bench_now_ns();
+    bench_work_probe(&pc);
+    if (bench_now_ns() - t0 >= BENCH_PROBE_MIN_NS || pc.calls >= (1L << 24))
+    {
+      break;
+    }
+    pc.calls *= 2;
+  }
+
+  bench_measure(opts, bench_work_probe, &pc, &res);
+  bench_emit(opts, bc->name, name, 0, pc.calls, &res);
+  return JLITE_OK;
+}
+
+static jlite_number_t *bench_numbers;
+
+static int bench_probe_decode(jliteobj_t *obj, bench_probe_t *probe)
+{
+  (void) probe;
+  return jlite_decode_numbers(obj, bench_numbers, obj->num_tokens);
+}
+
+/* Run a probe again reading the decoded number table. */
+static void bench_run_probe_numbers(bench_opts_t *opts, bench_corpus_t *bc,
+    const char *name, bench_probe_fn fn, bench_probe_t *probe)
+{
+  jliteobj_t *obj = &bc->docs[0].obj;
+
+  if (bench_numbers &&
+      jlite_decode_numbers(obj, bench_numbers, obj->num_tokens) == JLITE_OK)
+  {
+    bench_run_probe(opts, bc, name, fn, probe);
+  }
+  obj->numbers = NULL;
+}
+
+static jsmnint_t bench_index_mem[BENCH_INDEX_BYTES / sizeof(jsmnint_t)];
+static jlite_index_t bench_index;
+
+static int bench_probe_index_build(jliteobj_t *obj, bench_probe_t *probe)
+{
+  int size = 0;
+  int ret = 0;
+
+  ret = jlite_get_json_array(obj, probe->key, &size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+  return jlite_index_build(obj, &bench_index, bench_index_mem,
+      sizeof(bench_index_mem), 0);
+}
+
+static jlite_intern_entry_t bench_intern_entries[BENCH_INTERN_ENTRIES];
+static char bench_intern_keys[BENCH_INTERN_BYTES];
+static jlite_key_id_t *bench_key_ids;
+static jlite_intern_t bench_intern;
+
+static int bench_probe_intern(jliteobj_t *obj, bench_probe_t *probe)
+{
+  (void) probe;
+  return jlite_intern_document(&bench_intern, obj, bench_key_ids,
+      obj->num_tokens);
+}
+
+/* Run a probe again comparing interned key IDs. */
+static void bench_run_probe_interned(bench_opts_t *opts, bench_corpus_t *bc,
+    const char *name, bench_probe_fn fn, bench_probe_t *probe)
+{
+  jliteobj_t *obj = &bc->docs[0].obj;
+
+  if (bench_key_ids && bench_probe_intern(obj, probe) == JLITE_OK)
+  {
+    bench_run_probe(opts, bc, name, fn, probe);
+  }
+  obj->key_ids = NULL;
+  obj->intern = NULL;
+}
+
+/* The element probe starting from a sparse index of the array. */
+static void bench_run_probe_index(bench_opts_t *opts, bench_corpus_t *bc,
+    bench_probe_t *probe)
+{
+  jliteobj_t *obj = &bc->docs[0].obj;
+
+  bench_run_probe(opts, bc, "index_build", bench_probe_index_build, probe);
+  bench_run_probe(opts, bc, "get_array_element_mid_index",
+      bench_probe_element, probe);
+  jlite_index_drop(obj, &bench_index);
+}
+
+static void bench_run_getters(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  static jlite_shape_entry_t shape_entries[BENCH_SHAPE_ENTRIES];
+  bench_doc_t *doc = &bc->docs[0];
+  jlitetok_t *tokens = doc->obj.tokens;
+  jlite_shape_t shape;
+  bench_probe_t probe;
+  int last_key = 0;
+  int array_key = 0;
+  int pos = 1;
+  int i = 0;
+
+  if (tokens[0].type != JSMN_OBJECT || tokens[0].size == 0)
+  {
+    return;
+  }
+
+  /* Walk the root members to find the last key and the first array. */
+  for (i = 0; i < tokens[0].size; i++)
+  {
+    last_key = pos;
+    if (!array_key && tokens[pos + 1].type == JSMN_ARRAY &&
+        tokens[pos + 1].size > 0)
+    {
+      array_key = pos;
+    }
+    pos++;
+    while (pos < doc->obj.num_tokens && tokens[pos].start < tokens[last_key + 1].end)
+    {
+      pos++;
+    }
+  }
+
+  bench_numbers = malloc(sizeof(*bench_numbers) * (size_t) doc->obj.num_tokens);
+  if (bench_numbers)
+  {
+    bench_run_probe(opts, bc, "decode_numbers", bench_probe_decode, &probe);
+    doc->obj.numbers = NULL;
+  }
+  bench_key_ids = malloc(sizeof(*bench_key_ids) * (size_t) doc->obj.num_tokens);
+  jlite_intern_init(&bench_intern, bench_intern_entries, BENCH_INTERN_ENTRIES,
+      bench_intern_keys, sizeof(bench_intern_keys));
+  if (bench_key_ids)
+  {
+    bench_run_probe(opts, bc, "intern_document", bench_probe_intern, &probe);
+    doc->obj.key_ids = NULL;
+    doc->obj.intern = NULL;
+  }
+
+  bench_probe_from_key(doc, 1, &probe);
+  bench_run_probe(opts, bc, "get_first_key", bench_probe_key, &probe);
+  bench_run_probe(opts, bc, "lazy_first_key", bench_probe_lazy_key, &probe);
+
+  bench_probe_from_key(doc, last_key, &probe);
+  bench_run_probe(opts, bc, "get_last_key", bench_probe_key, &probe);
+  jlite_shape_init(&shape, shape_entries, BENCH_SHAPE_ENTRIES);
+  jlite_shape_attach(&doc->obj, &shape);
+  bench_run_probe(opts, bc, "get_last_key_shape", bench_probe_key, &probe);
+  jlite_shape_attach(&doc->obj, NULL);
+  bench_run_probe_interned(opts, bc, "get_last_key_interned", bench_probe_key,
+      &probe);
+  bench_run_probe(opts, bc, "lazy_last_key", bench_probe_lazy_key, &probe);
+
+  if (array_key)
+  {
+    bench_probe_from_key(doc, array_key, &probe);
+    bench_run_probe(opts, bc, "get_array_element_mid", bench_probe_element,
+        &probe);
+    bench_run_probe_index(opts, bc, &probe);
+    bench_run_probe(opts, bc, "lazy_array_element_mid",
+        bench_probe_lazy_element, &probe);
+    if (probe.elem_type == JSMN_PRIMITIVE)
+    {
+      bench_run_probe_numbers(opts, bc, "get_array_element_mid_numbers",
+          bench_probe_element, &probe);
+      bench_run_probe(opts, bc, "get_array_bulk_doubles", bench_probe_bulk,
+          &probe);
+      bench_run_probe_numbers(opts, bc, "get_array_bulk_doubles_numbers",
+          bench_probe_bulk, &probe);
+      bench_run_probe(opts, bc, "aggregate_array", bench_probe_aggregate,
+          &probe);
+    }
+    else if (probe.elem_type == JSMN_OBJECT && probe.field[0])
+    {
+      bench_run_probe(opts, bc, "aggregate_field", bench_probe_aggregate,
+          &probe);
+      if (probe.field_type == JSMN_STRING ||
+          probe.field_type == JSMN_PRIMITIVE)
+      {
+        bench_run_probe(opts, bc, "columns_field", bench_probe_columns,
+            &probe);
+        bench_run_probe(opts, bc, "getter_loop_field",
+            bench_probe_getter_loop, &probe);
+        bench_run_probe_interned(opts, bc, "getter_loop_field_interned",
+            bench_probe_getter_loop, &probe);
+        if (probe.field_type == JSMN_PRIMITIVE)
+        {
+          bench_run_probe_numbers(opts, bc, "getter_loop_field_numbers",
+              bench_probe_getter_loop, &probe);
+        }
+      }
+    }
+  }
+  free(bench_numbers);
+  bench_numbers = NULL;
+  free(bench_key_ids);
+  bench_key_ids = NULL;
+}
+
+/*
+ * Time jlite_parse_project() keeping only the first root member, and
+ * jlite_query_run() finding that key at any depth.
+ */
+static void bench_run_project(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  jlitetok_t *tokens = bc->docs[0].obj.tokens;
+  char expr[BENCH_KEY_MAX + 8];
+  int len = 0;
+
+  if (tokens[0].type != JSMN_OBJECT || tokens[0].size == 0)
+  {
+    return;
+  }
+  len = tokens[1].end - tokens[1].start;
+  if (len > BENCH_KEY_MAX)
+  {
+    return;
+  }
+  snprintf(expr, sizeof(expr), "[\"%.*s\"]", len,
+      bc->docs[0].str + tokens[1].start);
+  if (jlite_path_compile(&bc->project_path, expr) == JLITE_OK)
+  {
+    bench_run_phase(opts, bc, "project_first_key", bench_work_project,
+        bc->num_docs);
+  }
+  snprintf(expr, sizeof(expr), "$..[\"%.*s\"]", len,
+      bc->docs[0].str + tokens[1].start);
+  if (jlite_query_compile(&bc->query, expr, NULL) == JLITE_OK)
+  {
+    bench_run_phase(opts, bc, "query_descend_first_key", bench_work_query,
+        bc->num_docs);
+  }
+}
+
+/*
+ * Time jlite_cache_parse() on repeats: the cache gets a slot per document
+ * and is filled before measuring, so every measured call is a hit.
+ */
+static void bench_run_cache(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  size_t slot = (size_t) bc->max_len +
+      (size_t) bc->max_tokens * sizeof(jlitetok_t) + 8;
+  size_t size = (size_t) bc->num_docs * (slot + sizeof(jlite_cache_slot_t)) +
+      64;
+  void *arena = malloc(size);
+
+  if (!arena ||
+      jlite_cache_init(&bc->cache, arena, size, bc->num_docs) != JLITE_OK)
+  {
+    free(arena);
+    return;
+  }
+  bench_work_cache(bc);
+  bench_run_phase(opts, bc, "cache_hit", bench_work_cache, bc->num_docs);
+  jlite_cache_destroy(&bc->cache);
+  free(arena);
+}
+
+/*
+ * Encode every document once, then time encoding and reading back. The
+ * MessagePack form is never larger than the JSON one plus a header per
+ * document; the text the reader renders needs room for the numbers.
+ */
+static void bench_run_msgpack(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  size_t off = 0;
+  int i = 0;
+
+  bc->msgpack_size = bc->bytes + (size_t) bc->num_docs * 16;
+  bc->msgpack = malloc(bc->msgpack_size);
+  bc->msgpack_off = malloc(sizeof(size_t) * (size_t) bc->num_docs);
+  bc->msgpack_len = malloc(sizeof(size_t) * (size_t) bc->num_docs);
+  bc->msgpack_text_len = bc->max_len * 4 + 64;
+  bc->msgpack_text = malloc((size_t) bc->msgpack_text_len);
+  if (bc->msgpack && bc->msgpack_off && bc->msgpack_len && bc->msgpack_text)
+  {
+    for (i = 0; i < bc->num_docs; i++)
+    {
+      bc->msgpack_off[i] = off;
+      bc->docs[i].obj.cur_pos = 1;
+      if (jlite_msgpack_encode(&bc->docs[i].obj, bc->msgpack + off,
+          bc->msgpack_size - off, &bc->msgpack_len[i]) != JLITE_OK)
+      {
+        break;
+      }
+      off += bc->msgpack_len[i];
+    }
+    if (i == bc->num_docs)
+    {
+      bench_run_phase(opts, bc, "msgpack_encode", bench_work_msgpack_encode,
+          bc->num_docs);
+      bench_run_phase(opts, bc, "msgpack_read", bench_work_msgpack_read,
+          bc->num_docs);
+    }
+  }
+  free(bc->msgpack);
+  free(bc->msgpack_off);
+  free(bc->msgpack_len);
+  free(bc->msgpack_text);
+  bc->msgpack = NULL;
+  bc->msgpack_off = NULL;
+  bc->msgpack_len = NULL;
+  bc->msgpack_text = NULL;
+}
+
+/*
+ * Compress every document once with zlib, then time inflating alone, the
+ * inflate-then-parse sequence and the pipelined jlite_inflate_parse_buffer().
+ */
+static void bench_run_inflate(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  size_t size = compressBound((uLong) bc->bytes) +
+      (size_t) bc->num_docs * 64;
+  size_t off = 0;
+  uLongf len = 0;
+  int i = 0;
+
+  bc->deflated = malloc(size);
+  bc->deflated_off = malloc(sizeof(size_t) * (size_t) bc->num_docs);
+  bc->deflated_len = malloc(sizeof(size_t) * (size_t) bc->num_docs);
+  if (bc->deflated && bc->deflated_off && bc->deflated_len)
+  {
+    for (i = 0; i < bc->num_docs; i++)
+    {
+      len = (uLongf) (size - off);
+      if (compress2(bc->deflated + off, &len, (const Bytef *) bc->docs[i].str,
+          (uLong) bc->docs[i].len, 6) != Z_OK)
+      {
+        break;
+      }
+      bc->deflated_off[i] = off;
+      bc->deflated_len[i] = len;
+      off += len;
+    }
+    if (i == bc->num_docs)
+    {
+      bench_run_phase(opts, bc, "inflate", bench_work_inflate, bc->num_docs);
+      bench_run_phase(opts, bc, "inflate_then_parse",
+          bench_work_inflate_then_parse, bc->num_docs);
+      bench_run_phase(opts, bc, "inflate_parse", bench_work_inflate_parse,
+          bc->num_docs);
+      bench_run_phase(opts, bc, "inflate_parse_threaded",
+          bench_work_inflate_parse_threaded, bc->num_docs);
+    }
+  }
+  free(bc->deflated);
+  free(bc->deflated_off);
+  free(bc->deflated_len);
+  bc->deflated = NULL;
+  bc->deflated_off = NULL;
+  bc->deflated_len = NULL;
+}
+
+/* Files of one corpus for the ingest phases. */
+typedef struct
+{
+  bench_corpus_t *bc;
+  char **paths;
+  int num_paths;
+  jlite_ingest_opts_t ingest;
+  int cold;
+} bench_ingest_t;
+
+static int bench_ingest_evict(bench_ingest_t *bi)
+{
+  int fd = 0;
+  int i = 0;
+
+  for (i = 0; i < bi->num_paths; i++)
+  {
+    fd = open(bi->paths[i], O_RDONLY);
+    if (fd < 0)
+    {
+      return -JLITE_ERR;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+  return JLITE_OK;
+}
+
+static int bench_work_ingest_evict(void *ctx)
+{
+  return bench_ingest_evict(ctx);
+}
+
+static int bench_work_ingest_read_parse(void *ctx)
+{
+  bench_ingest_t *bi = ctx;
+  bench_corpus_t *bc = bi->bc;
+  jliteobj_t obj;
+  ssize_t n = 0;
+  int len = 0;
+  int fd = 0;
+  int i = 0;
+  int ret = 0;
+
+  if (bi->cold && bench_ingest_evict(bi) != JLITE_OK)
+  {
+    return -JLITE_ERR;
+  }
+  for (i = 0; i < bi->num_paths; i++)
+  {
+    fd = open(bi->paths[i], O_RDONLY);
+    if (fd < 0)
+    {
+      return -JLITE_ERR;
+    }
+    len = 0;
+    while ((n = read(fd, bc->scratch + len, (size_t) (bc->max_len - len))) > 0)
+    {
+      len += (int) n;
+    }
+    close(fd);
+    ret = jlite_parse_init(&obj, bc->project_tokens, bc->max_tokens,
+        bc->scratch, len);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+static int bench_ingest_check(void *ctx, int index, jliteobj_t *jsonobj,
+    int ret)
+{
+  (void) index;
+  (void) jsonobj;
+  if (ret != JLITE_OK)
+  {
+    *(int *) ctx = ret;
+  }
+  return 0;
+}
+
+static int bench_ingest(bench_ingest_t *bi, int flags)
+{
+  jlite_ingest_stats_t stats;
+  int failed = JLITE_OK;
+  int ret = 0;
+
+  if (bi->cold && bench_ingest_evict(bi) != JLITE_OK)
+  {
+    return -JLITE_ERR;
+  }
+  bi->ingest.flags = flags;
+  ret = jlite_ingest_files(&bi->ingest, (const char *const *) bi->paths,
+      bi->num_paths, bench_ingest_check, &failed, &stats);
+  if (ret == JLITE_OK && !(flags & JLITE_INGEST_PREAD) && !stats.uring)
+  {
+    /* No io_uring here, do not report pread numbers under its name. */
+    ret = -JLITE_E_NOT_SUPPORTED;
+  }
+  return ret != JLITE_OK ? ret : failed;
+}
+
+static int bench_work_ingest_uring(void *ctx)
+{
+  return bench_ingest(ctx, 0);
+}
+
+static int bench_work_ingest_pread(void *ctx)
+{
+  return bench_ingest(ctx, JLITE_INGEST_PREAD);
+}
+
+/*
+ * Write every document to DIR/<corpus>/<n>.json, NDJSON records each to
+ * a file of their own, and time reading them back. Files are removed at
+ * the end.
+ */
+static void bench_run_ingest(bench_opts_t *opts, bench_corpus_t *bc)
+{
+  static const struct
+  {
+    const char *name;
+    bench_work_fn fn;
+    int cold;
+  } phases[] = {
+    { "ingest_read_parse", bench_work_ingest_read_parse, 0 },
+    { "ingest_uring", bench_work_ingest_uring, 0 },
+    { "ingest_pread", bench_work_ingest_pread, 0 },
+    { "ingest_evict", bench_work_ingest_evict, 0 },
+    { "ingest_read_parse_cold", bench_work_ingest_read_parse, 1 },
+    { "ingest_uring_cold", bench_work_ingest_uring, 1 },
+    { "ingest_pread_cold", bench_work_ingest_pread, 1 },
+  };
+  bench_ingest_t bi;
+  bench_result_t res;
+  size_t slot = (((size_t) bc->max_len + 7) & ~(size_t) 7) +
+      (size_t) bc->max_tokens * sizeof(jlitetok_t) + 64;
+  char dir[4096];
+  FILE *fp = NULL;
+  size_t i = 0;
+  int ret = 0;
+
+  memset(&bi, 0, sizeof(bi));
+  bi.bc = bc;
+  snprintf(dir, sizeof(dir), "%s/%s", opts->ingest_dir, bc->name);
+  mkdir(dir, 0755);
+  bi.paths = calloc((size_t) bc->num_docs, sizeof(*bi.paths));
+  bi.ingest.num_buffers = BENCH_INGEST_DEPTH + 4;
+  bi.ingest.queue_depth = BENCH_INGEST_DEPTH;
+  bi.ingest.arena_size = (size_t) bi.ingest.num_buffers * (slot + 128);
+  bi.ingest.arena = malloc(bi.ingest.arena_size);
+  if (!bi.paths || !bi.ingest.arena)
+  {
+    ret = -1;
+  }
+  for (i = 0; ret == 0 && i < (size_t) bc->num_docs; i++)
+  {
+    bi.paths[i] = malloc(strlen(dir) + 16);
+    if (!bi.paths[i])
+    {
+      ret = -1;
+      break;
+    }
+    sprintf(bi.paths[i], "%s/%06d.json", dir, (int) i);
+    bi.num_paths++;
+    fp = fopen(bi.paths[i], "wb");
+    if (!fp || fwrite(bc->docs[i].str, 1, (size_t) bc->docs[i].len, fp) !=
+        (size_t) bc->docs[i].len)
+    {
+      fprintf(stderr, "cannot write %s\n", bi.paths[i]);
+      ret = -1;
+    }
+    if (fp)
+    {
+      fclose(fp);
+    }
+  }
+
+  for (i = 0; ret == 0 && i < sizeof(phases) / sizeof(phases[0]); i++)
+  {
+    bi.cold = phases[i].cold;
+    if (bench_measure(opts, phases[i].fn, &bi, &res) != JLITE_OK)
+    {
+      fprintf(stderr, "%s: %s failed\n", bc->name, phases[i].name);
+      continue;
+    }
+    bench_emit(opts, bc->name, phases[i].name, bc->bytes, bc->num_docs,
+        &res);
+  }
+
+  for (i = 0; i < (size_t) bi.num_paths; i++)
+  {
+    remove(bi.paths[i]);
+    free(bi.paths[i]);
+  }
+  rmdir(dir);
+  free(bi.paths);
+  free(bi.ingest.arena);
+}
+
+static int bench_run_corpus(bench_opts_t *opts, const corpus_desc_t *desc)
+{
+  corpus_buf_t buf;
+  bench_corpus_t bc;
+  int ret = 0;
+
+  corpus_generate(desc, opts->scale, &buf);
+  ret = bench_corpus_load(&bc, desc, &buf);
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "tokenize_count",
+        bench_work_tokenize_count, bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "tokenize_count_tpl",
+        bench_work_tokenize_count_tpl, bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "validate", bench_work_validate,
+        bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "minify", bench_work_minify,
+        bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "minify_validate",
+        bench_work_minify_validate, bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "tokenize", bench_work_tokenize,
+        bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "tokenize_tpl", bench_work_tokenize_tpl,
+        bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "tokenize_compact",
+        bench_work_tokenize_compact, bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    ret = bench_run_phase(opts, &bc, "parse", bench_work_parse, bc.num_docs);
+  }
+  if (ret == 0)
+  {
+    bench_run_phase(opts, &bc, "traverse", bench_work_traverse,
+        bc.total_tokens);
+    bench_run_phase(opts, &bc, "hash", bench_work_hash, bc.num_docs);
+    bench_run_project(opts, &bc);
+    bench_run_cache(opts, &bc);
+    bench_run_msgpack(opts, &bc);
+    bench_run_inflate(opts, &bc);
+    if (opts->ingest_dir)
+    {
+      bench_run_ingest(opts, &bc);
+    }
+    bench_run_getters(opts, &bc);
+  }
+
+  bench_corpus_free(&bc);
+  corpus_free(&buf);
+  return ret;
+}
+
+/*
+ * Compare the current result file against a baseline. Both are read back
+ * with jlite itself, one record per line.
+ */
+static void bench_compare(const char *baseline, const char *current)
+{
+  char cur_line[1024];
+  char base_line[1024];
+  char cur_id[256];
+  char base_id[256];
+  char corpus[64];
+  char bench[64];
+  jlitetok_t tokens[64];
+  jliteobj_t obj;
+  float cur_ns = 0;
+  float base_ns = 0;
+  FILE *cur = NULL;
+  FILE *base = NULL;
+  int found = 0;
+
+  cur = fopen(current, "r");
+  base = fopen(baseline, "r");
+  if (!cur || !base)
+  {
+    fprintf(stderr, "cannot open %s or %s\n", baseline, current);
+    goto out;
+  }
+
+  fprintf(stderr, "\n%-10s %-24s %14s %14s %8s\n", "corpus", "bench",
+      "base_ns", "cur_ns", "delta");
+  while (fgets(cur_line, sizeof(cur_line), cur))
+  {
+    if (jlite_parse_init(&obj, tokens, 64, cur_line, strlen(cur_line)) ||
+        jlite_get_value_str(&obj, "corpus", corpus, sizeof(corpus)) ||
+        jlite_get_value_str(&obj, "bench", bench, sizeof(bench)) ||
+        jlite_get_value_float(&obj, "median_ns", &cur_ns))
+    {
+      continue;
+    }
+    snprintf(cur_id, sizeof(cur_id), "%s/%s", corpus, bench);
+
+    found = 0;
+    rewind(base);
+    while (!found && fgets(base_line, sizeof(base_line), base))
+    {
+      if (jlite_parse_init(&obj, tokens, 64, base_line, strlen(base_line)) ||
+          jlite_get_value_str(&obj, "corpus", corpus, sizeof(corpus)) ||
+          jlite_get_value_str(&obj, "bench", bench, sizeof(bench)) ||
+          jlite_get_value_float(&obj, "median_ns", &base_ns))
+      {
+        continue;
+      }
+      snprintf(base_id, sizeof(base_id), "%s/%s", corpus, bench);
+      found = strcmp(base_id, cur_id) == 0;
+    }
+
+    if (found && base_ns > 0)
+    {
+      fprintf(stderr, "%-35s %14.0f %14.0f %+7.1f%%\n", cur_id, base_ns,
+          cur_ns, (cur_ns - base_ns) * 100.0 / base_ns);
+    }
+    else
+    {
+      fprintf(stderr, "%-35s %14s %14.0f %8s\n", cur_id, "-", cur_ns, "new");
+    }
+  }
+
+out:
+  if (cur)
+  {
+    fclose(cur);
+  }
+  if (base)
+  {
+    fclose(base);
+  }
+}
+
+static int bench_dump(const char *dir, int scale)
+{
+  const corpus_desc_t *desc = NULL;
+  corpus_buf_t buf;
+  char path[4096];
+  FILE *fp = NULL;
+
+  for (desc = corpus_table; desc->name; desc++)
+  {
+    snprintf(path, sizeof(path), "%s/%s.%s", dir, desc->name,
+        desc->ndjson ? "ndjson" : "json");
+    corpus_generate(desc, scale, &buf);
+    fp = fopen(path, "wb");
+    if (!fp || fwrite(buf.data, 1, buf.len, fp) != buf.len)
+    {
+      fprintf(stderr, "cannot write %s\n", path);
+      if (fp)
+      {
+        fclose(fp);
+      }
+      corpus_free(&buf);
+      return 1;
+    }
+    fclose(fp);
+    fprintf(stderr, "wrote %s (%zu bytes)\n", path, buf.len);
+    corpus_free(&buf);
+  }
+  return 0;
+}
+
+static void bench_usage(const char *prog)
+{
+  const corpus_desc_t *desc = NULL;
+
+  fprintf(stderr, "usage: %s [-c corpus[,corpus...]] [-s scale] [-w warmup] "
+      "[-r runs] [-o out.jsonl] [-b baseline.jsonl] [-d dump_dir] "
+      "[-i ingest_dir] [-p]\n"
+      "corpora:", prog);
+  for (desc = corpus_table; desc->name; desc++)
+  {
+    fprintf(stderr, " %s", desc->name);
+  }
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+  bench_opts_t opts;
+  const corpus_desc_t *desc = NULL;
+  const char *out_path = NULL;
+  const char *dump_dir = NULL;
+  char *selection = NULL;
+  char *name = NULL;
+  int ret = 0;
+  int opt = 0;
+
+  memset(&opts, 0, sizeof(opts));
+  opts.warmup = BENCH_DEFAULT_WARMUP;
+  opts.runs = BENCH_DEFAULT_RUNS;
+  opts.scale = 1;
+  opts.out = stdout;
+
+  while ((opt = getopt(argc, argv, "c:s:w:r:o:b:d:i:ph")) != -1)
+  {
+    switch (opt)
+    {
+      case 'c':
+        selection = optarg;
+        break;
+      case 's':
+        opts.scale = atoi(optarg);
+        break;
+      case 'w':
+        opts.warmup = atoi(optarg);
+        break;
+      case 'r':
+        opts.runs = atoi(optarg);
+        break;
+      case 'o':
+        out_path = optarg;
+        break;
+      case 'b':
+        opts.baseline = optarg;
+        break;
+      case 'd':
+        dump_dir = optarg;
+        break;
+      case 'i':
+        opts.ingest_dir = optarg;
+        break;
+      case 'p':
+        opts.profile = 1;
+        break;
+      default:
+        bench_usage(argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  if (opts.runs < 1 || opts.runs > BENCH_MAX_RUNS || opts.warmup < 0)
+  {
+    bench_usage(argv[0]);
+    return 2;
+  }
+
+  if (dump_dir)
+  {
+    return bench_dump(dump_dir, opts.scale);
+  }
+
+  if (opts.baseline && !out_path)
+  {
+    fprintf(stderr, "-b needs -o to write the current results to a file\n");
+    return 2;
+  }
+
+  if (opts.profile && perf_group_open(&opts.perf) != 0)
+  {
+    return 1;
+  }
+
+  if (out_path)
+  {
+    opts.out = fopen(out_path, "w");
+    if (!opts.out)
+    {
+      fprintf(stderr, "cannot open %s\n", out_path);
+      return 1;
+    }
+  }
+
+  if (selection)
+  {
+    for (name = strtok(selection, ","); name; name = strtok(NULL, ","))
+    {
+      desc = corpus_find(name);
+      if (!desc)
+      {
+        fprintf(stderr, "unknown corpus %s\n", name);
+        ret = 2;
+        continue;
+      }
+      ret |= bench_run_corpus(&opts, desc) ? 1 : 0;
+    }
+  }
+  else
+  {
+    for (desc = corpus_table; desc->name; desc++)
+    {
+      ret |= bench_run_corpus(&opts, desc) ? 1 : 0;
+    }
+  }
+
+  if (opts.out != stdout)
+  {
+    fclose(opts.out);
+  }
+
+  if (opts.profile)
+  {
+    perf_group_close(&opts.perf);
+  }
+
+  if (opts.baseline)
+  {
+    bench_compare(opts.baseline, out_path);
+  }
+  return ret;
+}
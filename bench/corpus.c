@@ -0,0 +1,478 @@
+/*
+ * @file corpus.c
+ * @brief Deterministic synthetic JSON corpora used by the benchmarks.
+ *
+ * The shaped corpora only imitate the structure of the well known
+ * twitter.json, citm_catalog.json and canada.json files (key layout, value
+ * types, nesting and number density); the contents are made up.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "corpus.h"
+
+#define CORPUS_BASE_SIZE (1024 * 1024)
+
+static uint64_t corpus_rng_state;
+
+static void corpus_seed(uint64_t seed)
+{
+  corpus_rng_state = seed ? seed : 0x9e3779b97f4a7c15ULL;
+}
+
+static uint32_t corpus_rand(void)
+{
+  uint64_t x = corpus_rng_state;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  corpus_rng_state = x;
+  return (uint32_t) (x >> 32);
+}
+
+static int corpus_rand_range(int lo, int hi)
+{
+  return lo + (int) (corpus_rand() % (uint32_t) (hi - lo + 1));
+}
+
+static void buf_reserve(corpus_buf_t *buf, size_t extra)
+{
+  char *data = NULL;
+  size_t cap = 0;
+
+  if (buf->len + extra + 1 <= buf->cap)
+  {
+    return;
+  }
+
+  cap = buf->cap ? buf->cap : 4096;
+  while (cap < buf->len + extra + 1)
+  {
+    cap *= 2;
+  }
+
+  data = realloc(buf->data, cap);
+  if (!data)
+  {
+    fprintf(stderr, "corpus: out of memory (%zu bytes)\n", cap);
+    exit(1);
+  }
+  buf->data = data;
+  buf->cap = cap;
+}
+
+static void buf_puts(corpus_buf_t *buf, const char *str)
+{
+  size_t len = strlen(str);
+
+  buf_reserve(buf, len);
+  memcpy(buf->data + buf->len, str, len + 1);
+  buf->len += len;
+}
+
+static void buf_putc(corpus_buf_t *buf, char c)
+{
+  buf_reserve(buf, 1);
+  buf->data[buf->len++] = c;
+  buf->data[buf->len] = '\0';
+}
+
+static void buf_printf(corpus_buf_t *buf, const char *fmt, ...)
+{
+  va_list ap;
+  int len = 0;
+
+  va_start(ap, fmt);
+  len = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+
+  buf_reserve(buf, (size_t) len);
+  va_start(ap, fmt);
+  vsnprintf(buf->data + buf->len, (size_t) len + 1, fmt, ap);
+  va_end(ap);
+  buf->len += (size_t) len;
+}
+
+static void buf_put_word(corpus_buf_t *buf, int min_len, int max_len)
+{
+  static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+  int len = corpus_rand_range(min_len, max_len);
+  int i = 0;
+
+  buf_reserve(buf, (size_t) len);
+  for (i = 0; i < len; i++)
+  {
+    buf->data[buf->len++] = letters[corpus_rand() % 26];
+  }
+  buf->data[buf->len] = '\0';
+}
+
+static void buf_put_text(corpus_buf_t *buf, int words)
+{
+  int i = 0;
+
+  buf_putc(buf, '"');
+  for (i = 0; i < words; i++)
+  {
+    if (i)
+    {
+      buf_putc(buf, ' ');
+    }
+    switch (corpus_rand() % 16)
+    {
+      case 0:
+        buf_puts(buf, "\\\"quoted\\\"");
+        break;
+      case 1:
+        buf_puts(buf, "\\u00e9t\\u00e9");
+        break;
+      case 2:
+        buf_puts(buf, "line\\nbreak");
+        break;
+      case 3:
+        buf_puts(buf, "https:\\/\\/t.co\\/");
+        buf_put_word(buf, 8, 10);
+        break;
+      default:
+        buf_put_word(buf, 1, 9);
+        break;
+    }
+  }
+  buf_putc(buf, '"');
+}
+
+static void buf_put_double(corpus_buf_t *buf, double lo, double hi, int digits)
+{
+  double v = lo + (hi - lo) * ((double) corpus_rand() / 4294967296.0);
+
+  buf_printf(buf, "%.*f", digits, v);
+}
+
+static void gen_deep(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int depth = 0;
+  int d = 0;
+  int first = 1;
+
+  buf_puts(buf, "{\"levels\":[");
+  while (buf->len < target)
+  {
+    if (!first)
+    {
+      buf_putc(buf, ',');
+    }
+    first = 0;
+    depth = corpus_rand_range(32, 128);
+    for (d = 0; d < depth; d++)
+    {
+      if (d & 1)
+      {
+        buf_printf(buf, "[%d,", d);
+      }
+      else
+      {
+        buf_printf(buf, "{\"id\":%d,\"next\":", d);
+      }
+    }
+    buf_puts(buf, "\"leaf\"");
+    for (d = depth - 1; d >= 0; d--)
+    {
+      buf_putc(buf, (d & 1) ? ']' : '}');
+    }
+  }
+  buf_puts(buf, "],\"count\":1}");
+}
+
+static void gen_wide(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+
+  buf_putc(buf, '{');
+  while (buf->len < target)
+  {
+    if (i)
+    {
+      buf_putc(buf, ',');
+    }
+    buf_printf(buf, "\"key_%07d\":", i);
+    switch (i % 4)
+    {
+      case 0:
+        buf_printf(buf, "%d", (int) (corpus_rand() % 100000));
+        break;
+      case 1:
+        buf_put_double(buf, -1000.0, 1000.0, 4);
+        break;
+      case 2:
+        buf_put_text(buf, 2);
+        break;
+      default:
+        buf_puts(buf, (corpus_rand() & 1) ? "true" : "false");
+        break;
+    }
+    i++;
+  }
+  buf_puts(buf, ",\"last_key\":42}");
+}
+
+static void gen_numbers(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+
+  buf_puts(buf, "{\"ints\":[");
+  while (buf->len < target / 2)
+  {
+    buf_printf(buf, i ? ",%d" : "%d",
+        (int) (corpus_rand() % 2000001) - 1000000);
+    i++;
+  }
+  buf_puts(buf, "],\"floats\":[");
+  i = 0;
+  while (buf->len < target)
+  {
+    if (i)
+    {
+      buf_putc(buf, ',');
+    }
+    buf_put_double(buf, -180.0, 180.0, 6);
+    i++;
+  }
+  buf_puts(buf, "]}");
+}
+
+static void gen_strings(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+
+  buf_puts(buf, "{\"items\":[");
+  while (buf->len < target)
+  {
+    if (i)
+    {
+      buf_putc(buf, ',');
+    }
+    buf_put_text(buf, corpus_rand_range(4, 40));
+    i++;
+  }
+  buf_puts(buf, "]}");
+}
+
+static void gen_ndjson(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+
+  while (buf->len < target)
+  {
+    buf_printf(buf, "{\"id\":%d,\"ts\":%u,\"level\":\"%s\",\"user\":{\"id\":%d,"
+        "\"name\":", i, 1500000000u + corpus_rand() % 100000000u,
+        (corpus_rand() & 3) ? "info" : "error", (int) (corpus_rand() % 5000));
+    buf_put_text(buf, 2);
+    buf_puts(buf, "},\"latency\":");
+    buf_put_double(buf, 0.0, 250.0, 3);
+    buf_puts(buf, ",\"ok\":");
+    buf_puts(buf, (corpus_rand() % 10) ? "true" : "false");
+    buf_puts(buf, ",\"msg\":");
+    buf_put_text(buf, corpus_rand_range(3, 12));
+    buf_puts(buf, "}\n");
+    i++;
+  }
+}
+
+static void gen_twitter(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+  int j = 0;
+  int n = 0;
+
+  buf_puts(buf, "{\"statuses\":[");
+  while (buf->len < target)
+  {
+    if (i)
+    {
+      buf_putc(buf, ',');
+    }
+    buf_printf(buf, "{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":"
+        "\"ja\"},\"created_at\":\"Sun Aug 31 00:29:%02d +0000 2014\","
+        "\"id\":%u%05u,\"id_str\":\"%u%05u\",\"text\":", i % 60,
+        505874924u + (uint32_t) i, corpus_rand() % 100000u,
+        505874924u + (uint32_t) i, corpus_rand() % 100000u);
+    buf_put_text(buf, corpus_rand_range(5, 25));
+    buf_printf(buf, ",\"source\":\"web\",\"truncated\":false,"
+        "\"in_reply_to_status_id\":null,\"user\":{\"id\":%u,\"name\":",
+        corpus_rand());
+    buf_put_text(buf, 2);
+    buf_puts(buf, ",\"screen_name\":");
+    buf_put_text(buf, 1);
+    buf_puts(buf, ",\"description\":");
+    buf_put_text(buf, corpus_rand_range(0, 20));
+    buf_printf(buf, ",\"followers_count\":%d,\"friends_count\":%d,"
+        "\"verified\":%s,\"statuses_count\":%d,\"lang\":\"ja\"},"
+        "\"geo\":null,\"retweet_count\":%d,\"favorite_count\":%d,"
+        "\"entities\":{\"hashtags\":[",
+        (int) (corpus_rand() % 100000), (int) (corpus_rand() % 5000),
+        (corpus_rand() % 20) ? "false" : "true",
+        (int) (corpus_rand() % 100000), (int) (corpus_rand() % 100),
+        (int) (corpus_rand() % 100));
+    n = corpus_rand_range(0, 3);
+    for (j = 0; j < n; j++)
+    {
+      buf_printf(buf, "%s{\"text\":", j ? "," : "");
+      buf_put_text(buf, 1);
+      buf_printf(buf, ",\"indices\":[%d,%d]}", j * 10, j * 10 + 8);
+    }
+    buf_puts(buf, "],\"urls\":[],\"user_mentions\":[]},\"favorited\":false,"
+        "\"retweeted\":false,\"lang\":\"ja\"}");
+    i++;
+  }
+  buf_printf(buf, "],\"search_metadata\":{\"completed_in\":0.087,\"count\":%d,"
+      "\"max_id\":505874924095815681,\"query\":\"%%E4%%B8%%80\"}}", i);
+}
+
+static void gen_citm(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int i = 0;
+  int j = 0;
+  int n = 0;
+
+  buf_puts(buf, "{\"areaNames\":{");
+  for (i = 0; i < 16; i++)
+  {
+    buf_printf(buf, "%s\"%d\":", i ? "," : "", 205705993 + i);
+    buf_put_text(buf, 2);
+  }
+  buf_puts(buf, "},\"events\":{");
+  for (i = 0; buf->len < target / 4; i++)
+  {
+    buf_printf(buf, "%s\"%d\":{\"description\":null,\"id\":%d,\"logo\":"
+        "\"/images/UE0AAAAACEKo6QAAAAZDSVRN\",\"name\":", i ? "," : "",
+        138586341 + i, 138586341 + i);
+    buf_put_text(buf, 3);
+    buf_printf(buf, ",\"subTopicIds\":[337184269,337184283],"
+        "\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[%d,%d]}",
+        324846099 + i % 7, 107888604 + i % 3);
+  }
+  buf_puts(buf, "},\"performances\":[");
+  for (i = 0; buf->len < target; i++)
+  {
+    buf_printf(buf, "%s{\"eventId\":%d,\"id\":%d,\"logo\":null,\"name\":null,"
+        "\"prices\":[", i ? "," : "", 138586341 + i % 100, 339887544 + i);
+    n = corpus_rand_range(1, 6);
+    for (j = 0; j < n; j++)
+    {
+      buf_printf(buf, "%s{\"amount\":%d,\"audienceSubCategoryId\":337100890,"
+          "\"seatCategoryId\":%d}", j ? "," : "",
+          (int) (corpus_rand() % 200) * 500, 338937295 + j);
+    }
+    buf_printf(buf, "],\"seatCategories\":[{\"areas\":[{\"areaId\":%d,"
+        "\"blockIds\":[]}],\"seatCategoryId\":338937295}],\"seatMapImage\":null,"
+        "\"start\":%u000,\"venueCode\":\"PLEYEL_PLEYEL\"}",
+        205705993 + i % 16, 1372700000u + (uint32_t) i * 3600u);
+  }
+  buf_puts(buf, "],\"venueNames\":{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}}");
+}
+
+static void gen_canada(corpus_buf_t *buf, int scale)
+{
+  size_t target = (size_t) scale * CORPUS_BASE_SIZE;
+  int ring = 0;
+  int i = 0;
+  int n = 0;
+
+  buf_puts(buf, "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":"
+      "\"Feature\",\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":"
+      "\"Polygon\",\"coordinates\":[");
+  while (buf->len < target)
+  {
+    buf_puts(buf, ring ? ",[" : "[");
+    n = corpus_rand_range(64, 1024);
+    for (i = 0; i < n; i++)
+    {
+      buf_puts(buf, i ? ",[" : "[");
+      buf_put_double(buf, -141.0, -52.0, 15);
+      buf_putc(buf, ',');
+      buf_put_double(buf, 41.0, 83.0, 15);
+      buf_putc(buf, ']');
+    }
+    buf_putc(buf, ']');
+    ring++;
+  }
+  buf_puts(buf, "]}}]}");
+}
+
+const corpus_desc_t corpus_table[] =
+{
+  { "deep", 0, gen_deep },
+  { "wide", 0, gen_wide },
+  { "numbers", 0, gen_numbers },
+  { "strings", 0, gen_strings },
+  { "ndjson", 1, gen_ndjson },
+  { "twitter", 0, gen_twitter },
+  { "citm", 0, gen_citm },
+  { "canada", 0, gen_canada },
+  { NULL, 0, NULL },
+};
+
+const corpus_desc_t *corpus_find(const char *name)
+{
+  const corpus_desc_t *desc = NULL;
+
+  for (desc = corpus_table; desc->name; desc++)
+  {
+    if (strcmp(desc->name, name) == 0)
+    {
+      return desc;
+    }
+  }
+  return NULL;
+}
+
+int corpus_generate(const corpus_desc_t *desc, int scale, corpus_buf_t *buf)
+{
+  uint64_t seed = 0xcbf29ce484222325ULL;
+  const char *p = NULL;
+
+  if (!desc || !buf)
+  {
+    return -1;
+  }
+
+  if (scale < 1)
+  {
+    scale = 1;
+  }
+
+  /* Seed from the corpus name so corpora do not share a random stream. */
+  for (p = desc->name; *p; p++)
+  {
+    seed = (seed ^ (uint8_t) *p) * 0x100000001b3ULL;
+  }
+  corpus_seed(seed);
+
+  memset(buf, 0, sizeof(*buf));
+  buf_reserve(buf, (size_t) scale * CORPUS_BASE_SIZE + 4096);
+  buf->data[0] = '\0';
+  desc->generate(buf, scale);
+  return 0;
+}
+
+void corpus_free(corpus_buf_t *buf)
+{
+  if (!buf)
+  {
+    return;
+  }
+  free(buf->data);
+  memset(buf, 0, sizeof(*buf));
+}
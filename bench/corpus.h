@@ -0,0 +1,56 @@
+/*
+ * @file corpus.h
+ * @brief Deterministic synthetic JSON corpora used by the benchmarks.
+ *
+ * Every generator is driven by a fixed-seed xorshift PRNG, so the same
+ * corpus name and scale always produce byte-identical output. That keeps
+ * numbers from different commits comparable without shipping data files.
+ *
+ */
+
+#ifndef _JLITE_BENCH_CORPUS_H
+#define _JLITE_BENCH_CORPUS_H
+
+#include <stddef.h>
+
+typedef struct
+{
+  char *data;
+  size_t len;
+  size_t cap;
+} corpus_buf_t;
+
+typedef struct
+{
+  const char *name;
+  /* Records are newline separated and parsed one by one. */
+  int ndjson;
+  void (*generate)(corpus_buf_t *buf, int scale);
+} corpus_desc_t;
+
+/**
+ * @brief Table of all corpora, terminated by an entry with a NULL name.
+ */
+extern const corpus_desc_t corpus_table[];
+
+/**
+ * @brief Find a corpus descriptor by name.
+ *
+ * @return Descriptor or NULL if the name is unknown.
+ */
+const corpus_desc_t *corpus_find(const char *name);
+
+/**
+ * @brief Generate a corpus into a freshly allocated buffer.
+ *
+ * @param desc Corpus descriptor.
+ * @param scale Size multiplier, 1 gives roughly 1 MB.
+ * @param buf Buffer to fill, release with corpus_free().
+ *
+ * @return 0 on success, -1 if desc is NULL. Exits on allocation failure.
+ */
+int corpus_generate(const corpus_desc_t *desc, int scale, corpus_buf_t *buf);
+
+void corpus_free(corpus_buf_t *buf);
+
+#endif /* _JLITE_BENCH_CORPUS_H */
@@ -0,0 +1,165 @@
+/*
+ * @file perf.c
+ * @brief Hardware performance counters for the benchmarks (Linux only).
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "perf.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+const char *const perf_counter_names[PERF_NUM_COUNTERS] =
+{
+  "cycles",
+  "instructions",
+  "branch_misses",
+  "cache_misses",
+};
+
+#ifdef __linux__
+
+static const uint64_t perf_counter_configs[PERF_NUM_COUNTERS] =
+{
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_HW_CACHE_MISSES,
+};
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd)
+{
+  return (int) syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+int perf_group_open(perf_group_t *group)
+{
+  struct perf_event_attr attr;
+  int i = 0;
+
+  memset(group, 0, sizeof(*group));
+  for (i = 0; i < PERF_NUM_COUNTERS; i++)
+  {
+    group->fds[i] = -1;
+  }
+
+  for (i = 0; i < PERF_NUM_COUNTERS; i++)
+  {
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = perf_counter_configs[i];
+    attr.disabled = i == 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    group->fds[i] = perf_event_open(&attr, i == 0 ? -1 : group->fds[0]);
+    if (group->fds[i] < 0)
+    {
+      fprintf(stderr, "perf: cannot open %s counter: %s\n",
+          perf_counter_names[i], strerror(errno));
+      perf_group_close(group);
+      return -1;
+    }
+    if (ioctl(group->fds[i], PERF_EVENT_IOC_ID, &group->ids[i]) < 0)
+    {
+      perf_group_close(group);
+      return -1;
+    }
+  }
+  group->ids_valid = 1;
+  return 0;
+}
+
+void perf_group_close(perf_group_t *group)
+{
+  int i = 0;
+
+  for (i = PERF_NUM_COUNTERS - 1; i >= 0; i--)
+  {
+    if (group->fds[i] >= 0)
+    {
+      close(group->fds[i]);
+      group->fds[i] = -1;
+    }
+  }
+  group->ids_valid = 0;
+}
+
+void perf_group_start(perf_group_t *group)
+{
+  ioctl(group->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+int perf_group_stop(perf_group_t *group, perf_sample_t *sample)
+{
+  /* nr, time_enabled, time_running, then { value, id } per counter */
+  uint64_t buf[3 + 2 * PERF_NUM_COUNTERS];
+  double scale = 1.0;
+  uint64_t i = 0;
+  int j = 0;
+
+  ioctl(group->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  if (read(group->fds[0], buf, sizeof(buf)) < (ssize_t) (3 * sizeof(uint64_t)))
+  {
+    return -1;
+  }
+
+  if (buf[2] && buf[2] < buf[1])
+  {
+    scale = (double) buf[1] / (double) buf[2];
+  }
+
+  for (i = 0; i < buf[0] && i < PERF_NUM_COUNTERS; i++)
+  {
+    for (j = 0; j < PERF_NUM_COUNTERS; j++)
+    {
+      if (group->ids[j] == buf[4 + 2 * i])
+      {
+        sample->values[j] += (uint64_t) ((double) buf[3 + 2 * i] * scale);
+        break;
+      }
+    }
+  }
+  return 0;
+}
+
+#else
+
+int perf_group_open(perf_group_t *group)
+{
+  memset(group, 0, sizeof(*group));
+  fprintf(stderr, "perf: hardware counters are only supported on Linux\n");
+  return -1;
+}
+
+void perf_group_close(perf_group_t *group)
+{
+  (void) group;
+}
+
+void perf_group_start(perf_group_t *group)
+{
+  (void) group;
+}
+
+int perf_group_stop(perf_group_t *group, perf_sample_t *sample)
+{
+  (void) group;
+  (void) sample;
+  return -1;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * @file perf.h
+ * @brief Hardware performance counters for the benchmarks (Linux only).
+ *
+ * Counters are opened as one perf_event group so they are scheduled
+ * together, and values are scaled when the kernel had to multiplex them.
+ *
+ */
+
+#ifndef _JLITE_BENCH_PERF_H
+#define _JLITE_BENCH_PERF_H
+
+#include <stdint.h>
+
+enum perf_counter
+{
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS,
+  PERF_BRANCH_MISSES,
+  PERF_CACHE_MISSES,
+  PERF_NUM_COUNTERS,
+};
+
+typedef struct
+{
+  int fds[PERF_NUM_COUNTERS];
+  int ids_valid;
+  uint64_t ids[PERF_NUM_COUNTERS];
+} perf_group_t;
+
+typedef struct
+{
+  uint64_t values[PERF_NUM_COUNTERS];
+} perf_sample_t;
+
+extern const char *const perf_counter_names[PERF_NUM_COUNTERS];
+
+/**
+ * @brief Open the counter group for the calling thread, user space only.
+ *
+ * @return 0 on success, -1 if counters are unavailable (not Linux, no PMU
+ * or perf_event_paranoid forbids it). A message is printed on failure.
+ */
+int perf_group_open(perf_group_t *group);
+
+void perf_group_close(perf_group_t *group);
+
+/**
+ * @brief Reset and enable all counters of the group.
+ */
+void perf_group_start(perf_group_t *group);
+
+/**
+ * @brief Disable the counters and add their scaled values to sample.
+ *
+ * @return 0 on success, -1 if the counters could not be read.
+ */
+int perf_group_stop(perf_group_t *group, perf_sample_t *sample);
+
+#endif /* _JLITE_BENCH_PERF_H */
@@ -30,13 +30,80 @@
  *
  */
 
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include "jlite.h"
+#include "jlite_index.h"
+#include "jlite_intern.h"
+#include "jlite_shape_internal.h"
+#include "jsmn/jsmn_variants.h"
 
 #define JLITE_MAX_NUMBER_LEN 16
 
+#if JLITE_STATS
+#include <time.h>
+
+/* Monotonic clock for parse timing, override for targets without one. */
+#ifndef JLITE_STATS_NOW_NS
+#if defined(CLOCK_MONOTONIC)
+static unsigned long jlite_stats_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long) ts.tv_sec * 1000000000UL + (unsigned long) ts.tv_nsec;
+}
+#define JLITE_STATS_NOW_NS() jlite_stats_now_ns()
+#else
+#define JLITE_STATS_NOW_NS() \
+  ((unsigned long) ((double) clock() * 1e9 / CLOCKS_PER_SEC))
+#endif
+#endif
+
+#define JLITE_STAT_ADD(jsonobj, field, n) ((jsonobj)->stats.field += (n))
+#define JLITE_STAT_MAX(jsonobj, field, n) \
+  do \
+  { \
+    if ((unsigned long) (n) > (jsonobj)->stats.field) \
+    { \
+      (jsonobj)->stats.field = (unsigned long) (n); \
+    } \
+  } while (0)
+#define JLITE_STAT_SKIP_ENTER(jsonobj) \
+  do \
+  { \
+    (jsonobj)->stats.skip_calls++; \
+    (jsonobj)->skip_depth++; \
+    JLITE_STAT_MAX(jsonobj, max_skip_depth, (jsonobj)->skip_depth); \
+  } while (0)
+#define JLITE_STAT_SKIP_LEAVE(jsonobj) ((jsonobj)->skip_depth--)
+
+/* Lookups scan tokens linearly, so the distance covers every visited token. */
+static void jlite_stats_lookup(jliteobj_t *jsonobj, int start_pos,
+    int end_pos, int comparisons)
+{
+  unsigned long visited = (unsigned long) (end_pos - start_pos + 1);
+
+  jsonobj->stats.lookups++;
+  jsonobj->stats.key_comparisons += (unsigned long) comparisons;
+  jsonobj->stats.tokens_visited += visited;
+  jsonobj->stats.last_lookup_tokens = visited;
+  JLITE_STAT_MAX(jsonobj, max_lookup_tokens, visited);
+}
+#define JLITE_STAT_LOOKUP(jsonobj, start_pos, end_pos, comparisons) \
+  jlite_stats_lookup(jsonobj, start_pos, end_pos, comparisons)
+#else
+#define JLITE_STAT_ADD(jsonobj, field, n) do {} while (0)
+#define JLITE_STAT_MAX(jsonobj, field, n) do {} while (0)
+#define JLITE_STAT_SKIP_ENTER(jsonobj) do {} while (0)
+#define JLITE_STAT_SKIP_LEAVE(jsonobj) do {} while (0)
+#define JLITE_STAT_LOOKUP(jsonobj, start_pos, end_pos, comparisons) \
+  do {} while (0)
+#endif
+
 static int jlite_jsoneq(const char *jsonstr, jlitetok_t *token,
     const char *key)
 {
@@ -60,9 +127,25 @@ static int jlite_jsoneq(const char *jsonstr, jlitetok_t *token,
   return -JLITE_E_NO_MATCH;
 }
 
-static int jlite_skip_array(jliteobj_t *jsonobj, int *pos);
+/*
+ * Array sizes and string lengths are int in the API, with JSMN_LARGE a
+ * token can exceed that.
+ */
+static int jlite_size_to_int(jsmnint_t value, int *out)
+{
+#ifdef JSMN_LARGE
+  if (value > INT_MAX)
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
+#endif
+  *out = (int) value;
+  return JLITE_OK;
+}
+
+static int jlite_skip_array(jliteobj_t *jsonobj, jsmnint_t *pos);
 
-static int jlite_skip_object(jliteobj_t *jsonobj, int *pos)
+static int jlite_skip_object(jliteobj_t *jsonobj, jsmnint_t *pos)
 {
   if (!jsonobj || !pos)
   {
@@ -70,11 +153,12 @@ static int jlite_skip_object(jliteobj_t *jsonobj, int *pos)
   }
 
   int ret = 0;
-  int cur_pos = 0;
-  int size = 0;
-  int i = 0;
+  jsmnint_t cur_pos = 0;
+  jsmnint_t size = 0;
+  jsmnint_t i = 0;
 
   cur_pos = *pos;
+  JLITE_STAT_SKIP_ENTER(jsonobj);
   size = jsonobj->tokens[cur_pos].size;
   for (i = 0; i < size; i++)
   {
@@ -85,6 +169,7 @@ static int jlite_skip_object(jliteobj_t *jsonobj, int *pos)
       ret = jlite_skip_object(jsonobj, &cur_pos);
       if (ret != JLITE_OK)
       {
+        JLITE_STAT_SKIP_LEAVE(jsonobj);
         return ret;
       }
     }
@@ -94,6 +179,7 @@ static int jlite_skip_object(jliteobj_t *jsonobj, int *pos)
       ret = jlite_skip_array(jsonobj, &cur_pos);
       if (ret != JLITE_OK)
       {
+        JLITE_STAT_SKIP_LEAVE(jsonobj);
         return ret;
       }
     }
@@ -102,11 +188,12 @@ static int jlite_skip_object(jliteobj_t *jsonobj, int *pos)
       cur_pos = cur_pos + 1;
     }
   }
+  JLITE_STAT_SKIP_LEAVE(jsonobj);
   *pos = cur_pos;
   return JLITE_OK;
 }
 
-static int jlite_skip_array(jliteobj_t *jsonobj, int *pos)
+static int jlite_skip_array(jliteobj_t *jsonobj, jsmnint_t *pos)
 {
   if (!jsonobj || !pos)
   {
@@ -114,11 +201,12 @@ static int jlite_skip_array(jliteobj_t *jsonobj, int *pos)
   }
 
   int ret = 0;
-  int cur_pos = 0;
-  int size = 0;
-  int i = 0;
+  jsmnint_t cur_pos = 0;
+  jsmnint_t size = 0;
+  jsmnint_t i = 0;
 
   cur_pos = *pos;
+  JLITE_STAT_SKIP_ENTER(jsonobj);
   size = jsonobj->tokens[cur_pos].size;
   for (i = 0; i < size; i++)
   {
@@ -128,6 +216,7 @@ static int jlite_skip_array(jliteobj_t *jsonobj, int *pos)
       ret = jlite_skip_object(jsonobj, &cur_pos);
       if (ret != JLITE_OK)
       {
+        JLITE_STAT_SKIP_LEAVE(jsonobj);
         return ret;
       }
     }
@@ -137,6 +226,7 @@ static int jlite_skip_array(jliteobj_t *jsonobj, int *pos)
       ret = jlite_skip_array(jsonobj, &cur_pos);
       if (ret != JLITE_OK)
       {
+        JLITE_STAT_SKIP_LEAVE(jsonobj);
         return ret;
       }
     }
@@ -145,24 +235,39 @@ static int jlite_skip_array(jliteobj_t *jsonobj, int *pos)
       cur_pos++;
     }
   }
+  JLITE_STAT_SKIP_LEAVE(jsonobj);
   *pos = cur_pos;
   return JLITE_OK;
 }
 
+jsmnint_t jlite_next_sibling(const jlitetok_t *tokens, jsmnint_t pos)
+{
+  jsmnint_t pending = 1;
+
+  while (pending)
+  {
+    pending += tokens[pos].size - 1;
+    pos++;
+  }
+  return pos;
+}
+
 static int jlite_find_key_position(jliteobj_t *jsonobj, const char *key,
-    int *pos)
+    jsmnint_t *pos)
 {
   if (!jsonobj || !key || !pos)
   {
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int i = 0;
+  jsmnint_t i = 0;
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
   jlitetok_t *tokens = NULL;
   char *jsonstr = NULL;
-  int size = 0;
+  jsmnint_t size = 0;
+  jlite_key_id_t id = 0;
+  jlite_shape_probe_t probe;
 
   cur_pos = jsonobj->cur_pos;
   tokens = jsonobj->tokens;
@@ -173,13 +278,40 @@ static int jlite_find_key_position(jliteobj_t *jsonobj, const char *key,
     return -JLITE_E_NOT_OBJECT;
   }
 
+  if (jsonobj->shape)
+  {
+    ret = jlite_shape_predict(jsonobj->shape, jsonobj, key, &probe);
+    if (ret >= 0)
+    {
+      JLITE_STAT_LOOKUP(jsonobj, ret, ret + 1, 1);
+      *pos = ret + 1;
+      return JLITE_OK;
+    }
+  }
+
   size = tokens[cur_pos - 1].size;
 
+  /* Interned: resolve the key once, then compare IDs. */
+  if (jsonobj->key_ids)
+  {
+    id = jlite_intern_find(jsonobj->intern, key, strlen(key));
+    if (!id)
+    {
+      JLITE_STAT_LOOKUP(jsonobj, jsonobj->cur_pos, cur_pos, 0);
+      return -JLITE_E_KEY_NOT_FOUND;
+    }
+  }
+
   for (i = 0; i < size; i++)
   {
-    ret = jlite_jsoneq(jsonstr, &tokens[cur_pos], key);
-    if (ret == JLITE_OK)
+    if (id ? jsonobj->key_ids[cur_pos] == id :
+        jlite_jsoneq(jsonstr, &tokens[cur_pos], key) == JLITE_OK)
     {
+      JLITE_STAT_LOOKUP(jsonobj, jsonobj->cur_pos, cur_pos + 1, i + 1);
+      if (jsonobj->shape)
+      {
+        jlite_shape_learn(&probe, jsonobj, (int) cur_pos);
+      }
       *pos = cur_pos + 1;
       return JLITE_OK;
     }
@@ -211,25 +343,37 @@ static int jlite_find_key_position(jliteobj_t *jsonobj, const char *key,
     }
   }
 
+  JLITE_STAT_LOOKUP(jsonobj, jsonobj->cur_pos, cur_pos - 1, size);
   return -JLITE_E_KEY_NOT_FOUND;
 }
 
 int jlite_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
-    int num_tokens, char *jsonstr, int jsonstr_len)
+    jsmnint_t num_tokens, char *jsonstr, jsmnint_t jsonstr_len)
 {
-  if (!jsonobj || !tokens || !num_tokens || !jsonstr || !jsonstr_len)
+  if (!jsonobj || !tokens || num_tokens <= 0 || !jsonstr || jsonstr_len <= 0)
   {
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int ret = 0;
+  jsmnint_t ret = 0;
 
   memset(jsonobj, 0, sizeof(*jsonobj));
   jlite_parser *j_parser = &jsonobj->j_parser;
 
+#if JLITE_STATS
+  unsigned long parse_start_ns = JLITE_STATS_NOW_NS();
+#endif
+
   jsmn_init(j_parser);
 
-  ret = jsmn_parse(j_parser, jsonstr, jsonstr_len, tokens, num_tokens);
+  ret = jsmn_parse_default(j_parser, jsonstr, jsonstr_len, tokens, num_tokens);
+
+#if JLITE_STATS
+  jsonobj->stats.parse_time_ns = JLITE_STATS_NOW_NS() - parse_start_ns;
+  jsonobj->stats.parse_bytes = j_parser->pos;
+  jsonobj->stats.tokens_produced = j_parser->toknext;
+#endif
+
   if (ret < 0)
   {
     return -JLITE_ERR;
@@ -255,7 +399,7 @@ int jlite_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
   return JLITE_OK;
 }
 
-static int jlite_get_value_str_by_pos(jliteobj_t *jsonobj, int pos,
+static int jlite_get_value_str_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
     char *value, int max_value_len)
 {
   if (!jsonobj || !value || !max_value_len)
@@ -263,7 +407,7 @@ static int jlite_get_value_str_by_pos(jliteobj_t *jsonobj, int pos,
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int value_len = 0;
+  jsmnint_t value_len = 0;
   char *jsonstr = NULL;
   jlitetok_t *token = NULL;
 
@@ -272,15 +416,107 @@ static int jlite_get_value_str_by_pos(jliteobj_t *jsonobj, int pos,
   value_len = token->end - token->start + 1;
   if (value_len > max_value_len)
   {
+    JLITE_STAT_ADD(jsonobj, buffer_too_small, 1);
     return -JLITE_E_NO_BUFFER_MEM;
   }
 
-  snprintf(value, value_len, "%s", jsonstr + token->start);
+  memcpy(value, jsonstr + token->start, (size_t) value_len - 1);
+  value[value_len - 1] = '\0';
 
   return JLITE_OK;
 }
 
-static int jlite_get_value_int_by_pos(jliteobj_t *jsonobj, int pos,
+/* Kind of the token at pos, tokens built without one are classified here. */
+static jsmnkind_t jlite_token_kind(jliteobj_t *jsonobj, jsmnint_t pos)
+{
+  jlitetok_t *token = &jsonobj->tokens[pos];
+
+  if (token->type != JSMN_PRIMITIVE)
+  {
+    return JSMN_KIND_NONE;
+  }
+  if (token->kind != JSMN_KIND_NONE)
+  {
+    return (jsmnkind_t) token->kind;
+  }
+  return jsmn_primitive_kind(jsonobj->jsonstr + token->start,
+      (size_t) (token->end - token->start));
+}
+
+/*
+ * Decode the number at pos, from the number table when one is attached.
+ * Integers go to *value_int and set *is_int, other numbers to *value_double.
+ */
+static int jlite_get_number_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
+    int64_t *value_int, double *value_double, int *is_int)
+{
+  jlitetok_t *token = &jsonobj->tokens[pos];
+  const char *str = jsonobj->jsonstr + token->start;
+  int len = 0;
+
+  *is_int = 0;
+  switch (jlite_token_kind(jsonobj, pos))
+  {
+    case JSMN_KIND_INT:
+      *is_int = 1;
+      if (jsonobj->numbers)
+      {
+        *value_int = jsonobj->numbers[pos].i;
+        return JLITE_OK;
+      }
+      return jlite_number_to_int64(str, (int) (token->end - token->start),
+          value_int);
+    case JSMN_KIND_FLOAT:
+      if (jsonobj->numbers && !isnan(jsonobj->numbers[pos].d))
+      {
+        *value_double = jsonobj->numbers[pos].d;
+        return JLITE_OK;
+      }
+      if (jlite_size_to_int(token->end - token->start, &len) != JLITE_OK)
+      {
+        return -JLITE_E_NO_BUFFER_MEM;
+      }
+      return jlite_number_to_double(str, len, value_double);
+    default:
+      return -JLITE_E_NOT_NUMBER;
+  }
+}
+
+/* Integer at pos, other numbers fail as in jlite_number_to_int64(). */
+static int jlite_get_value_int64_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
+    int64_t *value)
+{
+  jlitetok_t *token = &jsonobj->tokens[pos];
+  double value_double = 0;
+  int is_int = 0;
+  int ret = 0;
+
+  ret = jlite_get_number_by_pos(jsonobj, pos, value, &value_double, &is_int);
+  if (ret != JLITE_OK || is_int)
+  {
+    return ret;
+  }
+  return jlite_number_to_int64(jsonobj->jsonstr + token->start,
+      (int) (token->end - token->start), value);
+}
+
+static int jlite_get_value_double_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
+    double *value)
+{
+  int64_t value_int = 0;
+  int is_int = 0;
+  int ret = 0;
+
+  ret = jlite_get_number_by_pos(jsonobj, pos, &value_int, value, &is_int);
+  if (ret == JLITE_OK && is_int)
+  {
+    *value = (double) value_int;
+  }
+  return ret;
+}
+
+/* Floats are truncated, like atoi() did before numbers had kinds. */
+static int jlite_get_value_int_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
     int *value)
 {
   if (!jsonobj || !value)
@@ -289,20 +525,28 @@ static int jlite_get_value_int_by_pos(jliteobj_t *jsonobj, int pos,
   }
 
   int ret = 0;
-  char value_str[JLITE_MAX_NUMBER_LEN + 1] = "";
-  int max_value_len = JLITE_MAX_NUMBER_LEN;
+  int is_int = 0;
+  int64_t value_int = 0;
+  double value_double = 0;
 
-  ret = jlite_get_value_str_by_pos(jsonobj, pos, value_str, max_value_len);
+  ret = jlite_get_number_by_pos(jsonobj, pos, &value_int, &value_double,
+      &is_int);
   if (ret != JLITE_OK)
   {
     return ret;
   }
 
-  *value = atoi(value_str);
+  if (is_int ? value_int < INT_MIN || value_int > INT_MAX :
+      !(value_double > (double) INT_MIN - 1 &&
+      value_double < (double) INT_MAX + 1))
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
+  *value = is_int ? (int) value_int : (int) value_double;
   return JLITE_OK;
 }
 
-static int jlite_get_value_float_by_pos(jliteobj_t *jsonobj, int pos,
+static int jlite_get_value_float_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
     float *value)
 {
   if (!jsonobj || !value)
@@ -311,43 +555,100 @@ static int jlite_get_value_float_by_pos(jliteobj_t *jsonobj, int pos,
   }
 
   int ret = 0;
-  char value_str[JLITE_MAX_NUMBER_LEN + 1] = "";
-  int max_value_len = JLITE_MAX_NUMBER_LEN;
+  double value_double = 0;
 
-  ret = jlite_get_value_str_by_pos(jsonobj, pos, value_str, max_value_len);
+  ret = jlite_get_value_double_by_pos(jsonobj, pos, &value_double);
   if (ret != JLITE_OK)
   {
     return ret;
   }
 
-  *value = atof(value_str);
+  *value = (float) value_double;
   return JLITE_OK;
 }
 
-static int jlite_get_value_number_str(jliteobj_t *jsonobj,
-    const char *key, char *value_str, int max_value_len)
+/* true, false and the integers 1 and 0. */
+static int jlite_get_value_bool_by_pos(jliteobj_t *jsonobj, jsmnint_t pos,
+    int *value)
 {
-  if (!jsonobj || !key || !value_str || !max_value_len)
+  jlitetok_t *token = &jsonobj->tokens[pos];
+
+  switch (jlite_token_kind(jsonobj, pos))
   {
-    return -JLITE_E_INVALID_PARAM;
+    case JSMN_KIND_TRUE:
+      *value = 1;
+      return JLITE_OK;
+    case JSMN_KIND_FALSE:
+      *value = 0;
+      return JLITE_OK;
+    case JSMN_KIND_INT:
+      if (token->end - token->start == 1)
+      {
+        *value = jsonobj->jsonstr[token->start] == '1';
+        if (*value || jsonobj->jsonstr[token->start] == '0')
+        {
+          return JLITE_OK;
+        }
+      }
+      return -JLITE_E_NOT_BOOLEAN;
+    default:
+      return -JLITE_E_NOT_BOOLEAN;
   }
+}
 
+/* Position of the primitive value of key. */
+static int jlite_find_primitive_position(jliteobj_t *jsonobj,
+    const char *key, jsmnint_t *pos)
+{
   int ret = 0;
-  int cur_pos = 0;
 
-  ret = jlite_find_key_position(jsonobj, key, &cur_pos);
+  ret = jlite_find_key_position(jsonobj, key, pos);
   if (ret != 0)
   {
     return ret;
   }
 
-  if (jsonobj->tokens[cur_pos].type != JSMN_PRIMITIVE)
+  if (jsonobj->tokens[*pos].type != JSMN_PRIMITIVE)
   {
     return -JLITE_E_NOT_NUMBER;
   }
+  return JLITE_OK;
+}
+
+int jlite_decode_numbers(jliteobj_t *jsonobj, jlite_number_t *numbers,
+    jsmnint_t num_numbers)
+{
+  if (!jsonobj || !jsonobj->tokens || !numbers)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jsmnint_t i = 0;
+  int ret = 0;
+  int is_int = 0;
+
+  if (num_numbers < jsonobj->num_tokens)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
 
-  return jlite_get_value_str_by_pos(jsonobj, cur_pos, value_str,
-      max_value_len);
+  jsonobj->numbers = NULL;
+  for (i = 0; i < jsonobj->num_tokens; i++)
+  {
+    if (jsonobj->tokens[i].type != JSMN_PRIMITIVE)
+    {
+      continue;
+    }
+    ret = jlite_get_number_by_pos(jsonobj, i, &numbers[i].i, &numbers[i].d,
+        &is_int);
+    if (ret != JLITE_OK && ret != -JLITE_E_NOT_NUMBER)
+    {
+      numbers[i].d = NAN;
+    }
+  }
+  jsonobj->numbers = numbers;
+
+  return JLITE_OK;
 }
 
 int jlite_get_value_float(jliteobj_t *jsonobj, const char *key,
@@ -359,21 +660,19 @@ int jlite_get_value_float(jliteobj_t *jsonobj, const char *key,
   }
 
   int ret = 0;
-  char value_str[JLITE_MAX_NUMBER_LEN + 1] = "";
-  int max_value_len = JLITE_MAX_NUMBER_LEN;
+  jsmnint_t cur_pos = 0;
 
-  ret = jlite_get_value_number_str(jsonobj, key, value_str, max_value_len);
+  ret = jlite_find_primitive_position(jsonobj, key, &cur_pos);
   if (ret != JLITE_OK)
   {
     return ret;
   }
 
-  *value = atof(value_str);
-
-  return JLITE_OK;
+  return jlite_get_value_float_by_pos(jsonobj, cur_pos, value);
 }
 
-int jlite_get_value_bool(jliteobj_t *jsonobj, const char *key, int *value)
+int jlite_get_value_double(jliteobj_t *jsonobj, const char *key,
+    double *value)
 {
   if (!jsonobj || !key || !value)
   {
@@ -381,40 +680,57 @@ int jlite_get_value_bool(jliteobj_t *jsonobj, const char *key, int *value)
   }
 
   int ret = 0;
-  char value_str[JLITE_MAX_NUMBER_LEN + 1] = "";
-  int max_value_len = JLITE_MAX_NUMBER_LEN;
+  jsmnint_t cur_pos = 0;
 
-  ret = jlite_get_value_number_str(jsonobj, key, value_str, max_value_len);
+  ret = jlite_find_primitive_position(jsonobj, key, &cur_pos);
   if (ret != JLITE_OK)
   {
     return ret;
   }
 
-  if (strncmp(value_str, "true", max_value_len) == 0)
-  {
-    *value = 1;
-  }
-  else if (strncmp(value_str, "1", max_value_len) == 0)
+  return jlite_get_value_double_by_pos(jsonobj, cur_pos, value);
+}
+
+int jlite_get_value_bool(jliteobj_t *jsonobj, const char *key, int *value)
+{
+  if (!jsonobj || !key || !value)
   {
-    *value = 1;
+    return -JLITE_E_INVALID_PARAM;
   }
-  else if (strncmp(value_str, "false", max_value_len) == 0)
+
+  int ret = 0;
+  jsmnint_t cur_pos = 0;
+
+  ret = jlite_find_primitive_position(jsonobj, key, &cur_pos);
+  if (ret != JLITE_OK)
   {
-    *value = 0;
+    return ret;
   }
-  else if (strncmp(value_str, "0", max_value_len) == 0)
+
+  return jlite_get_value_bool_by_pos(jsonobj, cur_pos, value);
+}
+
+int jlite_get_value_int(jliteobj_t *jsonobj, const char *key, int *value)
+{
+  if (!jsonobj || !key || !value)
   {
-    *value = 0;
+    return -JLITE_E_INVALID_PARAM;
   }
-  else
+
+  int ret = 0;
+  jsmnint_t cur_pos = 0;
+
+  ret = jlite_find_primitive_position(jsonobj, key, &cur_pos);
+  if (ret != JLITE_OK)
   {
-    return -JLITE_E_NOT_BOOLEAN;
+    return ret;
   }
 
-  return JLITE_OK;
+  return jlite_get_value_int_by_pos(jsonobj, cur_pos, value);
 }
 
-int jlite_get_value_int(jliteobj_t *jsonobj, const char *key, int *value)
+int jlite_get_value_int64(jliteobj_t *jsonobj, const char *key,
+    int64_t *value)
 {
   if (!jsonobj || !key || !value)
   {
@@ -422,19 +738,36 @@ int jlite_get_value_int(jliteobj_t *jsonobj, const char *key, int *value)
   }
 
   int ret = 0;
-  char value_str[JLITE_MAX_NUMBER_LEN + 1] = "";
-  int max_value_len = JLITE_MAX_NUMBER_LEN;
+  jsmnint_t cur_pos = 0;
 
-  ret = jlite_get_value_number_str(jsonobj, key, value_str, max_value_len);
+  ret = jlite_find_primitive_position(jsonobj, key, &cur_pos);
   if (ret != JLITE_OK)
   {
     return ret;
   }
 
-  *value = atoi(value_str);
+  return jlite_get_value_int64_by_pos(jsonobj, cur_pos, value);
+}
+
+int jlite_get_value_kind(jliteobj_t *jsonobj, const char *key,
+    jsmnkind_t *kind)
+{
+  if (!jsonobj || !key || !kind)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jsmnint_t cur_pos = 0;
 
-  return JLITE_OK;
+  ret = jlite_find_key_position(jsonobj, key, &cur_pos);
+  if (ret != 0)
+  {
+    return ret;
+  }
 
+  *kind = jlite_token_kind(jsonobj, cur_pos);
+  return JLITE_OK;
 }
 
 int jlite_get_value_str_len(jliteobj_t *jsonobj, const char *key,
@@ -446,7 +779,7 @@ int jlite_get_value_str_len(jliteobj_t *jsonobj, const char *key,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_find_key_position(jsonobj, key, &cur_pos);
   if (ret != 0)
@@ -454,8 +787,8 @@ int jlite_get_value_str_len(jliteobj_t *jsonobj, const char *key,
     return ret;
   }
 
-  *value_len = jsonobj->tokens[cur_pos].end - jsonobj->tokens[cur_pos].start;
-  return JLITE_OK;
+  return jlite_size_to_int(jsonobj->tokens[cur_pos].end -
+      jsonobj->tokens[cur_pos].start, value_len);
 }
 
 int jlite_get_value_str(jliteobj_t *jsonobj, const char *key, char *value,
@@ -467,7 +800,7 @@ int jlite_get_value_str(jliteobj_t *jsonobj, const char *key, char *value,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_find_key_position(jsonobj, key, &cur_pos);
   if (ret != 0)
@@ -491,7 +824,7 @@ int jlite_get_json_object(jliteobj_t *jsonobj, const char *key)
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_find_key_position(jsonobj, key, &cur_pos);
   if (ret != 0)
@@ -509,7 +842,7 @@ int jlite_get_json_object(jliteobj_t *jsonobj, const char *key)
   return JLITE_OK;
 }
 
-static int jlite_get_json_obj_by_pos(jliteobj_t *jsonobj, int cur_pos)
+static int jlite_get_json_obj_by_pos(jliteobj_t *jsonobj, jsmnint_t cur_pos)
 {
   if (!jsonobj)
   {
@@ -533,7 +866,7 @@ int jlite_release_json_object(jliteobj_t *jsonobj)
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   cur_pos = jsonobj->cur_pos;
   cur_pos = jsonobj->tokens[cur_pos].parent;
@@ -550,7 +883,8 @@ int jlite_release_json_object(jliteobj_t *jsonobj)
   return JLITE_OK;
 }
 
-static int jlite_get_json_array_by_pos(jliteobj_t *jsonobj, int cur_pos, int *size)
+static int jlite_get_json_array_by_pos(jliteobj_t *jsonobj, jsmnint_t cur_pos,
+    int *size)
 {
   if (!jsonobj || !size)
   {
@@ -562,14 +896,17 @@ static int jlite_get_json_array_by_pos(jliteobj_t *jsonobj, int cur_pos, int *si
     return -JLITE_E_NOT_ARRAY;
   }
 
-  *size = jsonobj->tokens[cur_pos].size;
+  if (jlite_size_to_int(jsonobj->tokens[cur_pos].size, size) != JLITE_OK)
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
   cur_pos++;
   jsonobj->cur_pos = cur_pos;
   return JLITE_OK;
 }
 
 static int jlite_get_json_array_position(jliteobj_t *jsonobj,
-    const char *key, int *pos)
+    const char *key, jsmnint_t *pos)
 {
   if (!jsonobj || !key || !pos)
   {
@@ -577,7 +914,7 @@ static int jlite_get_json_array_position(jliteobj_t *jsonobj,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_find_key_position(jsonobj, key, &cur_pos);
   if (ret != 0)
@@ -602,7 +939,7 @@ int jlite_get_json_array(jliteobj_t *jsonobj, const char *key, int *size)
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_position(jsonobj, key, &cur_pos);
   if (ret != JLITE_OK)
@@ -610,7 +947,11 @@ int jlite_get_json_array(jliteobj_t *jsonobj, const char *key, int *size)
     return ret;
   }
 
-  *size = jsonobj->tokens[cur_pos].size;
+  ret = jlite_size_to_int(jsonobj->tokens[cur_pos].size, size);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
   cur_pos++;
   jsonobj->cur_pos = cur_pos;
   return JLITE_OK;
@@ -625,7 +966,7 @@ int jlite_get_json_array_size(jliteobj_t *jsonobj, const char *key,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_position(jsonobj, key, &cur_pos);
   if (ret != JLITE_OK)
@@ -633,8 +974,7 @@ int jlite_get_json_array_size(jliteobj_t *jsonobj, const char *key,
     return ret;
   }
 
-  *size = jsonobj->tokens[cur_pos].size;
-  return JLITE_OK;
+  return jlite_size_to_int(jsonobj->tokens[cur_pos].size, size);
 }
 
 int jlite_release_json_array(jliteobj_t *jsonobj)
@@ -644,7 +984,7 @@ int jlite_release_json_array(jliteobj_t *jsonobj)
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   cur_pos = jsonobj->cur_pos;
   cur_pos--;
@@ -661,48 +1001,50 @@ int jlite_release_json_array(jliteobj_t *jsonobj)
 }
 
 static int jlite_get_json_array_element_offet_position(
-    jliteobj_t *jsonobj, int element_pos, int *offset_pos)
+    jliteobj_t *jsonobj, int element_pos, jsmnint_t *offset_pos)
 {
   if (!jsonobj || !offset_pos)
   {
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int cur_pos = 0;
+  jsmnint_t array_pos = 0;
+  jsmnint_t cur_pos = 0;
+  jsmnint_t index_pos = 0;
   int i = 0;
   jlitetok_t *tokens = NULL;
 
   tokens = jsonobj->tokens;
-  cur_pos = jsonobj->cur_pos;
-  cur_pos--;
-  if (tokens[cur_pos].type != JSMN_ARRAY)
+  array_pos = jsonobj->cur_pos - 1;
+  if (tokens[array_pos].type != JSMN_ARRAY)
   {
     return -JLITE_E_NOT_ARRAY;
   }
 
-  if (tokens[cur_pos].size < element_pos)
+  if (element_pos < 0 || tokens[array_pos].size <= element_pos)
   {
     return -JLITE_E_OUT_OF_BOUND;
   }
 
-  cur_pos++;
+  cur_pos = array_pos + 1;
+  JLITE_STAT_ADD(jsonobj, array_walks, 1);
 
-  for (i = 0; i < element_pos; i++)
+  /* Start from the nearest indexed element, see jlite_index.h. */
+  if (jsonobj->indexes)
   {
-    if (tokens[cur_pos].type == JSMN_OBJECT)
-    {
-      cur_pos = cur_pos + (tokens[cur_pos].size * 2) + 1;
-    }
-    else if (tokens[cur_pos].type == JSMN_ARRAY)
+    index_pos = jlite_index_seek(jsonobj, array_pos, element_pos, &i);
+    if (index_pos >= 0)
     {
-      cur_pos = cur_pos + (tokens[cur_pos].size) + 1;
-    }
-    else
-    {
-      cur_pos++;
+      cur_pos = index_pos;
     }
   }
 
+  for (; i < element_pos; i++)
+  {
+    cur_pos = jlite_next_sibling(tokens, cur_pos);
+  }
+
+  JLITE_STAT_ADD(jsonobj, array_walk_tokens, cur_pos - jsonobj->cur_pos);
   *offset_pos = cur_pos;
   return JLITE_OK;
 }
@@ -716,7 +1058,7 @@ int jlite_get_json_array_element_str(jliteobj_t *jsonobj,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_element_offet_position(jsonobj, element_pos,
       &cur_pos);
@@ -736,7 +1078,7 @@ int jlite_get_json_array_element_int(jliteobj_t *jsonobj,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_element_offet_position(jsonobj, element_pos,
       &cur_pos);
@@ -757,7 +1099,7 @@ int jlite_get_json_array_element_float(jliteobj_t *jsonobj,
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_element_offet_position(jsonobj, element_pos,
       &cur_pos);
@@ -777,7 +1119,7 @@ int jlite_get_array_element_object(jliteobj_t *jsonobj, int element_pos)
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_element_offet_position(jsonobj, element_pos,
       &cur_pos);
@@ -796,7 +1138,7 @@ int jlite_release_array_element_object(jliteobj_t *jsonobj)
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   cur_pos = jsonobj->cur_pos;
   cur_pos = jsonobj->tokens[cur_pos].parent;
@@ -813,6 +1155,7 @@ int jlite_release_array_element_object(jliteobj_t *jsonobj)
     return -JLITE_E_NOT_ARRAY;
   }
 
+  cur_pos++;
   jsonobj->cur_pos = cur_pos;
   return JLITE_OK;
 }
@@ -825,7 +1168,7 @@ int jlite_get_array_element_array(jliteobj_t *jsonobj, int element_pos, int *siz
   }
 
   int ret = 0;
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   ret = jlite_get_json_array_element_offet_position(jsonobj, element_pos,
       &cur_pos);
@@ -844,7 +1187,7 @@ int jlite_release_array_element_array(jliteobj_t *jsonobj)
     return -JLITE_E_INVALID_PARAM;
   }
 
-  int cur_pos = 0;
+  jsmnint_t cur_pos = 0;
 
   cur_pos = jsonobj->cur_pos;
   cur_pos = jsonobj->tokens[cur_pos].parent;
@@ -865,3 +1208,180 @@ int jlite_release_array_element_array(jliteobj_t *jsonobj)
   jsonobj->cur_pos = cur_pos;
   return JLITE_OK;
 }
+
+enum jlite_array_kind
+{
+  JLITE_ARRAY_INT,
+  JLITE_ARRAY_INT64,
+  JLITE_ARRAY_FLOAT,
+  JLITE_ARRAY_DOUBLE,
+  JLITE_ARRAY_BOOL,
+};
+
+/*
+ * Convert the primitive token at pos and store it at index i of values.
+ */
+static int jlite_convert_array_element(jliteobj_t *jsonobj, jsmnint_t pos,
+    enum jlite_array_kind kind, void *values, int i)
+{
+  int64_t value_int = 0;
+  double value_double = 0;
+  int ret = 0;
+
+  switch (kind)
+  {
+    case JLITE_ARRAY_INT:
+      ret = jlite_get_value_int64_by_pos(jsonobj, pos, &value_int);
+      if (ret == JLITE_OK && (value_int < INT32_MIN || value_int > INT32_MAX))
+      {
+        ret = -JLITE_E_OUT_OF_BOUND;
+      }
+      ((int *) values)[i] = (int) value_int;
+      return ret;
+    case JLITE_ARRAY_INT64:
+      return jlite_get_value_int64_by_pos(jsonobj, pos,
+          &((int64_t *) values)[i]);
+    case JLITE_ARRAY_FLOAT:
+      ret = jlite_get_value_double_by_pos(jsonobj, pos, &value_double);
+      ((float *) values)[i] = (float) value_double;
+      return ret;
+    case JLITE_ARRAY_DOUBLE:
+      return jlite_get_value_double_by_pos(jsonobj, pos,
+          &((double *) values)[i]);
+    default:
+      return jlite_get_value_bool_by_pos(jsonobj, pos, &((int *) values)[i]);
+  }
+}
+
+/*
+ * Convert every element of the held array in one pass. Scalars take one
+ * token each, so element i is at the array position + 1 + i until the first
+ * non-conforming element.
+ */
+static int jlite_get_json_array_values(jliteobj_t *jsonobj,
+    enum jlite_array_kind kind, void *values, int max_values,
+    int *num_values)
+{
+  if (!jsonobj || !values || !num_values)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jsmnint_t cur_pos = 0;
+  int size = 0;
+  int i = 0;
+  jlitetok_t *tokens = NULL;
+
+  tokens = jsonobj->tokens;
+  cur_pos = jsonobj->cur_pos - 1;
+  if (tokens[cur_pos].type != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  if (jlite_size_to_int(tokens[cur_pos].size, &size) != JLITE_OK)
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
+  if (size > max_values)
+  {
+    JLITE_STAT_ADD(jsonobj, buffer_too_small, 1);
+    *num_values = size;
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  cur_pos++;
+  for (i = 0; i < size; i++, cur_pos++)
+  {
+    if (tokens[cur_pos].type != JSMN_PRIMITIVE)
+    {
+      *num_values = i;
+      return kind == JLITE_ARRAY_BOOL ? -JLITE_E_NOT_BOOLEAN :
+          -JLITE_E_NOT_NUMBER;
+    }
+
+    ret = jlite_convert_array_element(jsonobj, cur_pos, kind, values, i);
+    if (ret != JLITE_OK)
+    {
+      *num_values = i;
+      return ret;
+    }
+  }
+
+  *num_values = size;
+  return JLITE_OK;
+}
+
+int jlite_get_json_array_ints(jliteobj_t *jsonobj, int *values,
+    int max_values, int *num_values)
+{
+  return jlite_get_json_array_values(jsonobj, JLITE_ARRAY_INT, values,
+      max_values, num_values);
+}
+
+int jlite_get_json_array_int64s(jliteobj_t *jsonobj, int64_t *values,
+    int max_values, int *num_values)
+{
+  return jlite_get_json_array_values(jsonobj, JLITE_ARRAY_INT64, values,
+      max_values, num_values);
+}
+
+int jlite_get_json_array_floats(jliteobj_t *jsonobj, float *values,
+    int max_values, int *num_values)
+{
+  return jlite_get_json_array_values(jsonobj, JLITE_ARRAY_FLOAT, values,
+      max_values, num_values);
+}
+
+int jlite_get_json_array_doubles(jliteobj_t *jsonobj, double *values,
+    int max_values, int *num_values)
+{
+  return jlite_get_json_array_values(jsonobj, JLITE_ARRAY_DOUBLE, values,
+      max_values, num_values);
+}
+
+int jlite_get_json_array_bools(jliteobj_t *jsonobj, int *values,
+    int max_values, int *num_values)
+{
+  return jlite_get_json_array_values(jsonobj, JLITE_ARRAY_BOOL, values,
+      max_values, num_values);
+}
+
+int jlite_get_stats(jliteobj_t *jsonobj, jlite_stats_t *stats)
+{
+  if (!jsonobj || !stats)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+#if JLITE_STATS
+  *stats = jsonobj->stats;
+  return JLITE_OK;
+#else
+  memset(stats, 0, sizeof(*stats));
+  return -JLITE_E_NOT_SUPPORTED;
+#endif
+}
+
+int jlite_reset_stats(jliteobj_t *jsonobj)
+{
+  if (!jsonobj)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+#if JLITE_STATS
+  unsigned long tokens_produced = jsonobj->stats.tokens_produced;
+  unsigned long parse_bytes = jsonobj->stats.parse_bytes;
+  unsigned long parse_time_ns = jsonobj->stats.parse_time_ns;
+
+  memset(&jsonobj->stats, 0, sizeof(jsonobj->stats));
+  jsonobj->stats.tokens_produced = tokens_produced;
+  jsonobj->stats.parse_bytes = parse_bytes;
+  jsonobj->stats.parse_time_ns = parse_time_ns;
+  return JLITE_OK;
+#else
+  return -JLITE_E_NOT_SUPPORTED;
+#endif
+}
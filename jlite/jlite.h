@@ -33,6 +33,7 @@
 #ifndef _JLITE_H
 #define _JLITE_H
 
+#include <stdint.h>
 #include "jsmn/jsmn.h"
 
 #ifdef __cplusplus
@@ -43,6 +44,23 @@ extern "C" {
 
 #define JLITE_DEBUG 0
 
+/*
+ * Set JLITE_STATS to 1 (e.g. -DJLITE_STATS=1) to collect hot-path counters
+ * in every jliteobj_t. It changes the layout of jliteobj_t, so it must be
+ * set the same way for the library and all code using it.
+ */
+#ifndef JLITE_STATS
+#define JLITE_STATS 0
+#endif
+
+/*
+ * Define JSMN_LARGE (e.g. -DJSMN_LARGE) for documents of 2 GB and more.
+ * Offsets, lengths and token indices of the tokens, jliteobj_t and
+ * jlite_parse_init() become 64-bit, see jsmn/jsmn.h; array sizes and
+ * element positions of the getters stay int. Like JLITE_STATS it changes
+ * the layout of the types, so it must be set the same way everywhere.
+ */
+
 /**
  * @brief Error codes
  *
@@ -62,19 +80,79 @@ enum jlite_err
   JLITE_E_NO_BUFFER_MEM,
   JLITE_E_NO_MATCH,
   JLITE_E_INVALID_PARAM,
+  JLITE_E_NOT_SUPPORTED,
+  JLITE_E_INVALID_JSON,
+  JLITE_E_INVALID_UTF8,
 };
 
 typedef jsmntok_t jlitetok_t;
 typedef jsmn_parser jlite_parser;
 
+/**
+ * @brief Hot-path counters of a JSON object.
+ *
+ * Counters are only maintained when the library is built with
+ * JLITE_STATS set to 1. They are reset by jlite_parse_init() and
+ * jlite_reset_stats().
+ *
+ */
+
+typedef struct
+{
+  unsigned long tokens_produced;    /* Tokens filled by the last parse. */
+  unsigned long parse_bytes;        /* Bytes tokenized by the last parse. */
+  unsigned long parse_time_ns;      /* Time spent in the last parse. */
+  unsigned long lookups;            /* Key lookups performed. */
+  unsigned long tokens_visited;     /* Tokens scanned by all key lookups. */
+  unsigned long last_lookup_tokens; /* Tokens scanned by the last key lookup. */
+  unsigned long max_lookup_tokens;  /* Longest key lookup, in tokens. */
+  unsigned long key_comparisons;    /* Keys compared against a lookup key. */
+  unsigned long skip_calls;         /* Nested objects/arrays skipped. */
+  unsigned long max_skip_depth;     /* Deepest recursion while skipping. */
+  unsigned long array_walks;        /* Array element position lookups. */
+  unsigned long array_walk_tokens;  /* Tokens stepped over by those lookups. */
+  unsigned long buffer_too_small;   /* JLITE_E_NO_BUFFER_MEM failures. */
+} jlite_stats_t;
+
+struct jlite_shape;
+struct jlite_index;
+struct jlite_intern;
+
+/**
+ * @brief ID of an interned key, see jlite_intern.h.
+ *
+ */
+
+typedef uint32_t jlite_key_id_t;
+
+/**
+ * @brief Decoded value of a number token, see jlite_decode_numbers().
+ *
+ */
+
+typedef union
+{
+  int64_t i;  /* Value of a JSMN_KIND_INT token. */
+  double d;   /* Value of a JSMN_KIND_FLOAT token. */
+} jlite_number_t;
+
 typedef struct
 {
   char *jsonstr;
-  int jsonstr_len;
+  jsmnint_t jsonstr_len;
   jlite_parser j_parser;
   jlitetok_t *tokens;
-  int num_tokens;
-  int cur_pos;
+  jsmnint_t num_tokens;
+  jsmnint_t cur_pos;
+  struct jlite_shape *shape;  /* Key position predictor, see jlite_shape.h. */
+  jlite_number_t *numbers;    /* Decoded numbers, see jlite_decode_numbers(). */
+  struct jlite_index *indexes; /* Indexed arrays, see jlite_index.h. */
+  const jlite_key_id_t *key_ids; /* Key IDs, see jlite_intern.h. */
+  struct jlite_intern *intern;
+#if JLITE_STATS
+  jlite_stats_t stats;
+  int skip_depth;
+#endif
 } jliteobj_t;
 
 /**
@@ -95,7 +173,30 @@ typedef struct
  */
 
 int jlite_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
-    int num_tokens, char *jsonstr, int jsonstr_len);
+    jsmnint_t num_tokens, char *jsonstr, jsmnint_t jsonstr_len);
+
+/**
+ * @brief Decode every number of the JSON object into a side table.
+ *
+ * Call it right after parsing. numbers[i] receives the value of token i
+ * when it is a number: int64 for JSMN_KIND_INT tokens, double for
+ * JSMN_KIND_FLOAT ones. The table stays attached to jsonobj, and the number,
+ * bool and kind getters then read the value with one load instead of
+ * converting its text on every call. A FLOAT token whose text cannot be
+ * converted is stored as NaN and is converted again by the getters, which
+ * report the error.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param numbers Pointer to an array with one entry per token.
+ * @param num_numbers Number of entries in numbers.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if numbers has fewer entries than
+ * jsonobj has tokens.
+ *
+ */
+
+int jlite_decode_numbers(jliteobj_t *jsonobj, jlite_number_t *numbers,
+    jsmnint_t num_numbers);
 
 /**
  * @brief Get JSON float element value.
@@ -129,6 +230,53 @@ int jlite_get_value_float(jliteobj_t *jsonobj, const char *key,
 int jlite_get_value_int(jliteobj_t *jsonobj, const char *key,
     int *value);
 
+/**
+ * @brief Get JSON int element value as a 64-bit int.
+ *
+ * The value must be an integer, see jlite_number_to_int64().
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param key Name of JSON int element.
+ * @param value Pointer to an int64_t variable.
+ *
+ * @return errcode, JLITE_E_OUT_OF_BOUND if the value does not fit.
+ *
+ */
+
+int jlite_get_value_int64(jliteobj_t *jsonobj, const char *key,
+    int64_t *value);
+
+/**
+ * @brief Get JSON number element value as a double.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param key Name of JSON number element.
+ * @param value Pointer to a double variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_value_double(jliteobj_t *jsonobj, const char *key,
+    double *value);
+
+/**
+ * @brief Get the kind of JSON element.
+ *
+ * This tells true, false, null, int and float values apart without
+ * converting them. Objects, arrays and strings are JSMN_KIND_NONE.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param key Name of JSON element.
+ * @param kind Pointer to a jsmnkind_t variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_value_kind(jliteobj_t *jsonobj, const char *key,
+    jsmnkind_t *kind);
+
 /**
  * @brief Get JSON string element value
  *
@@ -358,6 +506,173 @@ int jlite_get_array_element_array(jliteobj_t *jsonobj, int element_pos,
 
 int jlite_release_array_element_array(jliteobj_t *jsonobj);
 
+/**
+ * @brief Get JSON int elements of already held JSON array.
+ *
+ * This converts all elements of the held JSON array in one pass into a
+ * contiguous buffer. Elements must be integers which fit in an int.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param values Pointer to the int array to fill.
+ * @param max_values Number of entries in values array.
+ * @param num_values Pointer to an int variable to get the number of
+ * converted elements. On JLITE_E_NO_BUFFER_MEM it is the array size, on
+ * conversion errors it is the position of the first non-conforming element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_json_array_ints(jliteobj_t *jsonobj, int *values,
+    int max_values, int *num_values);
+
+/**
+ * @brief Get JSON 64-bit int elements of already held JSON array.
+ *
+ * Same as jlite_get_json_array_ints() for 64-bit integers.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param values Pointer to the int64_t array to fill.
+ * @param max_values Number of entries in values array.
+ * @param num_values Pointer to an int variable to get the number of
+ * converted elements or the position of the first non-conforming element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_json_array_int64s(jliteobj_t *jsonobj, int64_t *values,
+    int max_values, int *num_values);
+
+/**
+ * @brief Get JSON float elements of already held JSON array.
+ *
+ * Same as jlite_get_json_array_ints() for any JSON number.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param values Pointer to the float array to fill.
+ * @param max_values Number of entries in values array.
+ * @param num_values Pointer to an int variable to get the number of
+ * converted elements or the position of the first non-conforming element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_json_array_floats(jliteobj_t *jsonobj, float *values,
+    int max_values, int *num_values);
+
+/**
+ * @brief Get JSON double elements of already held JSON array.
+ *
+ * Same as jlite_get_json_array_ints() for any JSON number.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param values Pointer to the double array to fill.
+ * @param max_values Number of entries in values array.
+ * @param num_values Pointer to an int variable to get the number of
+ * converted elements or the position of the first non-conforming element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_json_array_doubles(jliteobj_t *jsonobj, double *values,
+    int max_values, int *num_values);
+
+/**
+ * @brief Get JSON boolean elements of already held JSON array.
+ *
+ * Same as jlite_get_json_array_ints() for booleans (true, false, 1, 0).
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param values Pointer to the int array to fill with 1 or 0.
+ * @param max_values Number of entries in values array.
+ * @param num_values Pointer to an int variable to get the number of
+ * converted elements or the position of the first non-conforming element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_get_json_array_bools(jliteobj_t *jsonobj, int *values,
+    int max_values, int *num_values);
+
+/**
+ * @brief Get the token position after a value and its subtree.
+ *
+ * Skips by token sizes alone, without reading the JSON text, so it also
+ * works on tokens whose offsets are not in document order. For a key the
+ * result is the position after its value.
+ *
+ * @param tokens Pointer to array of JSON tokens.
+ * @param pos Token position of the value.
+ *
+ * @return token position of the next sibling, or one past the parent's
+ * subtree after the last sibling.
+ *
+ */
+
+jsmnint_t jlite_next_sibling(const jlitetok_t *tokens, jsmnint_t pos);
+
+/**
+ * @brief Convert a JSON number to a 64-bit int.
+ *
+ * The span must hold an integer without fraction or exponent.
+ *
+ * @param str Pointer to the first character of the number.
+ * @param len Length of the number.
+ * @param value Pointer to an int64_t variable.
+ *
+ * @return errcode, JLITE_E_OUT_OF_BOUND if the value does not fit.
+ *
+ */
+
+int jlite_number_to_int64(const char *str, int len, int64_t *value);
+
+/**
+ * @brief Convert a JSON number to a double.
+ *
+ * Common numbers are converted exactly without strtod(); long mantissas
+ * and large exponents fall back to it.
+ *
+ * @param str Pointer to the first character of the number.
+ * @param len Length of the number.
+ * @param value Pointer to a double variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_number_to_double(const char *str, int len, double *value);
+
+/**
+ * @brief Get hot-path counters of JSON object.
+ *
+ * This will copy the counters collected since the last parse or reset.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param stats Pointer to the stats structure to fill.
+ *
+ * @return errcode, JLITE_E_NOT_SUPPORTED if built without JLITE_STATS.
+ *
+ */
+
+int jlite_get_stats(jliteobj_t *jsonobj, jlite_stats_t *stats);
+
+/**
+ * @brief Reset hot-path counters of JSON object.
+ *
+ * Parse counters are kept, so they still describe the parsed document.
+ *
+ * @param jsonobj Pointer to JSON object.
+ *
+ * @return errcode, JLITE_E_NOT_SUPPORTED if built without JLITE_STATS.
+ *
+ */
+
+int jlite_reset_stats(jliteobj_t *jsonobj);
+
 #ifdef __cplusplus
 }
 #endif
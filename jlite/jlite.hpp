@@ -0,0 +1,514 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite.hpp
+ * @brief Header-only C++17 interface over the jlite token array.
+ *
+ * Values are (document, token position) pairs, so there is no get/release
+ * state to manage: navigating to a member or element returns a new value
+ * and leaves the parent untouched. Everything is inline and works directly
+ * on the tokens, which lets the compiler fold whole access chains.
+ *
+ *   jlite::fixed_document<256> doc;
+ *   if (doc.parse(json) == JLITE_OK)
+ *   {
+ *     int64_t id = doc.root()["user"]["id"].get<int64_t>().value_or(0);
+ *     for (jlite::value tag : doc.root()["tags"])
+ *     {
+ *       std::string_view name = tag.get<std::string_view>().value_or("");
+ *     }
+ *   }
+ *
+ * Strings are returned as views of the raw (still escaped) JSON text.
+ *
+ */
+
+#ifndef _JLITE_HPP
+#define _JLITE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include "jlite.h"
+#include "jlite_index.h"
+#include "jlite_intern.h"
+
+namespace jlite
+{
+
+/**
+ * @brief Value or negative jlite error code.
+ */
+template <class T>
+class result
+{
+public:
+  constexpr result(T value) : value_(value), err_(JLITE_OK) {}
+  static constexpr result error(int err) { return result(err, 0); }
+
+  constexpr bool has_value() const { return err_ == JLITE_OK; }
+  constexpr explicit operator bool() const { return has_value(); }
+  constexpr int error() const { return err_; }
+  constexpr const T &value() const { return value_; }
+  constexpr const T &operator*() const { return value_; }
+  constexpr T value_or(T fallback) const
+  {
+    return has_value() ? value_ : fallback;
+  }
+
+private:
+  constexpr result(int err, int) : value_(), err_(err) {}
+
+  T value_;
+  int err_;
+};
+
+class value;
+class member;
+
+namespace detail
+{
+
+template <class T, class Enable = void>
+struct converter;
+
+} /* namespace detail */
+
+/**
+ * @brief Iterator over array elements or object members.
+ */
+template <class T>
+class iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = T;
+
+  iterator(const jliteobj_t *doc, int pos, int remaining)
+    : doc_(doc), pos_(pos), remaining_(remaining) {}
+
+  T operator*() const { return T(doc_, pos_); }
+
+  iterator &operator++()
+  {
+    pos_ = static_cast<int>(jlite_next_sibling(doc_->tokens, pos_));
+    remaining_--;
+    return *this;
+  }
+
+  iterator operator++(int)
+  {
+    iterator prev = *this;
+    ++*this;
+    return prev;
+  }
+
+  bool operator==(const iterator &other) const
+  {
+    return remaining_ == other.remaining_;
+  }
+  bool operator!=(const iterator &other) const { return !(*this == other); }
+
+private:
+  const jliteobj_t *doc_;
+  int pos_;
+  int remaining_;
+};
+
+template <class T>
+class range
+{
+public:
+  range(const jliteobj_t *doc, int first, int count)
+    : doc_(doc), first_(first), count_(count) {}
+
+  iterator<T> begin() const { return iterator<T>(doc_, first_, count_); }
+  iterator<T> end() const { return iterator<T>(doc_, first_, 0); }
+  int size() const { return count_; }
+
+private:
+  const jliteobj_t *doc_;
+  int first_;
+  int count_;
+};
+
+/**
+ * @brief A JSON value inside a parsed document.
+ *
+ * A default constructed value, or the result of a failed lookup, is
+ * invalid; all accessors on it report JLITE_E_KEY_NOT_FOUND.
+ */
+class value
+{
+public:
+  value() : doc_(nullptr), pos_(-1) {}
+  value(const jliteobj_t *doc, int pos) : doc_(doc), pos_(pos) {}
+
+  bool valid() const { return doc_ && pos_ >= 0; }
+  explicit operator bool() const { return valid(); }
+  int position() const { return pos_; }
+  const jliteobj_t *object() const { return doc_; }
+
+  jsmntype_t type() const
+  {
+    return valid() ? static_cast<jsmntype_t>(doc_->tokens[pos_].type) :
+        JSMN_UNDEFINED;
+  }
+  /* true, false, null, int or float, JSMN_KIND_NONE for other types. */
+  jsmnkind_t kind() const
+  {
+    return type() == JSMN_PRIMITIVE ?
+        static_cast<jsmnkind_t>(doc_->tokens[pos_].kind) : JSMN_KIND_NONE;
+  }
+  bool is_object() const { return type() == JSMN_OBJECT; }
+  bool is_array() const { return type() == JSMN_ARRAY; }
+  bool is_string() const { return type() == JSMN_STRING; }
+  /* Entry of the number table, nullptr without one. */
+  const jlite_number_t *number() const
+  {
+    return valid() && doc_->numbers ? &doc_->numbers[pos_] : nullptr;
+  }
+  bool is_null() const
+  {
+    return kind() == JSMN_KIND_NULL;
+  }
+
+  /* Raw JSON text of the value, without quotes for strings. */
+  std::string_view raw() const
+  {
+    if (!valid())
+    {
+      return std::string_view();
+    }
+    const jlitetok_t &tok = doc_->tokens[pos_];
+    return std::string_view(doc_->jsonstr + tok.start,
+        static_cast<std::size_t>(tok.end - tok.start));
+  }
+
+  /* Number of array elements or object members. */
+  int size() const { return valid() ? doc_->tokens[pos_].size : 0; }
+
+  result<value> find(std::string_view key) const
+  {
+    if (!is_object())
+    {
+      return result<value>::error(valid() ? -JLITE_E_NOT_OBJECT :
+          -JLITE_E_KEY_NOT_FOUND);
+    }
+
+    const jlitetok_t *tokens = doc_->tokens;
+    jlite_key_id_t id = 0;
+    int pos = pos_ + 1;
+    if (doc_->key_ids)
+    {
+      id = jlite_intern_find(doc_->intern, key.data(), key.size());
+      if (!id)
+      {
+        return result<value>::error(-JLITE_E_KEY_NOT_FOUND);
+      }
+    }
+    for (int i = 0; i < tokens[pos_].size; i++)
+    {
+      const jlitetok_t &tok = tokens[pos];
+      if (id ? doc_->key_ids[pos] == id :
+          static_cast<std::size_t>(tok.end - tok.start) == key.size() &&
+          std::memcmp(doc_->jsonstr + tok.start, key.data(), key.size()) == 0)
+      {
+        return value(doc_, pos + 1);
+      }
+      pos = static_cast<int>(jlite_next_sibling(tokens, pos));
+    }
+    return result<value>::error(-JLITE_E_KEY_NOT_FOUND);
+  }
+
+  result<value> at(int index) const
+  {
+    if (!is_array())
+    {
+      return result<value>::error(valid() ? -JLITE_E_NOT_ARRAY :
+          -JLITE_E_KEY_NOT_FOUND);
+    }
+    if (index < 0 || index >= size())
+    {
+      return result<value>::error(-JLITE_E_OUT_OF_BOUND);
+    }
+
+    int pos = pos_ + 1;
+    int i = 0;
+    if (doc_->indexes)
+    {
+      jsmnint_t index_pos = jlite_index_seek(doc_, pos_, index, &i);
+      if (index_pos >= 0)
+      {
+        pos = static_cast<int>(index_pos);
+      }
+    }
+    for (; i < index; i++)
+    {
+      pos = static_cast<int>(jlite_next_sibling(doc_->tokens, pos));
+    }
+    return value(doc_, pos);
+  }
+
+  /* Lookups which chain: a missing step yields an invalid value. */
+  value operator[](std::string_view key) const
+  {
+    return find(key).value_or(value());
+  }
+  value operator[](int index) const { return at(index).value_or(value()); }
+
+  template <class T>
+  result<T> get() const
+  {
+    if (!valid())
+    {
+      return result<T>::error(-JLITE_E_KEY_NOT_FOUND);
+    }
+    return detail::converter<T>::convert(*this);
+  }
+
+  template <class T>
+  T get_or(T fallback) const { return get<T>().value_or(fallback); }
+
+  range<value> elements() const
+  {
+    return range<value>(doc_, pos_ + 1, is_array() ? size() : 0);
+  }
+  range<member> members() const
+  {
+    return range<member>(doc_, pos_ + 1, is_object() ? size() : 0);
+  }
+
+  /* Range-for iterates array elements. */
+  iterator<value> begin() const { return elements().begin(); }
+  iterator<value> end() const { return elements().end(); }
+
+private:
+  friend class member;
+
+  const jliteobj_t *doc_;
+  int pos_;
+};
+
+/**
+ * @brief An object member, constructed from the position of its key.
+ */
+class member
+{
+public:
+  member(const jliteobj_t *doc, int pos) : key_(doc, pos), value_(doc, pos + 1) {}
+
+  std::string_view key() const { return key_.raw(); }
+  /* ID of the key, 0 unless the document is interned. */
+  jlite_key_id_t key_id() const
+  {
+    const jliteobj_t *doc = key_.object();
+    return doc->key_ids ? doc->key_ids[key_.position()] : 0;
+  }
+  const jlite::value &value() const { return value_; }
+
+private:
+  jlite::value key_;
+  jlite::value value_;
+};
+
+namespace detail
+{
+
+template <>
+struct converter<value>
+{
+  static result<value> convert(const value &v) { return v; }
+};
+
+template <>
+struct converter<std::string_view>
+{
+  static result<std::string_view> convert(const value &v)
+  {
+    if (!v.is_string())
+    {
+      return result<std::string_view>::error(-JLITE_E_NOT_STRING);
+    }
+    return v.raw();
+  }
+};
+
+template <>
+struct converter<bool>
+{
+  static result<bool> convert(const value &v)
+  {
+    std::string_view raw = v.raw();
+
+    switch (v.kind())
+    {
+      case JSMN_KIND_TRUE:
+        return true;
+      case JSMN_KIND_FALSE:
+        return false;
+      case JSMN_KIND_INT:
+        if (raw == "1" || raw == "0")
+        {
+          return raw[0] == '1';
+        }
+        break;
+      default:
+        break;
+    }
+    return result<bool>::error(-JLITE_E_NOT_BOOLEAN);
+  }
+};
+
+template <class T>
+struct converter<T, typename std::enable_if<std::is_integral<T>::value &&
+    !std::is_same<T, bool>::value>::type>
+{
+  static result<T> convert(const value &v)
+  {
+    std::string_view raw = v.raw();
+    int64_t number = 0;
+    int ret = 0;
+
+    if (v.type() != JSMN_PRIMITIVE)
+    {
+      return result<T>::error(-JLITE_E_NOT_NUMBER);
+    }
+    if (v.kind() == JSMN_KIND_INT && v.number())
+    {
+      number = v.number()->i;
+    }
+    else
+    {
+      ret = jlite_number_to_int64(raw.data(), static_cast<int>(raw.size()),
+          &number);
+      if (ret != JLITE_OK)
+      {
+        return result<T>::error(ret);
+      }
+    }
+    if (std::is_unsigned<T>::value ? number < 0 ||
+        static_cast<uint64_t>(number) > std::numeric_limits<T>::max() :
+        number < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+        number > static_cast<int64_t>(std::numeric_limits<T>::max()))
+    {
+      return result<T>::error(-JLITE_E_OUT_OF_BOUND);
+    }
+    return static_cast<T>(number);
+  }
+};
+
+template <class T>
+struct converter<T, typename std::enable_if<
+    std::is_floating_point<T>::value>::type>
+{
+  static result<T> convert(const value &v)
+  {
+    std::string_view raw = v.raw();
+    double number = 0;
+    int ret = 0;
+
+    if (v.type() != JSMN_PRIMITIVE)
+    {
+      return result<T>::error(-JLITE_E_NOT_NUMBER);
+    }
+    if (v.number() && v.kind() == JSMN_KIND_INT)
+    {
+      return static_cast<T>(v.number()->i);
+    }
+    if (v.number() && v.kind() == JSMN_KIND_FLOAT &&
+        !std::isnan(v.number()->d))
+    {
+      return static_cast<T>(v.number()->d);
+    }
+    ret = jlite_number_to_double(raw.data(), static_cast<int>(raw.size()),
+        &number);
+    if (ret != JLITE_OK)
+    {
+      return result<T>::error(ret);
+    }
+    return static_cast<T>(number);
+  }
+};
+
+} /* namespace detail */
+
+/**
+ * @brief Parsed document over caller-provided tokens.
+ */
+class document
+{
+public:
+  document() { std::memset(&obj_, 0, sizeof(obj_)); }
+
+  int parse(std::string_view json, jlitetok_t *tokens, int num_tokens)
+  {
+    /* jlite never writes to the JSON string. */
+    return jlite_parse_init(&obj_, tokens, num_tokens,
+        const_cast<char *>(json.data()), static_cast<int>(json.size()));
+  }
+
+  value root() const
+  {
+    return obj_.num_tokens > 0 ? value(&obj_, 0) : value();
+  }
+
+  value operator[](std::string_view key) const { return root()[key]; }
+
+  /* Underlying C object, for the jlite_* APIs. */
+  jliteobj_t *c_obj() { return &obj_; }
+  const jliteobj_t *c_obj() const { return &obj_; }
+
+private:
+  jliteobj_t obj_;
+};
+
+/**
+ * @brief Document with an embedded token array of N tokens.
+ */
+template <int N>
+class fixed_document : public document
+{
+public:
+  int parse(std::string_view json)
+  {
+    return document::parse(json, tokens_, N);
+  }
+
+private:
+  jlitetok_t tokens_[N];
+};
+
+} /* namespace jlite */
+
+#endif /* _JLITE_HPP */
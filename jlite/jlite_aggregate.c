@@ -0,0 +1,382 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_aggregate.c
+ * @brief This file contains the aggregate API definition.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+#include "jlite_aggregate.h"
+#include "jlite_simd.h"
+
+/*
+ * Integers are reduced as int64 while the sum is exact. Other numbers are
+ * decoded into a batch, then reduced two lanes at a time.
+ */
+#define JLITE_AGG_BATCH 64
+
+typedef struct
+{
+  jlite_agg_t *agg;
+  long int_count;
+  int64_t int_min;
+  int64_t int_max;
+  int num;
+  double batch[JLITE_AGG_BATCH];
+} jlite_agg_state_t;
+
+static void jlite_agg_init(jlite_agg_state_t *st, jlite_agg_t *agg)
+{
+  memset(agg, 0, sizeof(*agg));
+  agg->first_skipped = -1;
+  agg->exact = 1;
+  agg->min = HUGE_VAL;
+  agg->max = -HUGE_VAL;
+  st->agg = agg;
+  st->int_count = 0;
+  st->int_min = INT64_MAX;
+  st->int_max = INT64_MIN;
+  st->num = 0;
+}
+
+static void jlite_agg_flush(jlite_agg_state_t *st)
+{
+  jlite_agg_t *agg = st->agg;
+  int i = 0;
+
+#ifdef JLITE_SIMD_SSE2
+  __m128d sum = _mm_setzero_pd();
+  __m128d lo = _mm_set1_pd(agg->min);
+  __m128d hi = _mm_set1_pd(agg->max);
+  __m128d value;
+  double lanes[2];
+
+  for (; i + 2 <= st->num; i += 2)
+  {
+    value = _mm_loadu_pd(st->batch + i);
+    sum = _mm_add_pd(sum, value);
+    lo = _mm_min_pd(lo, value);
+    hi = _mm_max_pd(hi, value);
+  }
+  _mm_storeu_pd(lanes, sum);
+  agg->sum += lanes[0] + lanes[1];
+  _mm_storeu_pd(lanes, lo);
+  agg->min = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+  _mm_storeu_pd(lanes, hi);
+  agg->max = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+#endif
+
+  for (; i < st->num; i++)
+  {
+    agg->sum += st->batch[i];
+    if (st->batch[i] < agg->min)
+    {
+      agg->min = st->batch[i];
+    }
+    if (st->batch[i] > agg->max)
+    {
+      agg->max = st->batch[i];
+    }
+  }
+  st->num = 0;
+}
+
+static void jlite_agg_skip(jlite_agg_state_t *st, long index)
+{
+  if (!st->agg->skipped++)
+  {
+    st->agg->first_skipped = index;
+  }
+}
+
+#ifdef JLITE_SWAR_LITTLE_ENDIAN
+/*
+ * Integers of up to eight digits are read with one load ending at their
+ * last digit, the bytes before them replaced by '0'. The caller makes
+ * sure those eight bytes are inside the JSON string.
+ */
+static int jlite_agg_int_fast(const char *str, int len, int64_t *value)
+{
+  int negative = str[0] == '-';
+  int digits = len - negative;
+  uint64_t word = 0;
+  uint64_t keep = 0;
+
+  if (digits <= 0 || digits > 8)
+  {
+    return 0;
+  }
+  memcpy(&word, str + len - 8, sizeof(word));
+  keep = ~0ULL << (8 * (8 - digits));
+  word = (word & keep) | (0x3030303030303030ULL & ~keep);
+  if (!jlite_swar_is_8_digits(word))
+  {
+    return 0;
+  }
+  /* Negate without a branch, the sign is unpredictable in real data. */
+  *value = ((int64_t) jlite_swar_parse_8_digits(word) ^ -(int64_t) negative) +
+      negative;
+  return 1;
+}
+#endif
+
+static int jlite_agg_int(const char *str, int len, int end, int64_t *value)
+{
+#ifdef JLITE_SWAR_LITTLE_ENDIAN
+  if (end >= 8 && jlite_agg_int_fast(str, len, value))
+  {
+    return JLITE_OK;
+  }
+#else
+  (void) end;
+#endif
+  return jlite_number_to_int64(str, len, value);
+}
+
+static void jlite_agg_add(jlite_agg_state_t *st, const char *jsonstr,
+    const jlitetok_t *tok, long index)
+{
+  jlite_agg_t *agg = st->agg;
+  const char *str = jsonstr + tok->start;
+  int len = tok->end - tok->start;
+  int64_t value_int = 0;
+  int64_t sum_int = 0;
+  double value = 0;
+
+  if (tok->type != JSMN_PRIMITIVE || len <= 0 ||
+      (str[0] != '-' && (str[0] < '0' || str[0] > '9')))
+  {
+    jlite_agg_skip(st, index);
+    return;
+  }
+
+  /* Integers stay exact until the first fraction or overflow. */
+  agg->count++;
+  if (agg->exact &&
+      jlite_agg_int(str, len, tok->end, &value_int) == JLITE_OK)
+  {
+    if (!__builtin_add_overflow(agg->sum_int, value_int, &sum_int))
+    {
+      agg->sum_int = sum_int;
+      st->int_count++;
+      st->int_min = value_int < st->int_min ? value_int : st->int_min;
+      st->int_max = value_int > st->int_max ? value_int : st->int_max;
+      return;
+    }
+    agg->exact = 0;
+    value = (double) value_int;
+  }
+  else if (jlite_number_to_double(str, len, &value) == JLITE_OK)
+  {
+    agg->exact = 0;
+  }
+  else
+  {
+    agg->count--;
+    jlite_agg_skip(st, index);
+    return;
+  }
+
+  st->batch[st->num++] = value;
+  if (st->num == JLITE_AGG_BATCH)
+  {
+    jlite_agg_flush(st);
+  }
+}
+
+/*
+ * Kernel for a leading run of short integers, the common case of numeric
+ * arrays, with all state in locals. Eight digit values cannot overflow
+ * sum_int within an int-sized array, so it needs no overflow check. Returns
+ * the number of elements taken, the caller continues from there.
+ */
+static int jlite_agg_int_kernel(jlite_agg_state_t *st, const char *jsonstr,
+    const jlitetok_t *tokens, int size)
+{
+#ifdef JLITE_SWAR_LITTLE_ENDIAN
+  int64_t sum = 0;
+  int64_t lo = INT64_MAX;
+  int64_t hi = INT64_MIN;
+  int64_t value = 0;
+  int i = 0;
+
+  for (i = 0; i < size; i++)
+  {
+    if (tokens[i].type != JSMN_PRIMITIVE || tokens[i].end < 8 ||
+        !jlite_agg_int_fast(jsonstr + tokens[i].start,
+        tokens[i].end - tokens[i].start, &value))
+    {
+      break;
+    }
+    sum += value;
+    lo = value < lo ? value : lo;
+    hi = value > hi ? value : hi;
+  }
+
+  st->agg->sum_int = sum;
+  st->agg->count = i;
+  st->int_count = i;
+  st->int_min = lo;
+  st->int_max = hi;
+  return i;
+#else
+  (void) st;
+  (void) jsonstr;
+  (void) tokens;
+  (void) size;
+  return 0;
+#endif
+}
+
+static void jlite_agg_finish(jlite_agg_state_t *st)
+{
+  jlite_agg_t *agg = st->agg;
+
+  jlite_agg_flush(st);
+  if (st->int_count)
+  {
+    agg->sum += (double) agg->sum_int;
+    agg->min = (double) st->int_min < agg->min ? (double) st->int_min :
+        agg->min;
+    agg->max = (double) st->int_max > agg->max ? (double) st->int_max :
+        agg->max;
+  }
+  if (agg->count)
+  {
+    agg->mean = agg->sum / (double) agg->count;
+  }
+  else
+  {
+    agg->min = 0;
+    agg->max = 0;
+    agg->exact = 0;
+  }
+}
+
+int jlite_aggregate_array(jliteobj_t *jsonobj, jlite_agg_t *agg)
+{
+  if (!jsonobj || !jsonobj->tokens || !agg)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  jlite_agg_state_t st;
+  int pos = jsonobj->cur_pos - 1;
+  int size = 0;
+  int i = 0;
+
+  if (tokens[pos].type != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  jlite_agg_init(&st, agg);
+  size = tokens[pos].size;
+  pos++;
+  i = jlite_agg_int_kernel(&st, jsonobj->jsonstr, &tokens[pos], size);
+  pos += i;
+  for (; i < size; i++)
+  {
+    if (tokens[pos].type == JSMN_PRIMITIVE)
+    {
+      jlite_agg_add(&st, jsonobj->jsonstr, &tokens[pos], i);
+      pos++;
+    }
+    else
+    {
+      jlite_agg_skip(&st, i);
+      pos = (int) jlite_next_sibling(tokens, pos);
+    }
+  }
+  jlite_agg_finish(&st);
+
+  return JLITE_OK;
+}
+
+int jlite_aggregate_field(jliteobj_t *jsonobj, const char *field,
+    jlite_agg_t *agg)
+{
+  if (!jsonobj || !jsonobj->tokens || !field || !agg)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  const char *jsonstr = jsonobj->jsonstr;
+  int field_len = (int) strlen(field);
+  jlite_agg_state_t st;
+  int pos = jsonobj->cur_pos - 1;
+  int members = 0;
+  int value = 0;
+  int size = 0;
+  int i = 0;
+
+  if (tokens[pos].type != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  jlite_agg_init(&st, agg);
+  size = tokens[pos].size;
+  pos++;
+  for (i = 0; i < size; i++)
+  {
+    if (tokens[pos].type != JSMN_OBJECT)
+    {
+      jlite_agg_skip(&st, i);
+      pos = (int) jlite_next_sibling(tokens, pos);
+      continue;
+    }
+
+    /* Walk the members once; the element ends after the last one. */
+    members = tokens[pos].size;
+    value = -1;
+    pos++;
+    while (members--)
+    {
+      if (value < 0 && tokens[pos].end - tokens[pos].start == field_len &&
+          !memcmp(jsonstr + tokens[pos].start, field, (size_t) field_len))
+      {
+        value = pos + 1;
+      }
+      pos = (int) jlite_next_sibling(tokens, pos);
+    }
+
+    if (value < 0)
+    {
+      jlite_agg_skip(&st, i);
+    }
+    else
+    {
+      jlite_agg_add(&st, jsonstr, &tokens[value], i);
+    }
+  }
+  jlite_agg_finish(&st);
+
+  return JLITE_OK;
+}
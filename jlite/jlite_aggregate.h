@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_aggregate.h
+ * @brief One-pass numeric aggregates over arrays and record fields.
+ *
+ */
+
+#ifndef _JLITE_AGGREGATE_H
+#define _JLITE_AGGREGATE_H
+
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Aggregates of the numbers of an array or of a record field.
+ *
+ */
+
+typedef struct
+{
+  long count;          /* Numbers aggregated. */
+  long skipped;        /* Elements without a number: other types, null, or
+                          records without the field. */
+  long first_skipped;  /* Index of the first skipped element, -1 if none. */
+  int exact;           /* Non-zero if every number was an integer and
+                          sum_int did not overflow. */
+  int64_t sum_int;     /* Exact sum, valid if exact. */
+  double sum;
+  double min;
+  double max;
+  double mean;         /* sum / count, 0 without numbers. */
+} jlite_agg_t;
+
+/**
+ * @brief Aggregate the number elements of already held JSON array.
+ *
+ * All elements are visited in one pass over the tokens and decoded
+ * straight from the JSON text, integers exactly into sum_int as long as
+ * possible. Elements which are not numbers are counted in skipped.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param agg Pointer to aggregates to fill.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_aggregate_array(jliteobj_t *jsonobj, jlite_agg_t *agg);
+
+/**
+ * @brief Aggregate one field of the object elements of already held JSON
+ * array.
+ *
+ * For an array such as "orders", aggregates the "price" member of every
+ * element in one pass, comparing each member key once. Elements which are
+ * not objects, lack the field or hold a non-number in it are counted in
+ * skipped.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param field Key of the member to aggregate.
+ * @param agg Pointer to aggregates to fill.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_aggregate_field(jliteobj_t *jsonobj, const char *field,
+    jlite_agg_t *agg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_AGGREGATE_H */
@@ -0,0 +1,335 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_bind.hpp
+ * @brief Compile-time struct binding for the C++ interface.
+ *
+ * A field mapping is declared once, at global scope, after the struct:
+ *
+ *   struct point { int x; int y; };
+ *   struct shape { std::string name; std::vector<point> points;
+ *                  std::optional<double> scale; };
+ *   JLITE_BIND(point, x, y)
+ *   JLITE_BIND(shape, name, points, scale)
+ *
+ *   shape s;
+ *   ret = jlite::decode(doc.root(), s);
+ *
+ * Decoding walks each object once. Every member key is hashed together with
+ * its length and dispatched through a switch whose case labels are the
+ * constexpr hashes of the field names, so a colliding pair of field names
+ * is a compile error rather than a silent mismatch.
+ *
+ * On a document interned with jlite_intern_document() the field names are
+ * resolved to key IDs once per dictionary and thread, and members are
+ * matched by comparing IDs.
+ *
+ * Bind nested structs before the structs that contain them.
+ *
+ * Members absent from the JSON keep their current value and unknown keys
+ * are ignored. Keys are matched against the raw JSON text, so escaped keys
+ * do not match. std::string receives the raw (still escaped) string.
+ *
+ */
+
+#ifndef _JLITE_BIND_HPP
+#define _JLITE_BIND_HPP
+
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <vector>
+#include "jlite.hpp"
+
+namespace jlite
+{
+
+/* Specialized by JLITE_BIND for each bound struct. */
+template <class T>
+struct binding;
+
+namespace detail
+{
+
+/* FNV-1a with the key length folded into the top byte. */
+constexpr uint32_t key_hash(const char *key, std::size_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  for (std::size_t i = 0; i < len; i++)
+  {
+    hash = (hash ^ static_cast<unsigned char>(key[i])) * 16777619u;
+  }
+  return (hash & 0x00ffffffu) ^ (static_cast<uint32_t>(len) << 24);
+}
+
+/* Key IDs of the fields of T in a dictionary, cached per thread. */
+template <class T>
+const jlite_key_id_t *field_ids(jlite_intern_t *intern)
+{
+  constexpr std::size_t num_fields = std::size(binding<T>::names);
+  thread_local struct
+  {
+    unsigned long serial;
+    int num_keys;
+    jlite_key_id_t ids[num_fields];
+  } cache = {};
+
+  /* A key added since may be one of the fields. */
+  if (cache.serial != intern->serial || cache.num_keys != intern->num_keys)
+  {
+    for (std::size_t i = 0; i < num_fields; i++)
+    {
+      cache.ids[i] = jlite_intern_find(intern, binding<T>::names[i],
+          std::strlen(binding<T>::names[i]));
+    }
+    cache.serial = intern->serial;
+    cache.num_keys = intern->num_keys;
+  }
+  return cache.ids;
+}
+
+template <class T, class Enable = void>
+struct is_bound : std::false_type {};
+
+template <class T>
+struct is_bound<T, decltype(void(sizeof(binding<T>)))> : std::true_type {};
+
+} /* namespace detail */
+
+template <class T>
+int decode(const value &v, T &out);
+
+template <class T>
+int decode(const value &v, std::optional<T> &out)
+{
+  if (!v.valid() || v.is_null())
+  {
+    out.reset();
+    return JLITE_OK;
+  }
+  if (!out)
+  {
+    out.emplace();
+  }
+  return decode(v, *out);
+}
+
+template <class T>
+int decode(const value &v, std::vector<T> &out)
+{
+  int ret = 0;
+
+  if (!v.is_array())
+  {
+    return v.valid() ? -JLITE_E_NOT_ARRAY : -JLITE_E_KEY_NOT_FOUND;
+  }
+
+  out.clear();
+  out.resize(static_cast<std::size_t>(v.size()));
+  std::size_t i = 0;
+  for (value element : v)
+  {
+    ret = decode(element, out[i++]);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  return JLITE_OK;
+}
+
+inline int decode(const value &v, std::string &out)
+{
+  result<std::string_view> str = v.get<std::string_view>();
+
+  if (!str)
+  {
+    return str.error();
+  }
+  out.assign(str.value().data(), str.value().size());
+  return JLITE_OK;
+}
+
+/**
+ * @brief Decode a value into a bound struct, a primitive supported by
+ * value::get<T>(), or one of the containers above.
+ *
+ * @return errcode
+ */
+template <class T>
+int decode(const value &v, T &out)
+{
+  if constexpr (detail::is_bound<T>::value)
+  {
+    int ret = 0;
+
+    if (!v.is_object())
+    {
+      return v.valid() ? -JLITE_E_NOT_OBJECT : -JLITE_E_KEY_NOT_FOUND;
+    }
+    const jliteobj_t *doc = v.object();
+    if (doc->key_ids)
+    {
+      const jlite_key_id_t *ids = detail::field_ids<T>(doc->intern);
+
+      for (const member &m : v.members())
+      {
+        ret = binding<T>::decode_member_id(m.key_id(), ids, m.value(), out);
+        if (ret != JLITE_OK)
+        {
+          return ret;
+        }
+      }
+      return JLITE_OK;
+    }
+    for (const member &m : v.members())
+    {
+      ret = binding<T>::decode_member(m.key(), m.value(), out);
+      if (ret != JLITE_OK)
+      {
+        return ret;
+      }
+    }
+    return JLITE_OK;
+  }
+  else
+  {
+    result<T> res = v.get<T>();
+
+    if (!res)
+    {
+      return res.error();
+    }
+    out = *res;
+    return JLITE_OK;
+  }
+}
+
+template <class T>
+int decode(const document &doc, T &out)
+{
+  return decode(doc.root(), out);
+}
+
+} /* namespace jlite */
+
+#define JLITE_PP_CAT(a, b) JLITE_PP_CAT_(a, b)
+#define JLITE_PP_CAT_(a, b) a##b
+#define JLITE_PP_NARG(...) \
+  JLITE_PP_NARG_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, \
+  20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define JLITE_PP_NARG_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+  _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, \
+  _28, _29, _30, _31, _32, N, ...) N
+/* Apply m to each of up to 32 arguments. */
+#define JLITE_PP_FOREACH(m, ...) \
+  JLITE_PP_CAT(JLITE_PP_FOREACH_, JLITE_PP_NARG(__VA_ARGS__))(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_1(m, a) m(a)
+#define JLITE_PP_FOREACH_2(m, a, ...) m(a) JLITE_PP_FOREACH_1(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_3(m, a, ...) m(a) JLITE_PP_FOREACH_2(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_4(m, a, ...) m(a) JLITE_PP_FOREACH_3(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_5(m, a, ...) m(a) JLITE_PP_FOREACH_4(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_6(m, a, ...) m(a) JLITE_PP_FOREACH_5(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_7(m, a, ...) m(a) JLITE_PP_FOREACH_6(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_8(m, a, ...) m(a) JLITE_PP_FOREACH_7(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_9(m, a, ...) m(a) JLITE_PP_FOREACH_8(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_10(m, a, ...) m(a) JLITE_PP_FOREACH_9(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_11(m, a, ...) m(a) JLITE_PP_FOREACH_10(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_12(m, a, ...) m(a) JLITE_PP_FOREACH_11(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_13(m, a, ...) m(a) JLITE_PP_FOREACH_12(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_14(m, a, ...) m(a) JLITE_PP_FOREACH_13(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_15(m, a, ...) m(a) JLITE_PP_FOREACH_14(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_16(m, a, ...) m(a) JLITE_PP_FOREACH_15(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_17(m, a, ...) m(a) JLITE_PP_FOREACH_16(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_18(m, a, ...) m(a) JLITE_PP_FOREACH_17(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_19(m, a, ...) m(a) JLITE_PP_FOREACH_18(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_20(m, a, ...) m(a) JLITE_PP_FOREACH_19(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_21(m, a, ...) m(a) JLITE_PP_FOREACH_20(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_22(m, a, ...) m(a) JLITE_PP_FOREACH_21(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_23(m, a, ...) m(a) JLITE_PP_FOREACH_22(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_24(m, a, ...) m(a) JLITE_PP_FOREACH_23(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_25(m, a, ...) m(a) JLITE_PP_FOREACH_24(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_26(m, a, ...) m(a) JLITE_PP_FOREACH_25(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_27(m, a, ...) m(a) JLITE_PP_FOREACH_26(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_28(m, a, ...) m(a) JLITE_PP_FOREACH_27(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_29(m, a, ...) m(a) JLITE_PP_FOREACH_28(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_30(m, a, ...) m(a) JLITE_PP_FOREACH_29(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_31(m, a, ...) m(a) JLITE_PP_FOREACH_30(m, __VA_ARGS__)
+#define JLITE_PP_FOREACH_32(m, a, ...) m(a) JLITE_PP_FOREACH_31(m, __VA_ARGS__)
+
+#define JLITE_BIND_CASE(field) \
+  case ::jlite::detail::key_hash(#field, sizeof(#field) - 1): \
+    if (key == #field) \
+    { \
+      return ::jlite::decode(v, out.field); \
+    } \
+    break;
+
+#define JLITE_BIND_ID_CASE(field) \
+  if (id == ids[n++]) \
+  { \
+    return ::jlite::decode(v, out.field); \
+  }
+
+#define JLITE_BIND_NAME(field) #field,
+
+/**
+ * @brief Bind up to 32 members of a struct to JSON keys of the same name.
+ * Use at global scope.
+ */
+#define JLITE_BIND(type, ...) \
+  namespace jlite \
+  { \
+  template <> \
+  struct binding<type> \
+  { \
+    static constexpr const char *names[] = \
+    { \
+      JLITE_PP_FOREACH(JLITE_BIND_NAME, __VA_ARGS__) \
+    }; \
+    static int decode_member(std::string_view key, const value &v, \
+        type &out) \
+    { \
+      switch (detail::key_hash(key.data(), key.size())) \
+      { \
+        JLITE_PP_FOREACH(JLITE_BIND_CASE, __VA_ARGS__) \
+        default: \
+          break; \
+      } \
+      return JLITE_OK; \
+    } \
+    static int decode_member_id(jlite_key_id_t id, \
+        const jlite_key_id_t *ids, const value &v, type &out) \
+    { \
+      std::size_t n = 0; \
+      JLITE_PP_FOREACH(JLITE_BIND_ID_CASE, __VA_ARGS__) \
+      return JLITE_OK; \
+    } \
+  }; \
+  }
+
+#endif /* _JLITE_BIND_HPP */
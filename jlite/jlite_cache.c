@@ -0,0 +1,322 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_cache.c
+ * @brief This file contains the parse cache API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_cache.h"
+
+#if JLITE_CACHE_THREADS
+#define JLITE_CACHE_LOCK(cache) pthread_mutex_lock(&(cache)->lock)
+#define JLITE_CACHE_UNLOCK(cache) pthread_mutex_unlock(&(cache)->lock)
+#else
+#define JLITE_CACHE_LOCK(cache) ((void) 0)
+#define JLITE_CACHE_UNLOCK(cache) ((void) 0)
+#endif
+
+/*
+ * Slots are grouped into sets of JLITE_CACHE_WAYS; a document can only live
+ * in the set picked by its hash, so lookup and eviction scan one set.
+ */
+#ifndef JLITE_CACHE_WAYS
+#define JLITE_CACHE_WAYS 8
+#endif
+
+#define JLITE_CACHE_ALIGN(n) (((n) + 7) & ~(size_t) 7)
+
+/*
+ * A slot holds the tokens at its start and the copy of the document at its
+ * end, so the token capacity is whatever the document leaves.
+ */
+static char *jlite_cache_slot_json(const jlite_cache_t *cache,
+    const jlite_cache_slot_t *slot)
+{
+  return slot->data + cache->slot_size - (size_t) slot->len;
+}
+
+static size_t jlite_cache_slot_bytes(const jlite_cache_slot_t *slot)
+{
+  return (size_t) slot->len + (size_t) slot->num_tokens * sizeof(jlitetok_t);
+}
+
+/* Non-zero if slot a is a better eviction victim than slot b. */
+static int jlite_cache_older(const jlite_cache_slot_t *a,
+    const jlite_cache_slot_t *b)
+{
+  if (!a->valid || !b->valid)
+  {
+    return !a->valid && b->valid;
+  }
+  return a->last_use < b->last_use;
+}
+
+static void jlite_cache_attach(jlite_cache_t *cache, jlite_cache_slot_t *slot,
+    jliteobj_t *jsonobj)
+{
+  memset(jsonobj, 0, sizeof(*jsonobj));
+  jsonobj->jsonstr = jlite_cache_slot_json(cache, slot);
+  jsonobj->jsonstr_len = slot->len;
+  jsonobj->j_parser.pos = (unsigned int) slot->len;
+  jsonobj->j_parser.toknext = (unsigned int) slot->num_tokens;
+  jsonobj->j_parser.toksuper = -1;
+  jsonobj->tokens = (jlitetok_t *) slot->data;
+  jsonobj->num_tokens = slot->num_tokens;
+  jsonobj->cur_pos = 1;
+}
+
+int jlite_cache_init(jlite_cache_t *cache, void *arena, size_t arena_size,
+    int num_slots)
+{
+  if (!cache || !arena || num_slots <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  char *base = (char *) JLITE_CACHE_ALIGN((uintptr_t) arena);
+  size_t header = JLITE_CACHE_ALIGN((size_t) num_slots *
+      sizeof(jlite_cache_slot_t));
+  size_t skew = (size_t) (base - (char *) arena);
+  int i = 0;
+
+  if (arena_size < skew + header)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  memset(cache, 0, sizeof(*cache));
+  cache->slot_size = (arena_size - skew - header) / (size_t) num_slots &
+      ~(size_t) 7;
+  if (cache->slot_size < sizeof(jlitetok_t) + 1)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  cache->slots = (jlite_cache_slot_t *) base;
+  cache->num_slots = num_slots;
+  for (i = 0; i < num_slots; i++)
+  {
+    memset(&cache->slots[i], 0, sizeof(cache->slots[i]));
+    cache->slots[i].data = base + header + (size_t) i * cache->slot_size;
+  }
+
+#if JLITE_CACHE_THREADS
+  if (pthread_mutex_init(&cache->lock, NULL))
+  {
+    return -JLITE_ERR;
+  }
+#endif
+
+  return JLITE_OK;
+}
+
+void jlite_cache_destroy(jlite_cache_t *cache)
+{
+  if (!cache || !cache->slots)
+  {
+    return;
+  }
+
+#if JLITE_CACHE_THREADS
+  pthread_mutex_destroy(&cache->lock);
+#endif
+  memset(cache, 0, sizeof(*cache));
+}
+
+int jlite_cache_parse(jlite_cache_t *cache, jliteobj_t *jsonobj,
+    const char *jsonstr, int jsonstr_len)
+{
+  if (!cache || !cache->slots || !jsonobj || !jsonstr || jsonstr_len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_hash_t hash = jlite_hash_bytes(jsonstr, (size_t) jsonstr_len, 0);
+  jlite_cache_slot_t *slot = NULL;
+  char *copy = NULL;
+  int num_sets = (cache->num_slots + JLITE_CACHE_WAYS - 1) / JLITE_CACHE_WAYS;
+  int first = (int) (hash.lo % (uint64_t) num_sets) * JLITE_CACHE_WAYS;
+  int last = first + JLITE_CACHE_WAYS;
+  int lookup = 1;
+  int found = -1;
+  int victim = -1;
+  int ret = 0;
+  int i = 0;
+
+  if (last > cache->num_slots)
+  {
+    last = cache->num_slots;
+  }
+
+  if ((size_t) jsonstr_len + sizeof(jlitetok_t) > cache->slot_size)
+  {
+    JLITE_CACHE_LOCK(cache);
+    cache->stats.too_large++;
+    JLITE_CACHE_UNLOCK(cache);
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+again:
+  JLITE_CACHE_LOCK(cache);
+  cache->clock++;
+  found = -1;
+  victim = -1;
+  for (i = first; i < last; i++)
+  {
+    slot = &cache->slots[i];
+    if (lookup && slot->valid && slot->len == jsonstr_len &&
+        slot->hash.lo == hash.lo && slot->hash.hi == hash.hi)
+    {
+      found = i;
+      break;
+    }
+    if (!slot->refs &&
+        (victim < 0 || jlite_cache_older(slot, &cache->slots[victim])))
+    {
+      victim = i;
+    }
+  }
+
+  if (found >= 0)
+  {
+    /* Pin, then verify the bytes without holding the lock. */
+    slot = &cache->slots[found];
+    slot->refs++;
+    slot->last_use = cache->clock;
+    cache->stats.hits++;
+    JLITE_CACHE_UNLOCK(cache);
+
+    if (!memcmp(jlite_cache_slot_json(cache, slot), jsonstr,
+        (size_t) jsonstr_len))
+    {
+      jlite_cache_attach(cache, slot, jsonobj);
+      return JLITE_OK;
+    }
+
+    JLITE_CACHE_LOCK(cache);
+    slot->refs--;
+    cache->stats.hits--;
+    cache->stats.collisions++;
+    JLITE_CACHE_UNLOCK(cache);
+    lookup = 0;
+    goto again;
+  }
+
+  if (victim < 0)
+  {
+    cache->stats.all_pinned++;
+    JLITE_CACHE_UNLOCK(cache);
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  slot = &cache->slots[victim];
+  if (slot->valid)
+  {
+    cache->stats.evictions++;
+    cache->stats.bytes_used -= jlite_cache_slot_bytes(slot);
+  }
+  slot->valid = 0;
+  slot->refs = 1;
+  slot->len = jsonstr_len;
+  cache->stats.misses++;
+  JLITE_CACHE_UNLOCK(cache);
+
+  /* The slot is pinned and invalid, so it can be filled unlocked. */
+  copy = jlite_cache_slot_json(cache, slot);
+  memcpy(copy, jsonstr, (size_t) jsonstr_len);
+  ret = jlite_parse_init(jsonobj, (jlitetok_t *) slot->data,
+      (int) ((cache->slot_size - (size_t) jsonstr_len) / sizeof(jlitetok_t)),
+      copy, jsonstr_len);
+
+  JLITE_CACHE_LOCK(cache);
+  if (ret != JLITE_OK)
+  {
+    slot->refs = 0;
+    cache->stats.parse_errors++;
+    JLITE_CACHE_UNLOCK(cache);
+    return ret;
+  }
+  slot->hash = hash;
+  slot->num_tokens = jsonobj->num_tokens;
+  slot->last_use = cache->clock;
+  slot->valid = 1;
+  cache->stats.bytes_used += jlite_cache_slot_bytes(slot);
+  JLITE_CACHE_UNLOCK(cache);
+
+  return JLITE_OK;
+}
+
+int jlite_cache_release(jlite_cache_t *cache, jliteobj_t *jsonobj)
+{
+  if (!cache || !cache->slots || !jsonobj || !jsonobj->tokens)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  char *data = (char *) jsonobj->tokens;
+  size_t offset = 0;
+  int ret = JLITE_OK;
+
+  if (data < cache->slots[0].data)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  offset = (size_t) (data - cache->slots[0].data);
+  if (offset % cache->slot_size ||
+      offset / cache->slot_size >= (size_t) cache->num_slots)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  JLITE_CACHE_LOCK(cache);
+  if (cache->slots[offset / cache->slot_size].refs > 0)
+  {
+    cache->slots[offset / cache->slot_size].refs--;
+  }
+  else
+  {
+    ret = -JLITE_E_INVALID_PARAM;
+  }
+  JLITE_CACHE_UNLOCK(cache);
+
+  jsonobj->tokens = NULL;
+  jsonobj->num_tokens = 0;
+  return ret;
+}
+
+int jlite_cache_get_stats(jlite_cache_t *cache, jlite_cache_stats_t *stats)
+{
+  if (!cache || !stats)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  JLITE_CACHE_LOCK(cache);
+  *stats = cache->stats;
+  JLITE_CACHE_UNLOCK(cache);
+  return JLITE_OK;
+}
@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_cache.h
+ * @brief Whole-document parse cache keyed by content hash.
+ *
+ */
+
+#ifndef _JLITE_CACHE_H
+#define _JLITE_CACHE_H
+
+#include <stddef.h>
+#include "jlite.h"
+#include "jlite_hash.h"
+
+/*
+ * Set JLITE_CACHE_THREADS to 0 to build the cache without locking, e.g.
+ * on targets without pthreads. The cache is then for a single thread.
+ */
+#ifndef JLITE_CACHE_THREADS
+#define JLITE_CACHE_THREADS 1
+#endif
+
+#if JLITE_CACHE_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parse cache counters.
+ *
+ */
+
+typedef struct
+{
+  unsigned long hits;          /* Lookups served from the cache. */
+  unsigned long misses;        /* Lookups which parsed the document. */
+  unsigned long evictions;     /* Cached documents replaced. */
+  unsigned long collisions;    /* Hash and length matched, bytes did not. */
+  unsigned long too_large;     /* Documents which do not fit a slot. */
+  unsigned long all_pinned;    /* Misses with every slot of the set in use. */
+  unsigned long parse_errors;  /* Misses which failed to parse. */
+  size_t bytes_used;           /* Bytes held by cached documents. */
+} jlite_cache_stats_t;
+
+/**
+ * @brief One cached document, private to the cache.
+ *
+ */
+
+typedef struct
+{
+  jlite_hash_t hash;
+  int len;
+  int num_tokens;
+  int refs;
+  int valid;
+  unsigned long last_use;
+  char *data;
+} jlite_cache_slot_t;
+
+/**
+ * @brief Parse cache over a caller-provided memory budget.
+ *
+ */
+
+typedef struct
+{
+  jlite_cache_slot_t *slots;
+  int num_slots;
+  size_t slot_size;
+  unsigned long clock;
+  jlite_cache_stats_t stats;
+#if JLITE_CACHE_THREADS
+  pthread_mutex_t lock;
+#endif
+} jlite_cache_t;
+
+/**
+ * @brief Initialize a parse cache.
+ *
+ * The cache allocates nothing: the arena is split into num_slots equal
+ * slots, each holding one document and its tokens, so the arena size is
+ * the memory budget and the slot size bounds the cacheable document.
+ *
+ * @param cache Pointer to cache.
+ * @param arena Memory used by the cache, owned by the caller until
+ * jlite_cache_destroy().
+ * @param arena_size Size of arena.
+ * @param num_slots Number of documents the cache holds.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if the arena is too small.
+ *
+ */
+
+int jlite_cache_init(jlite_cache_t *cache, void *arena, size_t arena_size,
+    int num_slots);
+
+/**
+ * @brief Release a parse cache.
+ *
+ * No document of the cache may be in use.
+ *
+ * @param cache Pointer to cache.
+ *
+ */
+
+void jlite_cache_destroy(jlite_cache_t *cache);
+
+/**
+ * @brief Get a parsed JSON object for a string, from the cache if possible.
+ *
+ * The string is hashed with jlite_hash_bytes() and, on a hash and length
+ * match, compared byte for byte with the cached copy. On a miss it is
+ * copied into the least recently used free slot of the set selected by
+ * the hash and parsed there. Either
+ * way jsonobj refers to the cached copy and tokens, which stay pinned
+ * until jlite_cache_release(); jsonobj itself belongs to the caller, so
+ * any number of threads can read the same cached document.
+ *
+ * @param cache Pointer to cache.
+ * @param jsonobj Pointer to JSON object to initialize.
+ * @param jsonstr Pointer to JSON string.
+ * @param jsonstr_len Length of JSON string.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if the document does not fit a
+ * slot or every slot of its set is pinned; parse the string with jlite_parse_init()
+ * into caller tokens then.
+ *
+ */
+
+int jlite_cache_parse(jlite_cache_t *cache, jliteobj_t *jsonobj,
+    const char *jsonstr, int jsonstr_len);
+
+/**
+ * @brief Unpin a document obtained with jlite_cache_parse().
+ *
+ * @param cache Pointer to cache.
+ * @param jsonobj Pointer to JSON object, unusable afterwards.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_cache_release(jlite_cache_t *cache, jliteobj_t *jsonobj);
+
+/**
+ * @brief Get a snapshot of the cache counters.
+ *
+ * @param cache Pointer to cache.
+ * @param stats Pointer to stats structure to fill.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_cache_get_stats(jlite_cache_t *cache, jlite_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_CACHE_H */
@@ -0,0 +1,289 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_columns.c
+ * @brief This file contains the columnar extraction API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_columns.h"
+
+/* Column of the key token, -1 if none. */
+static int jlite_columns_match(const jlite_column_t *columns,
+    const int *key_len, int num_columns, const char *key, int len)
+{
+  int c = 0;
+
+  for (c = 0; c < num_columns; c++)
+  {
+    if (key_len[c] == len && !memcmp(columns[c].key, key, (size_t) len))
+    {
+      return c;
+    }
+  }
+  return -1;
+}
+
+/*
+ * Store the value token of row in the column. Returns 1 if stored, 0 if
+ * the row is null, or an errcode.
+ */
+static int jlite_columns_put(jlite_column_t *col, const char *jsonstr,
+    const jlitetok_t *tok, int row)
+{
+  const char *str = jsonstr + tok->start;
+  int len = tok->end - tok->start;
+  jsmnkind_t kind = JSMN_KIND_NONE;
+
+  if (tok->type == JSMN_PRIMITIVE)
+  {
+    kind = (jsmnkind_t) tok->kind;
+    if (kind == JSMN_KIND_NONE)
+    {
+      kind = jsmn_primitive_kind(str, (size_t) len);
+    }
+  }
+  if (kind == JSMN_KIND_NULL)
+  {
+    return 0;
+  }
+
+  switch (col->type)
+  {
+    case JLITE_COLUMN_INT64:
+      if (kind == JSMN_KIND_INT && jlite_number_to_int64(str, len,
+          &((int64_t *) col->values)[row]) == JLITE_OK)
+      {
+        return 1;
+      }
+      break;
+    case JLITE_COLUMN_DOUBLE:
+      if ((kind == JSMN_KIND_INT || kind == JSMN_KIND_FLOAT) &&
+          jlite_number_to_double(str, len,
+          &((double *) col->values)[row]) == JLITE_OK)
+      {
+        return 1;
+      }
+      break;
+    case JLITE_COLUMN_BOOL:
+      if (kind == JSMN_KIND_TRUE || kind == JSMN_KIND_FALSE)
+      {
+        if (kind == JSMN_KIND_TRUE)
+        {
+          ((uint8_t *) col->values)[row >> 3] |= (uint8_t) (1u << (row & 7));
+        }
+        return 1;
+      }
+      break;
+    default:
+      if (tok->type == JSMN_STRING)
+      {
+        if (len > col->data_size - col->data_len)
+        {
+          return -JLITE_E_NO_BUFFER_MEM;
+        }
+        memcpy(col->data + col->data_len, str, (size_t) len);
+        col->data_len += len;
+        return 1;
+      }
+      break;
+  }
+  col->mismatched++;
+  return 0;
+}
+
+/*
+ * Close row in every column: string offsets advance, numeric slots of null
+ * rows are zeroed so the buffers are deterministic.
+ */
+static void jlite_columns_end_row(jlite_column_t *columns, int num_columns,
+    uint64_t valid, int row)
+{
+  int c = 0;
+
+  for (c = 0; c < num_columns; c++)
+  {
+    switch (columns[c].type)
+    {
+      case JLITE_COLUMN_STRING:
+        ((int32_t *) columns[c].values)[row + 1] = columns[c].data_len;
+        break;
+      case JLITE_COLUMN_INT64:
+        if (!(valid & (1ULL << c)))
+        {
+          ((int64_t *) columns[c].values)[row] = 0;
+        }
+        break;
+      case JLITE_COLUMN_DOUBLE:
+        if (!(valid & (1ULL << c)))
+        {
+          ((double *) columns[c].values)[row] = 0;
+        }
+        break;
+      default:
+        break;
+    }
+    if (valid & (1ULL << c))
+    {
+      columns[c].validity[row >> 3] |= (uint8_t) (1u << (row & 7));
+      columns[c].null_count--;
+    }
+  }
+}
+
+/* Drop the partial row when a string column runs out of data. */
+static void jlite_columns_truncate(jlite_column_t *columns, int num_columns,
+    int size, int row)
+{
+  int c = 0;
+
+  for (c = 0; c < num_columns; c++)
+  {
+    columns[c].null_count -= size - row;
+    if (columns[c].type == JLITE_COLUMN_STRING)
+    {
+      columns[c].data_len = ((int32_t *) columns[c].values)[row];
+    }
+  }
+}
+
+int jlite_extract_columns(jliteobj_t *jsonobj, jlite_column_t *columns,
+    int num_columns, int max_rows, int *num_rows)
+{
+  if (!jsonobj || !jsonobj->tokens || !columns || num_columns <= 0 ||
+      num_columns > JLITE_COLUMNS_MAX || max_rows < 0 || !num_rows)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  const char *jsonstr = jsonobj->jsonstr;
+  int key_len[JLITE_COLUMNS_MAX];
+  signed char predict[JLITE_COLUMNS_MAX_MEMBERS];
+  size_t bitmap_len = 0;
+  uint64_t seen = 0;
+  uint64_t valid = 0;
+  int pos = jsonobj->cur_pos - 1;
+  int members = 0;
+  int size = 0;
+  int row = 0;
+  int len = 0;
+  int ret = 0;
+  int m = 0;
+  int c = 0;
+
+  for (c = 0; c < num_columns; c++)
+  {
+    if (!columns[c].key || !columns[c].validity || !columns[c].values ||
+        (columns[c].type == JLITE_COLUMN_STRING && !columns[c].data &&
+        columns[c].data_size))
+    {
+      return -JLITE_E_INVALID_PARAM;
+    }
+  }
+
+  if (tokens[pos].type != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  size = tokens[pos].size;
+  if (size > max_rows)
+  {
+    *num_rows = size;
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  /* Every row starts null, null_count is decremented for valid ones. */
+  bitmap_len = ((size_t) size + 7) / 8;
+  for (c = 0; c < num_columns; c++)
+  {
+    key_len[c] = (int) strlen(columns[c].key);
+    memset(columns[c].validity, 0, bitmap_len);
+    if (columns[c].type == JLITE_COLUMN_BOOL)
+    {
+      memset(columns[c].values, 0, bitmap_len);
+    }
+    else if (columns[c].type == JLITE_COLUMN_STRING)
+    {
+      ((int32_t *) columns[c].values)[0] = 0;
+    }
+    columns[c].data_len = 0;
+    columns[c].null_count = size;
+    columns[c].mismatched = 0;
+  }
+  memset(predict, -1, sizeof(predict));
+
+  pos++;
+  for (row = 0; row < size; row++)
+  {
+    if (tokens[pos].type != JSMN_OBJECT)
+    {
+      pos = (int) jlite_next_sibling(tokens, pos);
+      jlite_columns_end_row(columns, num_columns, 0, row);
+      continue;
+    }
+
+    members = tokens[pos].size;
+    seen = 0;
+    valid = 0;
+    pos++;
+    for (m = 0; m < members; m++)
+    {
+      /* Records of one schema keep their member order. */
+      len = tokens[pos].end - tokens[pos].start;
+      c = m < JLITE_COLUMNS_MAX_MEMBERS ? predict[m] : -1;
+      if (c < 0 || key_len[c] != len ||
+          memcmp(columns[c].key, jsonstr + tokens[pos].start, (size_t) len))
+      {
+        c = jlite_columns_match(columns, key_len, num_columns,
+            jsonstr + tokens[pos].start, len);
+        if (m < JLITE_COLUMNS_MAX_MEMBERS)
+        {
+          predict[m] = (signed char) c;
+        }
+      }
+
+      if (c >= 0 && !(seen & (1ULL << c)))
+      {
+        seen |= 1ULL << c;
+        ret = jlite_columns_put(&columns[c], jsonstr, &tokens[pos + 1], row);
+        if (ret < 0)
+        {
+          jlite_columns_truncate(columns, num_columns, size, row);
+          *num_rows = row;
+          return ret;
+        }
+        valid |= (uint64_t) ret << c;
+      }
+      pos = (int) jlite_next_sibling(tokens, pos);
+    }
+    jlite_columns_end_row(columns, num_columns, valid, row);
+  }
+
+  *num_rows = size;
+  return JLITE_OK;
+}
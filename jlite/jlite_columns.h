@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_columns.h
+ * @brief Columnar extraction of arrays of records.
+ *
+ */
+
+#ifndef _JLITE_COLUMNS_H
+#define _JLITE_COLUMNS_H
+
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of columns of one extraction. */
+#define JLITE_COLUMNS_MAX 64
+
+/* Members per record whose column is predicted from the previous record. */
+#ifndef JLITE_COLUMNS_MAX_MEMBERS
+#define JLITE_COLUMNS_MAX_MEMBERS 64
+#endif
+
+/**
+ * @brief Value type of a column.
+ *
+ */
+
+typedef enum
+{
+  JLITE_COLUMN_INT64,   /* int64_t values[rows]. */
+  JLITE_COLUMN_DOUBLE,  /* double values[rows]. */
+  JLITE_COLUMN_BOOL,    /* uint8_t values[(rows + 7) / 8], bit-packed. */
+  JLITE_COLUMN_STRING   /* int32_t values[rows + 1] offsets into data. */
+} jlite_column_type_t;
+
+/**
+ * @brief One column, laid out as an Arrow array.
+ *
+ * All buffers are provided by the caller and sized for max_rows. Bitmaps
+ * are LSB first: row i is bit (i % 8) of byte i / 8. A row is null when the
+ * record is not an object, lacks the member, holds null or holds a value of
+ * another type. Strings are stored as their raw JSON text, like
+ * jlite_get_value_str(), without the quotes and with escapes kept.
+ *
+ */
+
+typedef struct
+{
+  const char *key;           /* Member of the records to extract. */
+  jlite_column_type_t type;
+  uint8_t *validity;         /* (max_rows + 7) / 8 bytes. */
+  void *values;              /* Values or offsets, see jlite_column_type_t. */
+  char *data;                /* String bytes, JLITE_COLUMN_STRING only. */
+  int32_t data_size;         /* Size of data. */
+  int32_t data_len;          /* Output: bytes used in data. */
+  long null_count;           /* Output: null rows. */
+  long mismatched;           /* Output: null rows holding another type. */
+} jlite_column_t;
+
+/**
+ * @brief Extract members of the object elements of already held JSON
+ * array into columns.
+ *
+ * The records are visited in one pass. Each member key is compared once,
+ * against the column predicted from the same member index of the previous
+ * record, and against all keys only when that prediction misses, so the
+ * cost for homogeneous records does not grow with the number of columns.
+ * If a record repeats a key the first member wins, as for the getters.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param columns Columns to fill.
+ * @param num_columns Number of columns, at most JLITE_COLUMNS_MAX.
+ * @param max_rows Rows the column buffers can hold.
+ * @param num_rows Output: rows extracted. On JLITE_E_NO_BUFFER_MEM it is
+ * the array size if max_rows is too small, else the rows completed before
+ * a string column ran out of data.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_extract_columns(jliteobj_t *jsonobj, jlite_column_t *columns,
+    int num_columns, int max_rows, int *num_rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_COLUMNS_H */
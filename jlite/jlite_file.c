@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_file.c
+ * @brief This file contains the memory mapped file API definition.
+ *
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "jlite_file.h"
+
+#ifdef JSMN_LARGE
+#define JLITE_FILE_MAX PTRDIFF_MAX
+#else
+#define JLITE_FILE_MAX INT_MAX
+#endif
+
+int jlite_file_map(const char *path, jlite_file_t *file)
+{
+  if (!path || !file)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  struct stat st;
+  void *data = NULL;
+  int fd = 0;
+
+  file->data = NULL;
+  file->size = 0;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return -JLITE_ERR;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    close(fd);
+    return -JLITE_ERR;
+  }
+  if ((uintmax_t) st.st_size > (uintmax_t) JLITE_FILE_MAX)
+  {
+    close(fd);
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  data = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+      fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return -JLITE_ERR;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(data, (size_t) st.st_size, MADV_SEQUENTIAL);
+#endif
+
+  file->data = data;
+  file->size = (size_t) st.st_size;
+  return JLITE_OK;
+}
+
+int jlite_file_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    jsmnint_t num_tokens, const char *path, jlite_file_t *file)
+{
+  if (!jsonobj || !tokens || num_tokens <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+
+  ret = jlite_file_map(path, file);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  ret = jlite_parse_init(jsonobj, tokens, num_tokens, file->data,
+      (jsmnint_t) file->size);
+  if (ret != JLITE_OK)
+  {
+    jlite_file_unmap(file);
+  }
+  return ret;
+}
+
+int jlite_file_unmap(jlite_file_t *file)
+{
+  if (!file)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  if (file->data && munmap(file->data, file->size) != 0)
+  {
+    return -JLITE_ERR;
+  }
+  file->data = NULL;
+  file->size = 0;
+  return JLITE_OK;
+}
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_file.h
+ * @brief Memory mapped JSON files.
+ *
+ */
+
+#ifndef _JLITE_FILE_H
+#define _JLITE_FILE_H
+
+#include <stddef.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A mapped file.
+ *
+ */
+
+typedef struct
+{
+  char *data;   /* File contents, private copy-on-write mapping. */
+  size_t size;  /* File size. */
+} jlite_file_t;
+
+/**
+ * @brief Map a file for parsing without reading it into a buffer.
+ *
+ * The whole file is mapped read-write and private, the file itself is never
+ * modified. The kernel is told the access is sequential so read-ahead keeps
+ * up with the tokenizer. Without JSMN_LARGE files of 2 GB and more are
+ * refused since their offsets do not fit the tokens.
+ *
+ * @param path File path.
+ * @param file Pointer to the mapping to fill.
+ *
+ * @return errcode, JLITE_ERR if the file cannot be opened or mapped or is
+ * empty, JLITE_E_NO_BUFFER_MEM if it is too large for jsmnint_t.
+ *
+ */
+
+int jlite_file_map(const char *path, jlite_file_t *file);
+
+/**
+ * @brief Map a file and parse it with jlite_parse_init().
+ *
+ * The mapping must outlive jsonobj and be released with jlite_file_unmap().
+ * On error nothing stays mapped.
+ *
+ * @param jsonobj Pointer to jlite object.
+ * @param tokens Pointer to jsmn token array.
+ * @param num_tokens Number of tokens.
+ * @param path File path.
+ * @param file Pointer to the mapping to fill.
+ *
+ * @return errcode, as jlite_file_map() and jlite_parse_init().
+ *
+ */
+
+int jlite_file_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    jsmnint_t num_tokens, const char *path, jlite_file_t *file);
+
+/**
+ * @brief Release a mapping from jlite_file_map().
+ *
+ * @param file Pointer to the mapping.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_file_unmap(jlite_file_t *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_FILE_H */
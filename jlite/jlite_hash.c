@@ -0,0 +1,435 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_hash.c
+ * @brief This file contains the structural hashing API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_hash.h"
+
+#define JLITE_HASH_K1 0x9E3779B97F4A7C15ULL
+#define JLITE_HASH_K2 0xC2B2AE3D27D4EB4FULL
+#define JLITE_HASH_K3 0x165667B19E3779F9ULL
+
+/* Multipliers of the ordered (array) combine, one per lane. */
+#define JLITE_HASH_P1 0x100000001B3ULL
+#define JLITE_HASH_P2 0xD6E8FEB86659FD93ULL
+
+/* Seeds which keep values of different kinds apart. */
+enum jlite_hash_tag
+{
+  JLITE_HASH_TAG_STRING = 1,
+  JLITE_HASH_TAG_KEY,
+  JLITE_HASH_TAG_NUMBER,
+  JLITE_HASH_TAG_LITERAL,
+  JLITE_HASH_TAG_OBJECT,
+  JLITE_HASH_TAG_ARRAY,
+  JLITE_HASH_TAG_INT,
+};
+
+static inline uint64_t jlite_hash_rotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+/* MurmurHash3 finalizer. */
+static inline uint64_t jlite_hash_mix(uint64_t x)
+{
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+/* Little-endian load, so hashes do not depend on the host byte order. */
+static inline uint64_t jlite_hash_load(const unsigned char *p)
+{
+  uint64_t word = 0;
+
+  memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+static inline uint64_t jlite_hash_load_tail(const unsigned char *p,
+    size_t len)
+{
+  uint64_t word = 0;
+  size_t i = 0;
+
+  for (i = 0; i < len; i++)
+  {
+    word |= (uint64_t) p[i] << (8 * i);
+  }
+  return word;
+}
+
+static inline uint64_t jlite_hash_round(uint64_t acc, uint64_t word)
+{
+  return jlite_hash_rotl(acc + word * JLITE_HASH_K2, 31) * JLITE_HASH_K1;
+}
+
+/*
+ * Four independent accumulators take 32 bytes per step, so the multiply
+ * latency of one lane overlaps with the others.
+ */
+jlite_hash_t jlite_hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+  const unsigned char *p = data;
+  uint64_t v1 = seed + JLITE_HASH_K1 + JLITE_HASH_K2;
+  uint64_t v2 = seed + JLITE_HASH_K2;
+  uint64_t v3 = seed;
+  uint64_t v4 = seed - JLITE_HASH_K1;
+  size_t left = len;
+  jlite_hash_t h;
+
+  while (left >= 32)
+  {
+    v1 = jlite_hash_round(v1, jlite_hash_load(p));
+    v2 = jlite_hash_round(v2, jlite_hash_load(p + 8));
+    v3 = jlite_hash_round(v3, jlite_hash_load(p + 16));
+    v4 = jlite_hash_round(v4, jlite_hash_load(p + 24));
+    p += 32;
+    left -= 32;
+  }
+  while (left >= 8)
+  {
+    v1 = jlite_hash_round(v1, jlite_hash_load(p));
+    v1 = jlite_hash_rotl(v1, 27);
+    p += 8;
+    left -= 8;
+  }
+  if (left)
+  {
+    v2 = jlite_hash_round(v2, jlite_hash_load_tail(p, left));
+  }
+
+  h.lo = jlite_hash_mix(jlite_hash_rotl(v1, 1) + jlite_hash_rotl(v2, 7) +
+      jlite_hash_rotl(v3, 12) + jlite_hash_rotl(v4, 18) + len);
+  h.hi = jlite_hash_mix((v1 * JLITE_HASH_K3) ^ jlite_hash_rotl(v2, 29) ^
+      (v3 * JLITE_HASH_K2) ^ jlite_hash_rotl(v4, 41) ^ h.lo);
+  return h;
+}
+
+static inline jlite_hash_t jlite_hash_word(uint64_t word, uint64_t tag)
+{
+  jlite_hash_t h;
+
+  h.lo = jlite_hash_mix(word ^ (tag * JLITE_HASH_K1));
+  h.hi = jlite_hash_mix(word ^ (tag * JLITE_HASH_K2) ^ h.lo);
+  return h;
+}
+
+static int jlite_hash_is_number(const jliteobj_t *jsonobj,
+    const jlitetok_t *tok)
+{
+  char c = jsonobj->jsonstr[tok->start];
+
+  return c == '-' || (c >= '0' && c <= '9');
+}
+
+/*
+ * Value of a number token. Integers a double holds exactly are kept as
+ * doubles, so 1, 1.0 and 1e0 agree; larger ones stay exact int64 values.
+ */
+typedef struct
+{
+  int is_int;
+  int64_t i;
+  double d;
+} jlite_hash_num_t;
+
+/* Decode a number token, with -0 folded into 0. */
+static int jlite_hash_number(const jliteobj_t *jsonobj, const jlitetok_t *tok,
+    jlite_hash_num_t *num)
+{
+  const char *str = jsonobj->jsonstr + tok->start;
+  int len = tok->end - tok->start;
+  int ret = 0;
+
+  num->is_int = 0;
+  if ((tok->kind == JSMN_KIND_INT || tok->kind == JSMN_KIND_NONE) &&
+      jlite_number_to_int64(str, len, &num->i) == JLITE_OK)
+  {
+    num->d = (double) num->i;
+    num->is_int = num->d < -9223372036854775808.0 ||
+        num->d >= 9223372036854775808.0 || (int64_t) num->d != num->i;
+    if (!num->is_int && num->d == 0)
+    {
+      num->d = 0;
+    }
+    return JLITE_OK;
+  }
+
+  ret = jlite_number_to_double(str, len, &num->d);
+  if (ret == JLITE_OK && num->d == 0)
+  {
+    num->d = 0;
+  }
+  return ret;
+}
+
+/* Exact: an int64 a double cannot hold equals no double. */
+static int jlite_hash_number_equal(const jlite_hash_num_t *x,
+    const jlite_hash_num_t *y)
+{
+  if (x->is_int || y->is_int)
+  {
+    return x->is_int && y->is_int && x->i == y->i;
+  }
+  return x->d == y->d;
+}
+
+static jlite_hash_t jlite_hash_primitive(const jliteobj_t *jsonobj,
+    const jlitetok_t *tok)
+{
+  jlite_hash_num_t num;
+  uint64_t bits = 0;
+
+  if (jlite_hash_is_number(jsonobj, tok) &&
+      jlite_hash_number(jsonobj, tok, &num) == JLITE_OK)
+  {
+    if (num.is_int)
+    {
+      return jlite_hash_word((uint64_t) num.i, JLITE_HASH_TAG_INT);
+    }
+    memcpy(&bits, &num.d, sizeof(bits));
+    return jlite_hash_word(bits, JLITE_HASH_TAG_NUMBER);
+  }
+  return jlite_hash_bytes(jsonobj->jsonstr + tok->start,
+      (size_t) (tok->end - tok->start), JLITE_HASH_TAG_LITERAL);
+}
+
+int jlite_hash_tokens(jliteobj_t *jsonobj, jlite_hash_t *hashes,
+    int max_hashes)
+{
+  if (!jsonobj || !jsonobj->tokens || !hashes)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  if (max_hashes < jsonobj->num_tokens)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  const jlitetok_t *tok = NULL;
+  jlite_hash_t h;
+  jlite_hash_t key;
+  int parent = 0;
+  int i = 0;
+
+  /*
+   * Children follow their parent, so walking backwards finishes every
+   * subtree before its root. Until then hashes[] of an object, array or
+   * key holds the accumulator of the children seen so far.
+   */
+  memset(hashes, 0, (size_t) jsonobj->num_tokens * sizeof(*hashes));
+  for (i = jsonobj->num_tokens - 1; i >= 0; i--)
+  {
+    tok = &tokens[i];
+    switch (tok->type)
+    {
+      case JSMN_OBJECT:
+        h.lo = jlite_hash_mix(hashes[i].lo ^
+            ((uint64_t) JLITE_HASH_TAG_OBJECT * JLITE_HASH_K1) ^ tok->size);
+        h.hi = jlite_hash_mix(hashes[i].hi ^
+            ((uint64_t) JLITE_HASH_TAG_OBJECT * JLITE_HASH_K2) ^ tok->size);
+        break;
+      case JSMN_ARRAY:
+        h.lo = jlite_hash_mix(hashes[i].lo ^
+            ((uint64_t) JLITE_HASH_TAG_ARRAY * JLITE_HASH_K1) ^ tok->size);
+        h.hi = jlite_hash_mix(hashes[i].hi ^
+            ((uint64_t) JLITE_HASH_TAG_ARRAY * JLITE_HASH_K2) ^ tok->size);
+        break;
+      case JSMN_STRING:
+        if (tok->size)
+        {
+          /* Key: the member hash covers the key and its value. */
+          key = jlite_hash_bytes(jsonobj->jsonstr + tok->start,
+              (size_t) (tok->end - tok->start), JLITE_HASH_TAG_KEY);
+          h.lo = jlite_hash_mix(key.lo * JLITE_HASH_K3 + hashes[i].lo);
+          h.hi = jlite_hash_mix(key.hi * JLITE_HASH_K1 + hashes[i].hi);
+        }
+        else
+        {
+          h = jlite_hash_bytes(jsonobj->jsonstr + tok->start,
+              (size_t) (tok->end - tok->start), JLITE_HASH_TAG_STRING);
+        }
+        break;
+      default:
+        h = jlite_hash_primitive(jsonobj, tok);
+        break;
+    }
+    hashes[i] = h;
+
+    parent = tok->parent;
+    if (parent < 0)
+    {
+      continue;
+    }
+    switch (tokens[parent].type)
+    {
+      case JSMN_OBJECT:
+        /* Commutative, so member order does not matter. */
+        hashes[parent].lo += h.lo;
+        hashes[parent].hi += h.hi;
+        break;
+      case JSMN_ARRAY:
+        /* Horner's rule over the elements, last to first. */
+        hashes[parent].lo = hashes[parent].lo * JLITE_HASH_P1 + h.lo;
+        hashes[parent].hi = hashes[parent].hi * JLITE_HASH_P2 + h.hi;
+        break;
+      default:
+        hashes[parent] = h;
+        break;
+    }
+  }
+
+  return JLITE_OK;
+}
+
+static int jlite_hash_span_equal(const jliteobj_t *a, const jlitetok_t *ta,
+    const jliteobj_t *b, const jlitetok_t *tb)
+{
+  return ta->end - ta->start == tb->end - tb->start &&
+      !memcmp(a->jsonstr + ta->start, b->jsonstr + tb->start,
+          (size_t) (ta->end - ta->start));
+}
+
+static int jlite_hash_same(const jlite_hash_t *x, const jlite_hash_t *y)
+{
+  return x->lo == y->lo && x->hi == y->hi;
+}
+
+static int jlite_hash_equal_at(jliteobj_t *a, const jlite_hash_t *ha, int i,
+    jliteobj_t *b, const jlite_hash_t *hb, int j)
+{
+  const jlitetok_t *ta = &a->tokens[i];
+  const jlitetok_t *tb = &b->tokens[j];
+  jlite_hash_num_t va;
+  jlite_hash_num_t vb;
+  int ca = 0;
+  int cb = 0;
+  int k = 0;
+  int m = 0;
+
+  if (!jlite_hash_same(&ha[i], &hb[j]) || ta->type != tb->type ||
+      ta->size != tb->size)
+  {
+    return 0;
+  }
+
+  switch (ta->type)
+  {
+    case JSMN_STRING:
+      if (!jlite_hash_span_equal(a, ta, b, tb))
+      {
+        return 0;
+      }
+      return ta->size ? jlite_hash_equal_at(a, ha, i + 1, b, hb, j + 1) : 1;
+    case JSMN_PRIMITIVE:
+      if (jlite_hash_is_number(a, ta) && jlite_hash_is_number(b, tb) &&
+          jlite_hash_number(a, ta, &va) == JLITE_OK &&
+          jlite_hash_number(b, tb, &vb) == JLITE_OK)
+      {
+        return jlite_hash_number_equal(&va, &vb);
+      }
+      return jlite_hash_span_equal(a, ta, b, tb);
+    case JSMN_ARRAY:
+      ca = i + 1;
+      cb = j + 1;
+      for (k = 0; k < ta->size; k++)
+      {
+        if (!jlite_hash_equal_at(a, ha, ca, b, hb, cb))
+        {
+          return 0;
+        }
+        ca = (int) jlite_next_sibling(a->tokens, ca);
+        cb = (int) jlite_next_sibling(b->tokens, cb);
+      }
+      return 1;
+    case JSMN_OBJECT:
+      /*
+       * Pair every member of a with a member of b by hash. Members in the
+       * same order pair up on the first probe.
+       */
+      ca = i + 1;
+      cb = j + 1;
+      for (k = 0; k < ta->size; k++)
+      {
+        if (!jlite_hash_equal_at(a, ha, ca, b, hb, cb))
+        {
+          cb = j + 1;
+          for (m = 0; m < tb->size; m++)
+          {
+            if (jlite_hash_equal_at(a, ha, ca, b, hb, cb))
+            {
+              break;
+            }
+            cb = (int) jlite_next_sibling(b->tokens, cb);
+          }
+          if (m == tb->size)
+          {
+            return 0;
+          }
+        }
+        ca = (int) jlite_next_sibling(a->tokens, ca);
+        cb = (int) jlite_next_sibling(b->tokens, cb);
+        if (cb >= b->num_tokens || b->tokens[cb].parent != j)
+        {
+          cb = j + 1;
+        }
+      }
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+int jlite_hash_subtree_equal(jliteobj_t *a, const jlite_hash_t *hashes_a,
+    int pos_a, jliteobj_t *b, const jlite_hash_t *hashes_b, int pos_b,
+    int *equal)
+{
+  if (!a || !a->tokens || !hashes_a || !b || !b->tokens || !hashes_b ||
+      !equal)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  if (pos_a < 0 || pos_a >= a->num_tokens || pos_b < 0 ||
+      pos_b >= b->num_tokens)
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
+
+  *equal = jlite_hash_equal_at(a, hashes_a, pos_a, b, hashes_b, pos_b);
+  return JLITE_OK;
+}
@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_hash.h
+ * @brief Structural hashing and subtree equality of parsed JSON.
+ *
+ */
+
+#ifndef _JLITE_HASH_H
+#define _JLITE_HASH_H
+
+#include <stddef.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 128-bit hash, as two independent 64-bit lanes.
+ *
+ */
+
+typedef struct
+{
+  uint64_t lo;
+  uint64_t hi;
+} jlite_hash_t;
+
+/**
+ * @brief Hash a byte string.
+ *
+ * A fast non-cryptographic hash, stable across runs and platforms.
+ *
+ * @param data Pointer to the bytes.
+ * @param len Number of bytes.
+ * @param seed Seed, 0 for the default.
+ *
+ * @return hash
+ *
+ */
+
+jlite_hash_t jlite_hash_bytes(const void *data, size_t len, uint64_t seed);
+
+/**
+ * @brief Compute the structural hash of every token of a parsed JSON.
+ *
+ * hashes[i] receives the hash of the value at token i, covering its whole
+ * subtree. The hash ignores whitespace and the order of object members,
+ * numbers are hashed by value (1, 1.0 and 1e0 hash alike, integers beyond
+ * 2^53 by their exact value) and strings by their raw text, so escapes are
+ * not normalized. For a key token the hash
+ * covers the key and its value. Hashes are stable across documents, runs
+ * and platforms.
+ *
+ * The tokens are visited once, in reverse, folding every token into its
+ * parent through the parent links.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param hashes Array receiving one hash per token.
+ * @param max_hashes Number of entries in hashes, at least the number of
+ * parsed tokens.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_hash_tokens(jliteobj_t *jsonobj, jlite_hash_t *hashes,
+    int max_hashes);
+
+/**
+ * @brief Check whether two subtrees are semantically equal.
+ *
+ * The subtrees may belong to the same or to different JSON objects, each
+ * with hashes computed by jlite_hash_tokens(). Differing hashes decide
+ * inequality at once; on a match the tokens and their text are compared,
+ * using the hashes to pair up object members. With duplicate keys in an
+ * object only the first occurrence of each key is paired.
+ *
+ * @param a Pointer to the first JSON object.
+ * @param hashes_a Token hashes of a.
+ * @param pos_a Token position of the first subtree.
+ * @param b Pointer to the second JSON object.
+ * @param hashes_b Token hashes of b.
+ * @param pos_b Token position of the second subtree.
+ * @param equal Pointer to an int variable set to 1 if equal, else 0.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_hash_subtree_equal(jliteobj_t *a, const jlite_hash_t *hashes_a,
+    int pos_a, jliteobj_t *b, const jlite_hash_t *hashes_b, int pos_b,
+    int *equal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_HASH_H */
@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_index.c
+ * @brief This file contains the sparse array index API definition.
+ *
+ */
+
+#include "jlite_index.h"
+
+int jlite_index_build(jliteobj_t *jsonobj, jlite_index_t *index, void *mem,
+    size_t mem_size, int stride)
+{
+  if (!jsonobj || !jsonobj->tokens || !index || !mem || stride < 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  jsmnint_t *entries = mem;
+  jsmnint_t array_pos = jsonobj->cur_pos - 1;
+  jsmnint_t max_entries = (jsmnint_t) (mem_size / sizeof(jsmnint_t));
+  jsmnint_t num_entries = 0;
+  jsmnint_t size = 0;
+  jsmnint_t pos = 0;
+  jsmnint_t i = 0;
+  int next = 0;
+
+  if (tokens[array_pos].type != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  size = tokens[array_pos].size;
+  if (!stride)
+  {
+    stride = max_entries ? (int) ((size + max_entries - 1) / max_entries) : 0;
+    if (stride < 1)
+    {
+      stride = 1;
+    }
+  }
+  num_entries = (size + stride - 1) / stride;
+  if (num_entries > max_entries || num_entries > INT32_MAX)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  /* Re-tuning: take it out of the list before it changes. */
+  jlite_index_drop(jsonobj, index);
+
+  pos = array_pos + 1;
+  for (i = 0; i < size; i++)
+  {
+    if (!next)
+    {
+      entries[i / stride] = pos;
+      next = stride;
+    }
+    next--;
+    pos = jlite_next_sibling(tokens, pos);
+  }
+
+  index->entries = entries;
+  index->array_pos = array_pos;
+  index->num_entries = (int) num_entries;
+  index->stride = stride;
+  index->next = jsonobj->indexes;
+  jsonobj->indexes = index;
+  return JLITE_OK;
+}
+
+int jlite_index_drop(jliteobj_t *jsonobj, jlite_index_t *index)
+{
+  if (!jsonobj || !index)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_index_t **link = &jsonobj->indexes;
+
+  for (; *link; link = &(*link)->next)
+  {
+    if (*link == index)
+    {
+      *link = index->next;
+      index->next = NULL;
+      return JLITE_OK;
+    }
+  }
+  return -JLITE_E_NO_MATCH;
+}
+
+jsmnint_t jlite_index_seek(const jliteobj_t *jsonobj, jsmnint_t array_pos,
+    int element_pos, int *first_element)
+{
+  const jlite_index_t *index = jsonobj->indexes;
+  int entry = 0;
+
+  for (; index; index = index->next)
+  {
+    if (index->array_pos == array_pos)
+    {
+      entry = element_pos / index->stride;
+      if (entry >= index->num_entries)
+      {
+        return -1;
+      }
+      *first_element = entry * index->stride;
+      return index->entries[entry];
+    }
+  }
+  return -1;
+}
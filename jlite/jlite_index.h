@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_index.h
+ * @brief Sparse skip index for random access into large arrays.
+ *
+ */
+
+#ifndef _JLITE_INDEX_H
+#define _JLITE_INDEX_H
+
+#include <stddef.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Skip index of one array over caller-provided memory.
+ *
+ */
+
+typedef struct jlite_index
+{
+  struct jlite_index *next;  /* Next indexed array of the same object. */
+  jsmnint_t *entries;        /* Token position of every stride-th element. */
+  jsmnint_t array_pos;       /* Token position of the array. */
+  int num_entries;
+  int stride;
+} jlite_index_t;
+
+/**
+ * @brief Index the held array of a JSON object.
+ *
+ * Records the token position of every stride-th element of the array
+ * entered with jlite_get_json_array() or jlite_get_array_element_array(),
+ * so that the array element getters start from the nearest recorded
+ * element and skip at most stride - 1 elements instead of walking from
+ * element 0. With stride 0 the smallest stride whose entries fit in mem is
+ * used, one jsmnint_t per entry.
+ *
+ * The index is attached to jsonobj until jlite_index_drop() or the next
+ * jlite_parse_init(). Building an attached index again re-tunes it. Any
+ * number of arrays of one object can be indexed, each with its own index.
+ *
+ * @param jsonobj Pointer to JSON object, cur_pos inside an array.
+ * @param index Pointer to index, owned by the caller while attached.
+ * @param mem Memory for the entries, aligned for jsmnint_t.
+ * @param mem_size Size of mem in bytes.
+ * @param stride Elements per entry, 0 to derive it from mem_size.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if the entries do not fit in mem.
+ *
+ */
+
+int jlite_index_build(jliteobj_t *jsonobj, jlite_index_t *index, void *mem,
+    size_t mem_size, int stride);
+
+/**
+ * @brief Detach an index, array accesses walk from element 0 again.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param index Pointer to index.
+ *
+ * @return errcode, JLITE_E_NO_MATCH if index is not attached to jsonobj.
+ *
+ */
+
+int jlite_index_drop(jliteobj_t *jsonobj, jlite_index_t *index);
+
+/**
+ * @brief Find the nearest recorded element, used by the array getters.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param array_pos Token position of the array.
+ * @param element_pos Wanted element, within the array.
+ * @param first_element Pointer to an int variable to get the element found.
+ *
+ * @return token position of *first_element, or -1 if the array has no index.
+ *
+ */
+
+jsmnint_t jlite_index_seek(const jliteobj_t *jsonobj, jsmnint_t array_pos,
+    int element_pos, int *first_element);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_INDEX_H */
@@ -0,0 +1,387 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_inflate.c
+ * @brief This file contains the compressed input parsing API definition.
+ *
+ */
+
+#include <string.h>
+#include <zlib.h>
+#include "jlite_inflate.h"
+#include "jsmn/jsmn_variants.h"
+#if JLITE_INFLATE_THREADS
+#include <pthread.h>
+#endif
+
+typedef struct
+{
+  z_stream strm;
+  jlite_inflate_read_t read;
+  void *ctx;
+  char *out;
+  int max_len;
+  int produced;
+  int eof;
+  size_t arena_used;
+  uint8_t in[JLITE_INFLATE_INPUT];
+  uint64_t arena[JLITE_INFLATE_ARENA / sizeof(uint64_t)];
+#if JLITE_INFLATE_THREADS
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int avail;
+  int status;
+  int stop;
+#endif
+} jlite_inflate_t;
+
+/* zlib allocator over the arena, everything is released at once. */
+static voidpf jlite_inflate_alloc(voidpf opaque, uInt items, uInt size)
+{
+  jlite_inflate_t *inf = (jlite_inflate_t *) opaque;
+  size_t len = ((size_t) items * size + 7) & ~(size_t) 7;
+  void *p = NULL;
+
+  if (len > sizeof(inf->arena) - inf->arena_used)
+  {
+    return Z_NULL;
+  }
+  p = (uint8_t *) inf->arena + inf->arena_used;
+  inf->arena_used += len;
+  return p;
+}
+
+static void jlite_inflate_free(voidpf opaque, voidpf address)
+{
+  (void) opaque;
+  (void) address;
+}
+
+static int jlite_inflate_init(jlite_inflate_t *inf, char *out, int max_len,
+    jlite_inflate_read_t read, void *ctx, const uint8_t *buf, size_t len)
+{
+  memset(&inf->strm, 0, sizeof(inf->strm));
+  inf->strm.zalloc = jlite_inflate_alloc;
+  inf->strm.zfree = jlite_inflate_free;
+  inf->strm.opaque = inf;
+  inf->strm.next_in = (Bytef *) buf;
+  inf->strm.avail_in = (uInt) len;
+  inf->read = read;
+  inf->ctx = ctx;
+  inf->out = out;
+  inf->max_len = max_len;
+  inf->produced = 0;
+  inf->eof = !read;
+  inf->arena_used = 0;
+
+  /* 32 added to the window bits detects gzip or zlib headers. */
+  if (inflateInit2(&inf->strm, 15 + 32) != Z_OK)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  return JLITE_OK;
+}
+
+/*
+ * Inflate up to JLITE_INFLATE_BLOCK more bytes of text. Returns 1 if the
+ * stream continues, 0 at its end, or an errcode.
+ */
+static int jlite_inflate_step(jlite_inflate_t *inf)
+{
+  int room = inf->max_len - inf->produced;
+  char spare = 0;
+  long n = 0;
+  int ret = 0;
+
+  if (room > JLITE_INFLATE_BLOCK)
+  {
+    room = JLITE_INFLATE_BLOCK;
+  }
+
+  /* A full buffer is an error only if the stream has more text. */
+  inf->strm.next_out = room ? (Bytef *) inf->out + inf->produced :
+      (Bytef *) &spare;
+  inf->strm.avail_out = room ? (uInt) room : 1;
+
+  while (inf->strm.avail_out)
+  {
+    if (!inf->strm.avail_in && !inf->eof)
+    {
+      n = inf->read(inf->ctx, inf->in, sizeof(inf->in));
+      if (n < 0)
+      {
+        return -JLITE_ERR;
+      }
+      inf->strm.next_in = inf->in;
+      inf->strm.avail_in = (uInt) n;
+      inf->eof = !n;
+    }
+
+    ret = inflate(&inf->strm, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END)
+    {
+      break;
+    }
+    if (ret == Z_MEM_ERROR)
+    {
+      return -JLITE_E_NO_BUFFER_MEM;
+    }
+    if ((ret != Z_OK && ret != Z_BUF_ERROR) ||
+        (ret == Z_BUF_ERROR && !inf->strm.avail_in && inf->eof))
+    {
+      /* Corrupt, or truncated before the end of the stream. */
+      return -JLITE_E_INVALID_JSON;
+    }
+  }
+
+  if (!room)
+  {
+    return inf->strm.avail_out ? 0 : -JLITE_E_NO_BUFFER_MEM;
+  }
+  inf->produced += room - (int) inf->strm.avail_out;
+  return ret == Z_STREAM_END ? 0 : 1;
+}
+
+static int jlite_inflate_is_delim(char c)
+{
+  return c == ',' || c == ':' || c == '[' || c == ']' || c == '{' ||
+      c == '}' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/*
+ * Tokenize the text inflated so far. A primitive is ended by the end of
+ * the input, so until the stream ends the tokenizer only sees text up to
+ * the last delimiter. Cut strings are resumed by jsmn itself.
+ */
+static int jlite_inflate_feed(jlite_parser *parser, const char *text,
+    int avail, int end, jlitetok_t *tokens, int num_tokens)
+{
+  int len = avail;
+  int ret = 0;
+
+  if (!end)
+  {
+    while (len > (int) parser->pos && !jlite_inflate_is_delim(text[len - 1]))
+    {
+      len--;
+    }
+  }
+
+  ret = jsmn_parse_default(parser, text, (size_t) len, tokens,
+      (unsigned int) num_tokens);
+  if (ret == JSMN_ERROR_NOMEM)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  if (ret == JSMN_ERROR_PART && !end)
+  {
+    return 0;
+  }
+  return ret < 0 ? -JLITE_E_INVALID_JSON : ret;
+}
+
+#if JLITE_INFLATE_THREADS
+static int jlite_inflate_run(jlite_inflate_t *inf, jlite_parser *parser,
+    jlitetok_t *tokens, int num_tokens, int flags);
+
+static void *jlite_inflate_producer(void *arg)
+{
+  jlite_inflate_t *inf = (jlite_inflate_t *) arg;
+  int ret = 1;
+
+  while (ret > 0)
+  {
+    ret = jlite_inflate_step(inf);
+
+    pthread_mutex_lock(&inf->lock);
+    inf->avail = inf->produced;
+    inf->status = ret;
+    if (inf->stop)
+    {
+      ret = 0;
+    }
+    pthread_cond_signal(&inf->cond);
+    pthread_mutex_unlock(&inf->lock);
+  }
+  return NULL;
+}
+
+static int jlite_inflate_pipeline(jlite_inflate_t *inf, jlite_parser *parser,
+    jlitetok_t *tokens, int num_tokens)
+{
+  pthread_t producer;
+  int avail = inf->produced;
+  int status = 1;
+  int ret = 0;
+
+  inf->avail = inf->produced;
+  inf->status = 1;
+  inf->stop = 0;
+  pthread_mutex_init(&inf->lock, NULL);
+  pthread_cond_init(&inf->cond, NULL);
+  if (pthread_create(&producer, NULL, jlite_inflate_producer, inf))
+  {
+    /* No thread to spare, finish on this one. */
+    pthread_cond_destroy(&inf->cond);
+    pthread_mutex_destroy(&inf->lock);
+    return jlite_inflate_run(inf, parser, tokens, num_tokens, 0);
+  }
+
+  while (status > 0)
+  {
+    pthread_mutex_lock(&inf->lock);
+    while (inf->avail == avail && inf->status > 0)
+    {
+      pthread_cond_wait(&inf->cond, &inf->lock);
+    }
+    avail = inf->avail;
+    status = inf->status;
+    pthread_mutex_unlock(&inf->lock);
+
+    ret = status < 0 ? status :
+        jlite_inflate_feed(parser, inf->out, avail, !status, tokens,
+        num_tokens);
+    if (ret < 0)
+    {
+      break;
+    }
+  }
+
+  pthread_mutex_lock(&inf->lock);
+  inf->stop = 1;
+  pthread_mutex_unlock(&inf->lock);
+  pthread_join(producer, NULL);
+  pthread_cond_destroy(&inf->cond);
+  pthread_mutex_destroy(&inf->lock);
+  return ret;
+}
+#endif
+
+/*
+ * Alternate inflating a block and tokenizing it. With
+ * JLITE_INFLATE_THREADED the rest of the stream goes to the pipeline after
+ * the first block, documents within one block are done before a thread
+ * would have started.
+ */
+static int jlite_inflate_run(jlite_inflate_t *inf, jlite_parser *parser,
+    jlitetok_t *tokens, int num_tokens, int flags)
+{
+  int more = 1;
+  int ret = 0;
+
+  while (more > 0)
+  {
+    more = jlite_inflate_step(inf);
+    ret = more < 0 ? more :
+        jlite_inflate_feed(parser, inf->out, inf->produced, !more, tokens,
+        num_tokens);
+    if (ret < 0)
+    {
+      break;
+    }
+#if JLITE_INFLATE_THREADS
+    if (more > 0 && (flags & JLITE_INFLATE_THREADED))
+    {
+      return jlite_inflate_pipeline(inf, parser, tokens, num_tokens);
+    }
+#else
+    (void) flags;
+#endif
+  }
+  return ret;
+}
+
+static int jlite_inflate_parse(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, jlite_inflate_t *inf, int flags)
+{
+  jlite_parser *parser = &jsonobj->j_parser;
+  int ret = 0;
+
+  memset(jsonobj, 0, sizeof(*jsonobj));
+  jsmn_init(parser);
+
+#if JLITE_INFLATE_THREADS
+  ret = jlite_inflate_run(inf, parser, tokens, num_tokens, flags);
+#else
+  ret = (flags & JLITE_INFLATE_THREADED) ? -JLITE_E_NOT_SUPPORTED :
+      jlite_inflate_run(inf, parser, tokens, num_tokens, flags);
+#endif
+  inflateEnd(&inf->strm);
+
+  if (ret < 0)
+  {
+    return ret;
+  }
+
+  jsonobj->jsonstr = inf->out;
+  jsonobj->jsonstr_len = inf->produced;
+  jsonobj->tokens = tokens;
+  jsonobj->num_tokens = ret;
+  jsonobj->cur_pos = 1;
+
+  return JLITE_OK;
+}
+
+int jlite_inflate_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int max_len, jlite_inflate_read_t read,
+    void *ctx, int flags)
+{
+  if (!jsonobj || !tokens || num_tokens <= 0 || !jsonstr || max_len <= 0 ||
+      !read)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_inflate_t inf;
+  int ret = 0;
+
+  ret = jlite_inflate_init(&inf, jsonstr, max_len, read, ctx, NULL, 0);
+  if (ret < 0)
+  {
+    return ret;
+  }
+  return jlite_inflate_parse(jsonobj, tokens, num_tokens, &inf, flags);
+}
+
+int jlite_inflate_parse_buffer(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int max_len, const uint8_t *buf,
+    size_t len, int flags)
+{
+  if (!jsonobj || !tokens || num_tokens <= 0 || !jsonstr || max_len <= 0 ||
+      !buf || !len || len > (uInt) -1)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_inflate_t inf;
+  int ret = 0;
+
+  ret = jlite_inflate_init(&inf, jsonstr, max_len, NULL, NULL, buf, len);
+  if (ret < 0)
+  {
+    return ret;
+  }
+  return jlite_inflate_parse(jsonobj, tokens, num_tokens, &inf, flags);
+}
@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_inflate.h
+ * @brief Parsing of gzip or zlib compressed JSON while it is inflated.
+ *
+ */
+
+#ifndef _JLITE_INFLATE_H
+#define _JLITE_INFLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bytes inflated before the tokenizer catches up. */
+#ifndef JLITE_INFLATE_BLOCK
+#define JLITE_INFLATE_BLOCK (64 * 1024)
+#endif
+
+/* Compressed bytes asked from the read callback at once. */
+#ifndef JLITE_INFLATE_INPUT
+#define JLITE_INFLATE_INPUT (16 * 1024)
+#endif
+
+/* zlib state and window, allocated from the stack instead of the heap. */
+#ifndef JLITE_INFLATE_ARENA
+#define JLITE_INFLATE_ARENA (48 * 1024)
+#endif
+
+/* Set JLITE_INFLATE_THREADS to 0 to build without pthreads. */
+#ifndef JLITE_INFLATE_THREADS
+#define JLITE_INFLATE_THREADS 1
+#endif
+
+/* Flag: inflate on a second thread while the calling thread tokenizes. */
+#define JLITE_INFLATE_THREADED 0x1
+
+/**
+ * Read callback for compressed input. Returns the number of bytes stored in
+ * buf, 0 at the end of the input or a negative value on error.
+ */
+typedef long (*jlite_inflate_read_t)(void *ctx, uint8_t *buf, size_t len);
+
+/**
+ * @brief Initialize JSON object from a gzip or zlib stream.
+ *
+ * Equivalent of jlite_parse_init() for compressed input, the format is
+ * detected from the header. The text is inflated in blocks of
+ * JLITE_INFLATE_BLOCK bytes straight into jsonstr and each block is
+ * tokenized while it is still in cache, so the compressed input never has
+ * to be held in memory and the two steps overlap. With
+ * JLITE_INFLATE_THREADED inflating runs on a second thread and the total
+ * time approaches the slower of the two stages. Only the first stream of
+ * concatenated gzip members is read.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param tokens Pointer to array of JSON tokens.
+ * @param num_tokens Number of tokens in tokens array.
+ * @param jsonstr Buffer for the inflated text, owned by the caller while
+ * jsonobj is used.
+ * @param max_len Size of jsonstr.
+ * @param read Read callback for the compressed bytes.
+ * @param ctx Context passed to read.
+ * @param flags 0 or JLITE_INFLATE_THREADED.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if tokens or jsonstr are too small,
+ * JLITE_E_INVALID_JSON for a corrupt stream or malformed JSON,
+ * JLITE_E_NOT_SUPPORTED for JLITE_INFLATE_THREADED without
+ * JLITE_INFLATE_THREADS and JLITE_ERR if read fails.
+ *
+ */
+
+int jlite_inflate_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int max_len, jlite_inflate_read_t read,
+    void *ctx, int flags);
+
+/**
+ * @brief Initialize JSON object from a gzip or zlib buffer.
+ *
+ * Same as jlite_inflate_parse_init() with the compressed bytes in memory.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param tokens Pointer to array of JSON tokens.
+ * @param num_tokens Number of tokens in tokens array.
+ * @param jsonstr Buffer for the inflated text.
+ * @param max_len Size of jsonstr.
+ * @param buf Compressed bytes.
+ * @param len Length of buf.
+ * @param flags 0 or JLITE_INFLATE_THREADED.
+ *
+ * @return errcode, as jlite_inflate_parse_init().
+ *
+ */
+
+int jlite_inflate_parse_buffer(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int max_len, const uint8_t *buf,
+    size_t len, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_INFLATE_H */
@@ -0,0 +1,648 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_ingest.c
+ * @brief This file contains the batch ingestion API definition.
+ *
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "jlite_ingest.h"
+#if JLITE_INGEST_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#define JLITE_INGEST_ALIGN(n) (((n) + 7) & ~(size_t) 7)
+
+/* One buffer of the pool and the file it currently holds. */
+typedef struct
+{
+  char *data;
+  size_t len;
+  size_t done;
+  struct iovec iov;
+  int index;
+  int fd;
+  int ret;
+} jlite_ingest_slot_t;
+
+typedef struct
+{
+  const char *const *paths;
+  int num_paths;
+  int num_workers;
+  jlite_ingest_cb_t cb;
+  void *ctx;
+  jlite_ingest_slot_t *slots;
+  size_t slot_size;
+  int *free_slots;
+  int num_free;
+  int *ready;
+  int ready_head;
+  int num_ready;
+  int num_buffers;
+  int next;
+  int stop;
+  int done;
+  jlite_ingest_stats_t stats;
+  pthread_mutex_t lock;
+  pthread_cond_t buffer_cond;
+  pthread_cond_t ready_cond;
+} jlite_ingest_t;
+
+/* Take a free slot, -1 if none and wait is 0 or ingestion stopped. */
+static int jlite_ingest_get_slot(jlite_ingest_t *ing, int wait)
+{
+  int slot = -1;
+
+  pthread_mutex_lock(&ing->lock);
+  if (!ing->num_free && !ing->stop)
+  {
+    ing->stats.buffer_waits++;
+  }
+  while (wait && !ing->num_free && !ing->stop)
+  {
+    pthread_cond_wait(&ing->buffer_cond, &ing->lock);
+  }
+  if (ing->num_free && !ing->stop)
+  {
+    slot = ing->free_slots[--ing->num_free];
+  }
+  pthread_mutex_unlock(&ing->lock);
+  return slot;
+}
+
+static int jlite_ingest_stopped(jlite_ingest_t *ing)
+{
+  int stop = 0;
+
+  pthread_mutex_lock(&ing->lock);
+  stop = ing->stop;
+  pthread_mutex_unlock(&ing->lock);
+  return stop;
+}
+
+/*
+ * Open the file of path index into slot. On failure slot->ret holds the
+ * errcode for the callback and no descriptor is left open.
+ */
+static int jlite_ingest_open(jlite_ingest_t *ing, jlite_ingest_slot_t *slot,
+    int index)
+{
+  struct stat st;
+
+  slot->index = index;
+  slot->len = 0;
+  slot->done = 0;
+  slot->ret = JLITE_OK;
+  slot->fd = open(ing->paths[index], O_RDONLY | O_CLOEXEC);
+  if (slot->fd < 0)
+  {
+    slot->ret = -JLITE_ERR;
+    return slot->ret;
+  }
+  if (fstat(slot->fd, &st) || !S_ISREG(st.st_mode))
+  {
+    slot->ret = -JLITE_ERR;
+  }
+  /* The tokens go behind the text, at least one has to fit. */
+  else if ((uint64_t) st.st_size > INT_MAX || JLITE_INGEST_ALIGN(
+      (size_t) st.st_size) + sizeof(jlitetok_t) > ing->slot_size)
+  {
+    slot->ret = -JLITE_E_NO_BUFFER_MEM;
+  }
+  else
+  {
+    slot->len = (size_t) st.st_size;
+    return JLITE_OK;
+  }
+  close(slot->fd);
+  slot->fd = -1;
+  return slot->ret;
+}
+
+/* Parse the text of a slot, run the callback and recycle the slot. */
+static void jlite_ingest_parse(jlite_ingest_t *ing, int s)
+{
+  jlite_ingest_slot_t *slot = &ing->slots[s];
+  size_t text = JLITE_INGEST_ALIGN(slot->len);
+  jliteobj_t jsonobj;
+  int num_tokens = (int) ((ing->slot_size - text) / sizeof(jlitetok_t));
+  int ret = slot->ret;
+  int stop = 0;
+
+  if (ret == JLITE_OK)
+  {
+    ret = !slot->len ? -JLITE_E_INVALID_JSON :
+        jlite_parse_init(&jsonobj, (jlitetok_t *) (slot->data + text),
+        num_tokens, slot->data, (int) slot->len);
+    if (ret != JLITE_OK)
+    {
+      ret = slot->len && jsonobj.j_parser.toknext >= (unsigned int) num_tokens ?
+          -JLITE_E_NO_BUFFER_MEM : -JLITE_E_INVALID_JSON;
+    }
+  }
+
+  if (!jlite_ingest_stopped(ing))
+  {
+    stop = ing->cb(ing->ctx, slot->index, ret == JLITE_OK ? &jsonobj : NULL,
+        ret);
+  }
+
+  pthread_mutex_lock(&ing->lock);
+  ing->stats.files++;
+  ing->stats.bytes += slot->done;
+  ing->stats.failed += ret != JLITE_OK;
+  ing->stop |= stop;
+  ing->free_slots[ing->num_free++] = s;
+  pthread_cond_signal(&ing->buffer_cond);
+  if (stop)
+  {
+    pthread_cond_broadcast(&ing->buffer_cond);
+  }
+  pthread_mutex_unlock(&ing->lock);
+}
+
+/* A slot is complete: queue it for the workers or parse it here. */
+static void jlite_ingest_deliver(jlite_ingest_t *ing, int s)
+{
+  if (ing->slots[s].fd >= 0)
+  {
+    close(ing->slots[s].fd);
+    ing->slots[s].fd = -1;
+  }
+  if (!ing->num_workers)
+  {
+    jlite_ingest_parse(ing, s);
+    return;
+  }
+
+  pthread_mutex_lock(&ing->lock);
+  ing->ready[(ing->ready_head + ing->num_ready++) % ing->num_buffers] = s;
+  pthread_cond_signal(&ing->ready_cond);
+  pthread_mutex_unlock(&ing->lock);
+}
+
+static void *jlite_ingest_worker(void *arg)
+{
+  jlite_ingest_t *ing = (jlite_ingest_t *) arg;
+  int s = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&ing->lock);
+    while (!ing->num_ready && !ing->done)
+    {
+      pthread_cond_wait(&ing->ready_cond, &ing->lock);
+    }
+    if (!ing->num_ready)
+    {
+      pthread_mutex_unlock(&ing->lock);
+      return NULL;
+    }
+    s = ing->ready[ing->ready_head];
+    ing->ready_head = (ing->ready_head + 1) % ing->num_buffers;
+    ing->num_ready--;
+    pthread_mutex_unlock(&ing->lock);
+
+    jlite_ingest_parse(ing, s);
+  }
+}
+
+/* pread() reader, queue_depth of these run side by side. */
+static void *jlite_ingest_reader(void *arg)
+{
+  jlite_ingest_t *ing = (jlite_ingest_t *) arg;
+  jlite_ingest_slot_t *slot = NULL;
+  unsigned long reads = 0;
+  ssize_t n = 0;
+  int index = 0;
+  int s = 0;
+
+  for (;;)
+  {
+    pthread_mutex_lock(&ing->lock);
+    index = ing->stop ? ing->num_paths : ing->next;
+    if (index < ing->num_paths)
+    {
+      ing->next++;
+    }
+    pthread_mutex_unlock(&ing->lock);
+
+    if (index >= ing->num_paths || (s = jlite_ingest_get_slot(ing, 1)) < 0)
+    {
+      break;
+    }
+    slot = &ing->slots[s];
+    if (jlite_ingest_open(ing, slot, index) == JLITE_OK)
+    {
+      while (slot->done < slot->len)
+      {
+        n = pread(slot->fd, slot->data + slot->done, slot->len - slot->done,
+            (off_t) slot->done);
+        reads++;
+        if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+        if (n < 0)
+        {
+          slot->ret = -JLITE_ERR;
+          break;
+        }
+        if (n == 0)
+        {
+          /* The file shrank since fstat(). */
+          slot->len = slot->done;
+          break;
+        }
+        slot->done += (size_t) n;
+      }
+    }
+    jlite_ingest_deliver(ing, s);
+  }
+
+  pthread_mutex_lock(&ing->lock);
+  ing->stats.reads += reads;
+  pthread_mutex_unlock(&ing->lock);
+  return NULL;
+}
+
+#if JLITE_INGEST_URING
+/* Submission and completion rings of an io_uring instance. */
+typedef struct
+{
+  int fd;
+  unsigned int *sq_tail;
+  unsigned int *sq_mask;
+  unsigned int *sq_array;
+  unsigned int *cq_head;
+  unsigned int *cq_tail;
+  unsigned int *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ring;
+  void *cq_ring;
+  size_t sq_ring_size;
+  size_t cq_ring_size;
+  size_t sqes_size;
+} jlite_uring_t;
+
+static void jlite_uring_close(jlite_uring_t *ring)
+{
+  if (ring->sqes)
+  {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+  if (ring->cq_ring && ring->cq_ring != ring->sq_ring)
+  {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring)
+  {
+    munmap(ring->sq_ring, ring->sq_ring_size);
+  }
+  close(ring->fd);
+}
+
+static int jlite_uring_init(jlite_uring_t *ring, unsigned int entries)
+{
+  struct io_uring_params p;
+  char *sq = NULL;
+  char *cq = NULL;
+
+  memset(ring, 0, sizeof(*ring));
+  memset(&p, 0, sizeof(p));
+  ring->fd = (int) syscall(__NR_io_uring_setup, entries, &p);
+  if (ring->fd < 0)
+  {
+    return -JLITE_E_NOT_SUPPORTED;
+  }
+
+  ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+  ring->cq_ring_size = p.cq_off.cqes +
+      p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+  {
+    if (ring->cq_ring_size > ring->sq_ring_size)
+    {
+      ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+  ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+  if (ring->sq_ring == MAP_FAILED)
+  {
+    ring->sq_ring = NULL;
+    jlite_uring_close(ring);
+    return -JLITE_E_NOT_SUPPORTED;
+  }
+  ring->cq_ring = (p.features & IORING_FEAT_SINGLE_MMAP) ? ring->sq_ring :
+      mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring->fd, IORING_OFF_CQ_RING);
+  ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED, ring->fd, IORING_OFF_SQES);
+  if (ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED)
+  {
+    ring->cq_ring = ring->cq_ring == MAP_FAILED ? NULL : ring->cq_ring;
+    ring->sqes = ring->sqes == MAP_FAILED ? NULL : ring->sqes;
+    jlite_uring_close(ring);
+    return -JLITE_E_NOT_SUPPORTED;
+  }
+
+  sq = (char *) ring->sq_ring;
+  cq = (char *) ring->cq_ring;
+  ring->sq_tail = (unsigned int *) (sq + p.sq_off.tail);
+  ring->sq_mask = (unsigned int *) (sq + p.sq_off.ring_mask);
+  ring->sq_array = (unsigned int *) (sq + p.sq_off.array);
+  ring->cq_head = (unsigned int *) (cq + p.cq_off.head);
+  ring->cq_tail = (unsigned int *) (cq + p.cq_off.tail);
+  ring->cq_mask = (unsigned int *) (cq + p.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+  return JLITE_OK;
+}
+
+/* Queue a read of the rest of the slot's file, submitted by enter. */
+static void jlite_uring_queue_read(jlite_uring_t *ring,
+    jlite_ingest_slot_t *slot, int s)
+{
+  unsigned int tail = *ring->sq_tail;
+  unsigned int i = tail & *ring->sq_mask;
+  struct io_uring_sqe *sqe = &ring->sqes[i];
+
+  /* READV rather than READ, which needs Linux 5.6. */
+  slot->iov.iov_base = slot->data + slot->done;
+  slot->iov.iov_len = slot->len - slot->done;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = slot->fd;
+  sqe->off = slot->done;
+  sqe->addr = (uint64_t) (uintptr_t) &slot->iov;
+  sqe->len = 1;
+  sqe->user_data = (uint64_t) s;
+  ring->sq_array[i] = i;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static int jlite_uring_enter(jlite_uring_t *ring, unsigned int to_submit,
+    unsigned int min_complete)
+{
+  long ret = 0;
+
+  do
+  {
+    ret = syscall(__NR_io_uring_enter, ring->fd, to_submit, min_complete,
+        min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  } while (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+  return ret < 0 ? -JLITE_ERR : JLITE_OK;
+}
+
+/*
+ * Keep up to depth reads in flight on the calling thread. Short reads are
+ * queued again for the rest of the file.
+ */
+static int jlite_ingest_uring(jlite_ingest_t *ing, jlite_uring_t *ring,
+    int depth)
+{
+  jlite_ingest_slot_t *slot = NULL;
+  struct io_uring_cqe *cqe = NULL;
+  unsigned int queued = 0;
+  unsigned int head = 0;
+  int in_flight = 0;
+  int ret = JLITE_OK;
+  int res = 0;
+  int s = 0;
+
+  while (ret == JLITE_OK)
+  {
+    while (in_flight < depth && ing->next < ing->num_paths &&
+        (s = jlite_ingest_get_slot(ing, !in_flight)) >= 0)
+    {
+      slot = &ing->slots[s];
+      if (jlite_ingest_open(ing, slot, ing->next++) != JLITE_OK ||
+          !slot->len)
+      {
+        jlite_ingest_deliver(ing, s);
+        continue;
+      }
+      jlite_uring_queue_read(ring, slot, s);
+      queued++;
+      in_flight++;
+    }
+    if (!in_flight)
+    {
+      break;
+    }
+
+    ret = jlite_uring_enter(ring, queued, 1);
+    ing->stats.reads += queued;
+    queued = 0;
+
+    head = *ring->cq_head;
+    while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+      cqe = &ring->cqes[head & *ring->cq_mask];
+      s = (int) cqe->user_data;
+      res = cqe->res;
+      head++;
+      slot = &ing->slots[s];
+      if (res == -EINTR || res == -EAGAIN)
+      {
+        res = 0;
+      }
+      else if (res < 0)
+      {
+        slot->ret = -JLITE_ERR;
+        res = 0;
+        slot->len = slot->done;
+      }
+      else if (res == 0)
+      {
+        /* The file shrank since fstat(). */
+        slot->len = slot->done;
+      }
+      slot->done += (size_t) res;
+      if (slot->done < slot->len)
+      {
+        jlite_uring_queue_read(ring, slot, s);
+        queued++;
+        continue;
+      }
+      in_flight--;
+      jlite_ingest_deliver(ing, s);
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  }
+  return ret;
+}
+#endif
+
+int jlite_ingest_files(const jlite_ingest_opts_t *opts,
+    const char *const *paths, int num_paths, jlite_ingest_cb_t cb, void *ctx,
+    jlite_ingest_stats_t *stats)
+{
+  if (!opts || !opts->arena || opts->num_buffers <= 0 ||
+      opts->queue_depth <= 0 || opts->num_workers < 0 || !paths ||
+      num_paths < 0 || !cb)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_ingest_t ing;
+  pthread_t threads[2 * JLITE_INGEST_MAX_THREADS];
+  char *base = (char *) JLITE_INGEST_ALIGN((uintptr_t) opts->arena);
+  size_t skew = (size_t) (base - (char *) opts->arena);
+  size_t header = JLITE_INGEST_ALIGN((size_t) opts->num_buffers *
+      (sizeof(jlite_ingest_slot_t) + 2 * sizeof(int)));
+  int depth = opts->queue_depth < opts->num_buffers ? opts->queue_depth :
+      opts->num_buffers;
+  int num_threads = 0;
+  int started = 0;
+  int ret = JLITE_OK;
+  int i = 0;
+#if JLITE_INGEST_URING
+  jlite_uring_t ring;
+  int uring = !(opts->flags & JLITE_INGEST_PREAD);
+#endif
+
+  if (opts->num_workers > JLITE_INGEST_MAX_THREADS ||
+      depth > JLITE_INGEST_MAX_THREADS)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  if (opts->arena_size < skew + header)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  memset(&ing, 0, sizeof(ing));
+  ing.slot_size = (opts->arena_size - skew - header) /
+      (size_t) opts->num_buffers & ~(size_t) 7;
+  if (ing.slot_size < sizeof(jlitetok_t) + 8)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  ing.paths = paths;
+  ing.num_paths = num_paths;
+  ing.num_workers = opts->num_workers;
+  ing.cb = cb;
+  ing.ctx = ctx;
+  ing.num_buffers = opts->num_buffers;
+  ing.slots = (jlite_ingest_slot_t *) base;
+  ing.free_slots = (int *) (ing.slots + opts->num_buffers);
+  ing.ready = ing.free_slots + opts->num_buffers;
+  for (i = 0; i < opts->num_buffers; i++)
+  {
+    ing.slots[i].data = base + header + (size_t) i * ing.slot_size;
+    ing.slots[i].fd = -1;
+    ing.free_slots[ing.num_free++] = opts->num_buffers - 1 - i;
+  }
+
+#if JLITE_INGEST_URING
+  if (uring && jlite_uring_init(&ring, (unsigned int) depth) != JLITE_OK)
+  {
+    uring = 0;
+  }
+  ing.stats.uring = uring;
+#endif
+
+  pthread_mutex_init(&ing.lock, NULL);
+  pthread_cond_init(&ing.buffer_cond, NULL);
+  pthread_cond_init(&ing.ready_cond, NULL);
+
+  for (i = 0; i < opts->num_workers && ret == JLITE_OK; i++)
+  {
+    ret = pthread_create(&threads[num_threads], NULL, jlite_ingest_worker,
+        &ing) ? -JLITE_ERR : JLITE_OK;
+    num_threads += ret == JLITE_OK;
+  }
+  started = num_threads;
+
+#if JLITE_INGEST_URING
+  if (uring)
+  {
+    if (ret == JLITE_OK)
+    {
+      ret = jlite_ingest_uring(&ing, &ring, depth);
+    }
+    jlite_uring_close(&ring);
+  }
+  else
+#endif
+  {
+    for (i = 0; i < depth && ret == JLITE_OK; i++)
+    {
+      ret = pthread_create(&threads[num_threads], NULL, jlite_ingest_reader,
+          &ing) ? -JLITE_ERR : JLITE_OK;
+      num_threads += ret == JLITE_OK;
+    }
+    if (ret != JLITE_OK)
+    {
+      pthread_mutex_lock(&ing.lock);
+      ing.stop = 1;
+      pthread_cond_broadcast(&ing.buffer_cond);
+      pthread_mutex_unlock(&ing.lock);
+    }
+    for (i = started; i < num_threads; i++)
+    {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  pthread_mutex_lock(&ing.lock);
+  ing.done = 1;
+  pthread_cond_broadcast(&ing.ready_cond);
+  pthread_mutex_unlock(&ing.lock);
+  for (i = 0; i < started; i++)
+  {
+    pthread_join(threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&ing.ready_cond);
+  pthread_cond_destroy(&ing.buffer_cond);
+  pthread_mutex_destroy(&ing.lock);
+
+  if (stats)
+  {
+    *stats = ing.stats;
+  }
+  return ret;
+}
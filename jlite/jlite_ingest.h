@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_ingest.h
+ * @brief Batch ingestion of JSON files with reads kept in flight.
+ *
+ */
+
+#ifndef _JLITE_INGEST_H
+#define _JLITE_INGEST_H
+
+#include <stddef.h>
+#include "jlite.h"
+
+/*
+ * Set JLITE_INGEST_URING to 0 to build without io_uring. It is only used
+ * on Linux, elsewhere and when the kernel refuses it reads go through a
+ * pool of pread() threads.
+ */
+#ifndef JLITE_INGEST_URING
+#ifdef __linux__
+#define JLITE_INGEST_URING 1
+#else
+#define JLITE_INGEST_URING 0
+#endif
+#endif
+
+/* Limit for queue_depth and num_workers. */
+#ifndef JLITE_INGEST_MAX_THREADS
+#define JLITE_INGEST_MAX_THREADS 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Flag: use the pread() threads even if io_uring is available. */
+#define JLITE_INGEST_PREAD 0x1
+
+/**
+ * @brief Ingestion counters.
+ *
+ */
+
+typedef struct
+{
+  unsigned long files;         /* Files handed to the callback. */
+  unsigned long failed;        /* Of those, failed to read or parse. */
+  unsigned long bytes;         /* Bytes read. */
+  unsigned long reads;         /* Read requests, short reads add one. */
+  unsigned long buffer_waits;  /* Times reading stalled on a free buffer. */
+  int uring;                   /* 1 if reads went through io_uring. */
+} jlite_ingest_stats_t;
+
+/**
+ * @brief Ingestion settings.
+ *
+ * The arena is split into num_buffers equal slots, each holding one file
+ * and its tokens, like jlite_cache_init(). A file larger than a slot fails
+ * with JLITE_E_NO_BUFFER_MEM. Slots are recycled as soon as the callback
+ * of their file returns, so num_buffers bounds the memory in use and
+ * should be at least queue_depth + num_workers.
+ *
+ */
+
+typedef struct
+{
+  void *arena;        /* Memory for the buffers, owned by the caller. */
+  size_t arena_size;  /* Size of arena. */
+  int num_buffers;    /* Number of slots the arena is split into. */
+  int queue_depth;    /* Reads kept in flight. */
+  int num_workers;    /* Parsing threads, 0 parses on the reading thread. */
+  int flags;          /* 0 or JLITE_INGEST_PREAD. */
+} jlite_ingest_opts_t;
+
+/**
+ * Called once per file with the parsed document. jsonobj is only valid
+ * when ret is JLITE_OK and only until the callback returns. Callbacks run
+ * concurrently on the parsing threads. Returning non-zero stops the
+ * ingestion, reads already in flight are completed but not parsed.
+ */
+typedef int (*jlite_ingest_cb_t)(void *ctx, int index, jliteobj_t *jsonobj,
+    int ret);
+
+/**
+ * @brief Read and parse a list of JSON files.
+ *
+ * Up to queue_depth reads are kept in flight with io_uring, or with as many
+ * pread() threads, and completed buffers go to num_workers threads running
+ * jlite_parse_init(). Files complete in any order, index tells which path
+ * the callback is for. ret passed to the callback is JLITE_OK,
+ * JLITE_ERR if the file could not be read, JLITE_E_NO_BUFFER_MEM if it
+ * does not fit a slot or its tokens, or JLITE_E_INVALID_JSON.
+ *
+ * @param opts Pointer to settings.
+ * @param paths File paths.
+ * @param num_paths Number of paths.
+ * @param cb Callback for each file.
+ * @param ctx Context passed to cb.
+ * @param stats Pointer to counters to fill, may be NULL.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if the arena is too small,
+ * JLITE_E_INVALID_PARAM above JLITE_INGEST_MAX_THREADS and JLITE_ERR if
+ * threads cannot be started.
+ *
+ */
+
+int jlite_ingest_files(const jlite_ingest_opts_t *opts,
+    const char *const *paths, int num_paths, jlite_ingest_cb_t cb, void *ctx,
+    jlite_ingest_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_INGEST_H */
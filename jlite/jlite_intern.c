@@ -0,0 +1,207 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_intern.c
+ * @brief This file contains the key interning API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_intern.h"
+
+static unsigned long jlite_intern_serial;
+
+/* FNV-1a, keys are short. */
+static uint32_t jlite_intern_hash(const char *key, size_t len)
+{
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+
+  for (i = 0; i < len; i++)
+  {
+    hash = (hash ^ (unsigned char) key[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/* Slot of the key, or the empty slot where it belongs. */
+static uint32_t jlite_intern_probe(jlite_intern_t *intern, const char *key,
+    size_t len, uint32_t hash)
+{
+  const jlite_intern_entry_t *entry = NULL;
+  uint32_t slot = hash & intern->mask;
+
+  intern->stats.lookups++;
+  for (;;)
+  {
+    intern->stats.probes++;
+    entry = &intern->entries[slot];
+    if (!entry->count || (entry->hash == hash && entry->len == len &&
+        !memcmp(intern->key_mem + entry->offset, key, len)))
+    {
+      return slot;
+    }
+    slot = (slot + 1) & intern->mask;
+  }
+}
+
+int jlite_intern_init(jlite_intern_t *intern, jlite_intern_entry_t *entries,
+    int num_entries, char *key_mem, size_t key_mem_size)
+{
+  if (!intern || !entries || num_entries < 4 ||
+      (num_entries & (num_entries - 1)) || (!key_mem && key_mem_size))
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  memset(intern, 0, sizeof(*intern));
+  memset(entries, 0, (size_t) num_entries * sizeof(*entries));
+  intern->entries = entries;
+  intern->key_mem = key_mem;
+  intern->key_mem_size = key_mem_size;
+  intern->mask = (uint32_t) num_entries - 1;
+  intern->max_keys = num_entries / 4 * 3;
+  intern->serial = __atomic_add_fetch(&jlite_intern_serial, 1,
+      __ATOMIC_RELAXED);
+  return JLITE_OK;
+}
+
+int jlite_intern_document(jlite_intern_t *intern, jliteobj_t *jsonobj,
+    jlite_key_id_t *ids, jsmnint_t num_ids)
+{
+  if (!intern || !intern->entries || !jsonobj || !jsonobj->tokens || !ids ||
+      num_ids < 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  jlite_intern_entry_t *entry = NULL;
+  const char *key = NULL;
+  jsmnint_t i = 0;
+  uint32_t hash = 0;
+  uint32_t slot = 0;
+  size_t len = 0;
+
+  if (num_ids < jsonobj->num_tokens)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  jsonobj->key_ids = NULL;
+  jsonobj->intern = NULL;
+  for (i = 0; i < jsonobj->num_tokens; i++)
+  {
+    /* Keys are the only strings with a child. */
+    if (tokens[i].type != JSMN_STRING || tokens[i].size != 1)
+    {
+      ids[i] = 0;
+      continue;
+    }
+
+    key = jsonobj->jsonstr + tokens[i].start;
+    len = (size_t) (tokens[i].end - tokens[i].start);
+    hash = jlite_intern_hash(key, len);
+    slot = jlite_intern_probe(intern, key, len, hash);
+    entry = &intern->entries[slot];
+    if (!entry->count)
+    {
+      if (intern->num_keys >= intern->max_keys ||
+          len > intern->key_mem_size - intern->key_mem_len)
+      {
+        return -JLITE_E_NO_BUFFER_MEM;
+      }
+      memcpy(intern->key_mem + intern->key_mem_len, key, len);
+      entry->hash = hash;
+      entry->len = (uint32_t) len;
+      entry->offset = intern->key_mem_len;
+      intern->key_mem_len += len;
+      intern->num_keys++;
+    }
+    entry->count++;
+    intern->stats.keys++;
+    ids[i] = slot + 1;
+  }
+
+  intern->stats.documents++;
+  jsonobj->key_ids = ids;
+  jsonobj->intern = intern;
+  return JLITE_OK;
+}
+
+jlite_key_id_t jlite_intern_find(jlite_intern_t *intern, const char *key,
+    size_t len)
+{
+  if (!intern || !intern->entries || (!key && len))
+  {
+    return 0;
+  }
+
+  uint32_t slot = jlite_intern_probe(intern, key, len,
+      jlite_intern_hash(key, len));
+
+  return intern->entries[slot].count ? slot + 1 : 0;
+}
+
+int jlite_intern_get_key(const jlite_intern_t *intern, jlite_key_id_t id,
+    const char **key, size_t *len, unsigned long *count)
+{
+  if (!intern || !intern->entries || !key || !len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlite_intern_entry_t *entry = NULL;
+
+  if (!id || id - 1 > intern->mask || !intern->entries[id - 1].count)
+  {
+    return -JLITE_E_NO_MATCH;
+  }
+
+  entry = &intern->entries[id - 1];
+  *key = intern->key_mem + entry->offset;
+  *len = entry->len;
+  if (count)
+  {
+    *count = entry->count;
+  }
+  return JLITE_OK;
+}
+
+int jlite_intern_get_stats(const jlite_intern_t *intern,
+    jlite_intern_stats_t *stats, int *num_keys)
+{
+  if (!intern || !stats)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  *stats = intern->stats;
+  if (num_keys)
+  {
+    *num_keys = intern->num_keys;
+  }
+  return JLITE_OK;
+}
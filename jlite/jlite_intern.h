@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_intern.h
+ * @brief Key interning dictionary shared by a batch of documents.
+ *
+ */
+
+#ifndef _JLITE_INTERN_H
+#define _JLITE_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dictionary counters.
+ *
+ */
+
+typedef struct
+{
+  unsigned long documents;  /* Documents interned. */
+  unsigned long keys;       /* Key tokens interned, over all documents. */
+  unsigned long lookups;    /* Keys looked up or inserted. */
+  unsigned long probes;     /* Table slots inspected by those lookups. */
+} jlite_intern_stats_t;
+
+/**
+ * @brief One dictionary slot, private to the dictionary.
+ *
+ */
+
+typedef struct
+{
+  uint32_t hash;
+  uint32_t len;
+  size_t offset;        /* Key bytes, in the key memory. */
+  unsigned long count;  /* Occurrences of the key, 0 if the slot is empty. */
+} jlite_intern_entry_t;
+
+/**
+ * @brief Key dictionary over a caller-provided slot table and key memory.
+ *
+ */
+
+typedef struct jlite_intern
+{
+  jlite_intern_entry_t *entries;
+  char *key_mem;
+  size_t key_mem_size;
+  size_t key_mem_len;
+  uint32_t mask;
+  int max_keys;
+  int num_keys;
+  unsigned long serial;  /* Unique per init, keys caches of resolved IDs. */
+  jlite_intern_stats_t stats;
+} jlite_intern_t;
+
+/**
+ * @brief Initialize a key dictionary.
+ *
+ * Every distinct key gets an ID, the index of its slot plus one, which
+ * stays the same for all documents interned into the dictionary. The
+ * table is filled to at most three quarters, so size it to twice the
+ * distinct keys expected in the batch, rounded up to a power of two. The
+ * key bytes are copied to key_mem, so documents can be released once
+ * interned.
+ *
+ * @param intern Pointer to dictionary.
+ * @param entries Slot table, owned by the caller while the dictionary is used.
+ * @param num_entries Number of slots, a power of two.
+ * @param key_mem Memory for the key bytes.
+ * @param key_mem_size Size of key_mem in bytes.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_intern_init(jlite_intern_t *intern, jlite_intern_entry_t *entries,
+    int num_entries, char *key_mem, size_t key_mem_size);
+
+/**
+ * @brief Intern the keys of a parsed JSON object.
+ *
+ * ids[i] receives the ID of the key at token i, and 0 for every token
+ * which is not an object key. The IDs and the dictionary are attached to
+ * jsonobj until the next jlite_parse_init(), and key lookups then compare
+ * IDs instead of key bytes: the looked up key is resolved once, a key
+ * missing from the dictionary fails without a scan. Keys are interned by
+ * their raw text, so escaped keys are distinct from their unescaped form,
+ * as for every other key lookup.
+ *
+ * One dictionary can serve any number of documents in turn, but not
+ * several threads at once.
+ *
+ * @param intern Pointer to dictionary.
+ * @param jsonobj Pointer to parsed JSON object.
+ * @param ids One ID per token, owned by the caller while attached.
+ * @param num_ids Number of IDs.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if ids has fewer entries than
+ * jsonobj has tokens or the dictionary is full. Keys interned before the
+ * dictionary filled up stay in it, but nothing is attached.
+ *
+ */
+
+int jlite_intern_document(jlite_intern_t *intern, jliteobj_t *jsonobj,
+    jlite_key_id_t *ids, jsmnint_t num_ids);
+
+/**
+ * @brief Look up the ID of a key.
+ *
+ * @param intern Pointer to dictionary.
+ * @param key Key bytes.
+ * @param len Length of key.
+ *
+ * @return ID, or 0 if the key was never interned.
+ *
+ */
+
+jlite_key_id_t jlite_intern_find(jlite_intern_t *intern, const char *key,
+    size_t len);
+
+/**
+ * @brief Get the key of an ID and how often it was interned.
+ *
+ * Walking the IDs from 1 to the number of slots gives the key cardinality
+ * profile of the interned documents.
+ *
+ * @param intern Pointer to dictionary.
+ * @param id ID of the key.
+ * @param key Pointer to a const char* variable to get the key bytes.
+ * @param len Pointer to a size_t variable to get the key length.
+ * @param count Pointer to an unsigned long variable to get the occurrences,
+ * may be NULL.
+ *
+ * @return errcode, JLITE_E_NO_MATCH if no key has this ID.
+ *
+ */
+
+int jlite_intern_get_key(const jlite_intern_t *intern, jlite_key_id_t id,
+    const char **key, size_t *len, unsigned long *count);
+
+/**
+ * @brief Get the dictionary counters.
+ *
+ * @param intern Pointer to dictionary.
+ * @param stats Pointer to stats structure to fill.
+ * @param num_keys Pointer to an int variable to get the distinct keys, may
+ * be NULL.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_intern_get_stats(const jlite_intern_t *intern,
+    jlite_intern_stats_t *stats, int *num_keys);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_INTERN_H */
@@ -0,0 +1,711 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_lazy.c
+ * @brief This file contains the on-demand APIs definition, which read a JSON
+ * string without tokenizing it.
+ *
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "jlite_lazy.h"
+
+static int jlite_lazy_skip_ws(const char *jsonstr, int len, int pos)
+{
+  while (pos < len)
+  {
+    switch (jsonstr[pos])
+    {
+      case ' ': case '\t': case '\r': case '\n':
+        pos++;
+        break;
+      default:
+        return pos;
+    }
+  }
+  return pos;
+}
+
+/*
+ * Skip a string starting at the opening quote and return the position after
+ * the closing quote, or -1 if the string is not terminated.
+ */
+static int jlite_lazy_skip_string(const char *jsonstr, int len, int pos)
+{
+  const char *quote = NULL;
+  int escapes = 0;
+  int i = 0;
+
+  pos++;
+  while (pos < len)
+  {
+    quote = memchr(jsonstr + pos, '"', (size_t) (len - pos));
+    if (!quote)
+    {
+      return -1;
+    }
+
+    /* The quote is escaped if preceded by an odd number of backslashes. */
+    i = (int) (quote - jsonstr);
+    escapes = 0;
+    while (i - escapes - 1 >= pos && jsonstr[i - escapes - 1] == '\\')
+    {
+      escapes++;
+    }
+    if (!(escapes & 1))
+    {
+      return i + 1;
+    }
+    pos = i + 1;
+  }
+  return -1;
+}
+
+static int jlite_lazy_skip_primitive(const char *jsonstr, int len, int pos)
+{
+  for (; pos < len; pos++)
+  {
+    switch (jsonstr[pos])
+    {
+      case ' ': case '\t': case '\r': case '\n':
+      case ',': case ']': case '}': case ':':
+        return pos;
+      default:
+        break;
+    }
+  }
+  return pos;
+}
+
+/*
+ * Skip any value starting at pos and return the position just after it,
+ * or -1 if the value is truncated.
+ */
+static int jlite_lazy_skip_value(const char *jsonstr, int len, int pos)
+{
+  int depth = 0;
+
+  if (pos >= len)
+  {
+    return -1;
+  }
+
+  switch (jsonstr[pos])
+  {
+    case '"':
+      return jlite_lazy_skip_string(jsonstr, len, pos);
+    case '{': case '[':
+      break;
+    default:
+      return jlite_lazy_skip_primitive(jsonstr, len, pos);
+  }
+
+  for (; pos < len; pos++)
+  {
+    switch (jsonstr[pos])
+    {
+      case '{': case '[':
+        depth++;
+        break;
+      case '}': case ']':
+        depth--;
+        if (depth == 0)
+        {
+          return pos + 1;
+        }
+        break;
+      case '"':
+        pos = jlite_lazy_skip_string(jsonstr, len, pos);
+        if (pos < 0)
+        {
+          return -1;
+        }
+        pos--;
+        break;
+      default:
+        break;
+    }
+  }
+  return -1;
+}
+
+static void jlite_lazy_set(jlitelazy_t *value, const jlitelazy_t *parent,
+    int start)
+{
+  value->jsonstr = parent->jsonstr;
+  value->jsonstr_len = parent->jsonstr_len;
+  value->start = start;
+  value->resume = 0;
+  value->resume_index = 0;
+}
+
+int jlite_lazy_init(jlitelazy_t *lazy, const char *jsonstr, int jsonstr_len)
+{
+  if (!lazy || !jsonstr || jsonstr_len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  memset(lazy, 0, sizeof(*lazy));
+  lazy->jsonstr = jsonstr;
+  lazy->jsonstr_len = jsonstr_len;
+  lazy->start = jlite_lazy_skip_ws(jsonstr, jsonstr_len, 0);
+  if (lazy->start >= jsonstr_len)
+  {
+    return -JLITE_ERR;
+  }
+
+  return JLITE_OK;
+}
+
+jsmntype_t jlite_lazy_type(const jlitelazy_t *lazy)
+{
+  if (!lazy || !lazy->jsonstr || lazy->start >= lazy->jsonstr_len)
+  {
+    return JSMN_UNDEFINED;
+  }
+
+  switch (lazy->jsonstr[lazy->start])
+  {
+    case '{':
+      return JSMN_OBJECT;
+    case '[':
+      return JSMN_ARRAY;
+    case '"':
+      return JSMN_STRING;
+    case ',': case ':': case '}': case ']':
+      return JSMN_UNDEFINED;
+    default:
+      return JSMN_PRIMITIVE;
+  }
+}
+
+/*
+ * Scan object members starting at pos (first member or separator) and stop
+ * at the closing brace or, if stop is non-zero, at the first member whose
+ * key starts beyond stop.
+ */
+static int jlite_lazy_scan_members(jlitelazy_t *lazy, int pos, int stop,
+    const char *key, int key_len, jlitelazy_t *value)
+{
+  const char *jsonstr = lazy->jsonstr;
+  int len = lazy->jsonstr_len;
+  int key_start = 0;
+  int key_end = 0;
+
+  for (;;)
+  {
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos);
+    if (pos < len && jsonstr[pos] == ',')
+    {
+      pos = jlite_lazy_skip_ws(jsonstr, len, pos + 1);
+    }
+    if (pos >= len)
+    {
+      return -JLITE_ERR;
+    }
+    if (jsonstr[pos] == '}')
+    {
+      return -JLITE_E_KEY_NOT_FOUND;
+    }
+    if (jsonstr[pos] != '"')
+    {
+      return -JLITE_ERR;
+    }
+    if (stop && pos > stop)
+    {
+      return -JLITE_E_KEY_NOT_FOUND;
+    }
+
+    key_start = pos + 1;
+    pos = jlite_lazy_skip_string(jsonstr, len, pos);
+    if (pos < 0)
+    {
+      return -JLITE_ERR;
+    }
+    key_end = pos - 1;
+
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos);
+    if (pos >= len || jsonstr[pos] != ':')
+    {
+      return -JLITE_ERR;
+    }
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos + 1);
+    if (pos >= len)
+    {
+      return -JLITE_ERR;
+    }
+
+    if (key_end - key_start == key_len &&
+        memcmp(jsonstr + key_start, key, (size_t) key_len) == 0)
+    {
+      jlite_lazy_set(value, lazy, pos);
+      lazy->resume = pos;
+      return JLITE_OK;
+    }
+
+    pos = jlite_lazy_skip_value(jsonstr, len, pos);
+    if (pos < 0)
+    {
+      return -JLITE_ERR;
+    }
+  }
+}
+
+int jlite_lazy_find(jlitelazy_t *lazy, const char *key, jlitelazy_t *value)
+{
+  if (!lazy || !key || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  int pos = 0;
+  int resume = 0;
+  int key_len = (int) strlen(key);
+
+  if (jlite_lazy_type(lazy) != JSMN_OBJECT)
+  {
+    return -JLITE_E_NOT_OBJECT;
+  }
+
+  /*
+   * Continue after the member found last time and wrap around to the
+   * members before it, so keys read in document order cost one pass.
+   */
+  resume = lazy->resume;
+  if (resume)
+  {
+    pos = jlite_lazy_skip_value(lazy->jsonstr, lazy->jsonstr_len, resume);
+    if (pos < 0)
+    {
+      return -JLITE_ERR;
+    }
+    ret = jlite_lazy_scan_members(lazy, pos, 0, key, key_len, value);
+    if (ret != -JLITE_E_KEY_NOT_FOUND)
+    {
+      return ret;
+    }
+  }
+
+  return jlite_lazy_scan_members(lazy, lazy->start + 1, resume, key,
+      key_len, value);
+}
+
+int jlite_lazy_element(jlitelazy_t *lazy, int element_pos,
+    jlitelazy_t *value)
+{
+  if (!lazy || !value || element_pos < 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const char *jsonstr = NULL;
+  int len = 0;
+  int pos = 0;
+  int i = 0;
+
+  if (jlite_lazy_type(lazy) != JSMN_ARRAY)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  jsonstr = lazy->jsonstr;
+  len = lazy->jsonstr_len;
+
+  if (lazy->resume && element_pos >= lazy->resume_index)
+  {
+    pos = lazy->resume;
+    i = lazy->resume_index;
+  }
+  else
+  {
+    pos = jlite_lazy_skip_ws(jsonstr, len, lazy->start + 1);
+    if (pos < len && jsonstr[pos] == ']')
+    {
+      return -JLITE_E_OUT_OF_BOUND;
+    }
+  }
+
+  for (; i < element_pos; i++)
+  {
+    pos = jlite_lazy_skip_value(jsonstr, len, pos);
+    if (pos < 0)
+    {
+      return -JLITE_ERR;
+    }
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos);
+    if (pos >= len)
+    {
+      return -JLITE_ERR;
+    }
+    if (jsonstr[pos] == ']')
+    {
+      return -JLITE_E_OUT_OF_BOUND;
+    }
+    if (jsonstr[pos] != ',')
+    {
+      return -JLITE_ERR;
+    }
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos + 1);
+  }
+
+  if (pos >= len)
+  {
+    return -JLITE_ERR;
+  }
+
+  jlite_lazy_set(value, lazy, pos);
+  lazy->resume = pos;
+  lazy->resume_index = element_pos;
+  return JLITE_OK;
+}
+
+int jlite_lazy_size(jlitelazy_t *lazy, int *size)
+{
+  if (!lazy || !size)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const char *jsonstr = NULL;
+  jsmntype_t type = JSMN_UNDEFINED;
+  int len = 0;
+  int pos = 0;
+  int count = 0;
+
+  type = jlite_lazy_type(lazy);
+  if (type != JSMN_ARRAY && type != JSMN_OBJECT)
+  {
+    return -JLITE_E_NOT_ARRAY;
+  }
+
+  jsonstr = lazy->jsonstr;
+  len = lazy->jsonstr_len;
+  pos = jlite_lazy_skip_ws(jsonstr, len, lazy->start + 1);
+  while (pos < len && jsonstr[pos] != ']' && jsonstr[pos] != '}')
+  {
+    if (type == JSMN_OBJECT)
+    {
+      /* Skip the key and the colon, then the value below. */
+      pos = jlite_lazy_skip_string(jsonstr, len, pos);
+      if (pos < 0)
+      {
+        return -JLITE_ERR;
+      }
+      pos = jlite_lazy_skip_ws(jsonstr, len, pos);
+      if (pos >= len || jsonstr[pos] != ':')
+      {
+        return -JLITE_ERR;
+      }
+      pos = jlite_lazy_skip_ws(jsonstr, len, pos + 1);
+    }
+
+    pos = jlite_lazy_skip_value(jsonstr, len, pos);
+    if (pos < 0)
+    {
+      return -JLITE_ERR;
+    }
+    count++;
+
+    pos = jlite_lazy_skip_ws(jsonstr, len, pos);
+    if (pos < len && jsonstr[pos] == ',')
+    {
+      pos = jlite_lazy_skip_ws(jsonstr, len, pos + 1);
+    }
+  }
+
+  if (pos >= len)
+  {
+    return -JLITE_ERR;
+  }
+
+  *size = count;
+  return JLITE_OK;
+}
+
+int jlite_lazy_to_str_len(const jlitelazy_t *lazy, int *value_len)
+{
+  if (!lazy || !value_len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int end = 0;
+
+  if (jlite_lazy_type(lazy) != JSMN_STRING)
+  {
+    return -JLITE_E_NOT_STRING;
+  }
+
+  end = jlite_lazy_skip_string(lazy->jsonstr, lazy->jsonstr_len, lazy->start);
+  if (end < 0)
+  {
+    return -JLITE_ERR;
+  }
+
+  *value_len = end - lazy->start - 2;
+  return JLITE_OK;
+}
+
+int jlite_lazy_to_str(const jlitelazy_t *lazy, char *value,
+    int max_value_len)
+{
+  if (!lazy || !value || !max_value_len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  int value_len = 0;
+
+  ret = jlite_lazy_to_str_len(lazy, &value_len);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  if (value_len + 1 > max_value_len)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  memcpy(value, lazy->jsonstr + lazy->start + 1, (size_t) value_len);
+  value[value_len] = '\0';
+  return JLITE_OK;
+}
+
+/*
+ * Kind of the primitive under the cursor, classified as the tokenizer does,
+ * with its text in *str and *len.
+ */
+static jsmnkind_t jlite_lazy_primitive_kind(const jlitelazy_t *lazy,
+    const char **str, int *len)
+{
+  int end = 0;
+
+  if (jlite_lazy_type(lazy) != JSMN_PRIMITIVE)
+  {
+    return JSMN_KIND_NONE;
+  }
+
+  end = jlite_lazy_skip_primitive(lazy->jsonstr, lazy->jsonstr_len,
+      lazy->start);
+  *str = lazy->jsonstr + lazy->start;
+  *len = end - lazy->start;
+  return *len > 0 ? jsmn_primitive_kind(*str, (size_t) *len) :
+      JSMN_KIND_OTHER;
+}
+
+/* Floats are truncated, as by jlite_get_value_int(). */
+int jlite_lazy_to_int(const jlitelazy_t *lazy, int *value)
+{
+  if (!lazy || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  int len = 0;
+  const char *str = NULL;
+  int64_t value_int = 0;
+  double value_double = 0;
+
+  switch (jlite_lazy_primitive_kind(lazy, &str, &len))
+  {
+    case JSMN_KIND_INT:
+      ret = jlite_number_to_int64(str, len, &value_int);
+      if (ret != JLITE_OK)
+      {
+        return ret;
+      }
+      if (value_int < INT_MIN || value_int > INT_MAX)
+      {
+        return -JLITE_E_OUT_OF_BOUND;
+      }
+      *value = (int) value_int;
+      return JLITE_OK;
+    case JSMN_KIND_FLOAT:
+      ret = jlite_number_to_double(str, len, &value_double);
+      if (ret != JLITE_OK)
+      {
+        return ret;
+      }
+      if (!(value_double > (double) INT_MIN - 1 &&
+          value_double < (double) INT_MAX + 1))
+      {
+        return -JLITE_E_OUT_OF_BOUND;
+      }
+      *value = (int) value_double;
+      return JLITE_OK;
+    default:
+      return -JLITE_E_NOT_NUMBER;
+  }
+}
+
+int jlite_lazy_to_float(const jlitelazy_t *lazy, float *value)
+{
+  if (!lazy || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  int len = 0;
+  const char *str = NULL;
+  int64_t value_int = 0;
+  double value_double = 0;
+
+  switch (jlite_lazy_primitive_kind(lazy, &str, &len))
+  {
+    case JSMN_KIND_INT:
+      ret = jlite_number_to_int64(str, len, &value_int);
+      value_double = (double) value_int;
+      break;
+    case JSMN_KIND_FLOAT:
+      ret = jlite_number_to_double(str, len, &value_double);
+      break;
+    default:
+      return -JLITE_E_NOT_NUMBER;
+  }
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  *value = (float) value_double;
+  return JLITE_OK;
+}
+
+/* true, false and the integers 1 and 0. */
+int jlite_lazy_to_bool(const jlitelazy_t *lazy, int *value)
+{
+  if (!lazy || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int len = 0;
+  const char *str = NULL;
+
+  switch (jlite_lazy_primitive_kind(lazy, &str, &len))
+  {
+    case JSMN_KIND_TRUE:
+      *value = 1;
+      return JLITE_OK;
+    case JSMN_KIND_FALSE:
+      *value = 0;
+      return JLITE_OK;
+    case JSMN_KIND_INT:
+      if (len == 1 && (str[0] == '0' || str[0] == '1'))
+      {
+        *value = str[0] == '1';
+        return JLITE_OK;
+      }
+      return -JLITE_E_NOT_BOOLEAN;
+    default:
+      return -JLITE_E_NOT_BOOLEAN;
+  }
+}
+
+int jlite_lazy_get_value_str(jlitelazy_t *lazy, const char *key,
+    char *value, int max_value_len)
+{
+  if (!lazy || !key || !value || !max_value_len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jlitelazy_t member;
+
+  ret = jlite_lazy_find(lazy, key, &member);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  return jlite_lazy_to_str(&member, value, max_value_len);
+}
+
+int jlite_lazy_get_value_int(jlitelazy_t *lazy, const char *key, int *value)
+{
+  if (!lazy || !key || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jlitelazy_t member;
+
+  ret = jlite_lazy_find(lazy, key, &member);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  return jlite_lazy_to_int(&member, value);
+}
+
+int jlite_lazy_get_value_float(jlitelazy_t *lazy, const char *key,
+    float *value)
+{
+  if (!lazy || !key || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jlitelazy_t member;
+
+  ret = jlite_lazy_find(lazy, key, &member);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  return jlite_lazy_to_float(&member, value);
+}
+
+int jlite_lazy_get_value_bool(jlitelazy_t *lazy, const char *key,
+    int *value)
+{
+  if (!lazy || !key || !value)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  int ret = 0;
+  jlitelazy_t member;
+
+  ret = jlite_lazy_find(lazy, key, &member);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  return jlite_lazy_to_bool(&member, value);
+}
@@ -0,0 +1,252 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_lazy.h
+ * @brief On-demand APIs which read a JSON document without tokenizing it.
+ *
+ * A lazy cursor scans the raw text forward from its own position and skips
+ * subtrees that are not requested by tracking brackets and quotes, so no
+ * token array is needed and the cost of a lookup is proportional to how far
+ * into the document the requested value is. Skipped text is not validated;
+ * use jlite_parse_init() when the whole document must be checked.
+ *
+ */
+
+#ifndef _JLITE_LAZY_H
+#define _JLITE_LAZY_H
+
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lazy cursor over one JSON value.
+ *
+ * For objects and arrays the cursor also remembers where the previous
+ * lookup stopped, so members read in document order are found without
+ * rescanning from the opening bracket.
+ *
+ */
+
+typedef struct
+{
+  const char *jsonstr;
+  int jsonstr_len;
+  int start;
+  int resume;
+  int resume_index;
+} jlitelazy_t;
+
+/**
+ * @brief Initializes a lazy cursor on the root value of a JSON string.
+ *
+ * @param lazy Pointer to lazy cursor.
+ * @param jsonstr Pointer to JSON string.
+ * @param jsonstr_len Length of JSON string.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_init(jlitelazy_t *lazy, const char *jsonstr, int jsonstr_len);
+
+/**
+ * @brief Get type of the value under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor.
+ *
+ * @return JSMN_OBJECT, JSMN_ARRAY, JSMN_STRING, JSMN_PRIMITIVE or
+ * JSMN_UNDEFINED if the cursor does not point at a value.
+ *
+ */
+
+jsmntype_t jlite_lazy_type(const jlitelazy_t *lazy);
+
+/**
+ * @brief Find a member of a JSON object.
+ *
+ * @param lazy Pointer to lazy cursor on an object.
+ * @param key Name of the member.
+ * @param value Pointer to a lazy cursor which will point at the member value.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_find(jlitelazy_t *lazy, const char *key, jlitelazy_t *value);
+
+/**
+ * @brief Get an element of a JSON array based on position.
+ *
+ * @param lazy Pointer to lazy cursor on an array.
+ * @param element_pos Position of the element.
+ * @param value Pointer to a lazy cursor which will point at the element.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_element(jlitelazy_t *lazy, int element_pos,
+    jlitelazy_t *value);
+
+/**
+ * @brief Get number of elements of a JSON array or members of an object.
+ *
+ * This scans the whole container.
+ *
+ * @param lazy Pointer to lazy cursor on an array or object.
+ * @param size Pointer to an int variable to get the size.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_size(jlitelazy_t *lazy, int *size);
+
+/**
+ * @brief Get JSON string value under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor on a string.
+ * @param value Pointer to a char array.
+ * @param max_value_len Max length of char array.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_to_str(const jlitelazy_t *lazy, char *value,
+    int max_value_len);
+
+/**
+ * @brief Get JSON string length under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor on a string.
+ * @param value_len Pointer to an int variable to get the length.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_to_str_len(const jlitelazy_t *lazy, int *value_len);
+
+/**
+ * @brief Get JSON int value under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor on a number.
+ * @param value Pointer to an int variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_to_int(const jlitelazy_t *lazy, int *value);
+
+/**
+ * @brief Get JSON float value under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor on a number.
+ * @param value Pointer to a float variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_to_float(const jlitelazy_t *lazy, float *value);
+
+/**
+ * @brief Get JSON boolean value under a lazy cursor.
+ *
+ * @param lazy Pointer to lazy cursor on a boolean.
+ * @param value Pointer to an int variable which will store boolean value.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_to_bool(const jlitelazy_t *lazy, int *value);
+
+/**
+ * @brief Get JSON string element value of the given key.
+ *
+ * @param lazy Pointer to lazy cursor on an object.
+ * @param key Name of JSON string element.
+ * @param value Pointer to a char array.
+ * @param max_value_len Max length of char array.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_get_value_str(jlitelazy_t *lazy, const char *key,
+    char *value, int max_value_len);
+
+/**
+ * @brief Get JSON int element value of the given key.
+ *
+ * @param lazy Pointer to lazy cursor on an object.
+ * @param key Name of JSON int element.
+ * @param value Pointer to an int variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_get_value_int(jlitelazy_t *lazy, const char *key, int *value);
+
+/**
+ * @brief Get JSON float element value of the given key.
+ *
+ * @param lazy Pointer to lazy cursor on an object.
+ * @param key Name of JSON float element.
+ * @param value Pointer to a float variable.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_get_value_float(jlitelazy_t *lazy, const char *key,
+    float *value);
+
+/**
+ * @brief Get JSON boolean element value of the given key.
+ *
+ * @param lazy Pointer to lazy cursor on an object.
+ * @param key Name of JSON boolean element.
+ * @param value Pointer to an int variable which will store boolean value.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_lazy_get_value_bool(jlitelazy_t *lazy, const char *key,
+    int *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_LAZY_H */
@@ -0,0 +1,234 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_minify.c
+ * @brief This file contains the whitespace stripping API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_minify.h"
+#include "jlite_validate.h"
+#include "jlite_simd.h"
+
+#define JLITE_MINIFY_BLOCK 64
+#define JLITE_MINIFY_EVEN_BITS 0x5555555555555555ULL
+
+/* Bit i of each mask describes byte i of a 64 byte block. */
+typedef struct
+{
+  uint64_t quote;
+  uint64_t bslash;
+  uint64_t ws;
+} jlite_minify_masks_t;
+
+static inline void jlite_minify_classify(const char *block,
+    jlite_minify_masks_t *masks)
+{
+#ifdef JLITE_SIMD_SSE2
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i bslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  __m128i chunk;
+  int i = 0;
+
+  masks->quote = masks->bslash = masks->ws = 0;
+  for (i = 0; i < JLITE_MINIFY_BLOCK; i += 16)
+  {
+    chunk = _mm_loadu_si128((const __m128i *) (block + i));
+    masks->quote |= (uint64_t) (unsigned int) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(chunk, quote)) << i;
+    masks->bslash |= (uint64_t) (unsigned int) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(chunk, bslash)) << i;
+    masks->ws |= (uint64_t) (unsigned int) _mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr))))
+        << i;
+  }
+#else
+  uint64_t word = 0;
+  int i = 0;
+
+  masks->quote = masks->bslash = masks->ws = 0;
+  for (i = 0; i < JLITE_MINIFY_BLOCK; i += 8)
+  {
+    word = jlite_swar_load(block + i);
+    masks->quote |= (uint64_t) jlite_swar_movemask(
+        jlite_swar_eq(word, '"')) << i;
+    masks->bslash |= (uint64_t) jlite_swar_movemask(
+        jlite_swar_eq(word, '\\')) << i;
+    masks->ws |= (uint64_t) jlite_swar_movemask(jlite_swar_eq(word, ' ') |
+        jlite_swar_eq(word, '\t') | jlite_swar_eq(word, '\n') |
+        jlite_swar_eq(word, '\r')) << i;
+  }
+#endif
+}
+
+/*
+ * Return the mask of characters escaped by a backslash. Runs of
+ * backslashes escape every other character; *carry tells whether the first
+ * byte of the next block is escaped.
+ */
+static inline uint64_t jlite_minify_escaped(uint64_t bslash, uint64_t *carry)
+{
+  uint64_t follows = 0;
+  uint64_t odd_starts = 0;
+  uint64_t even_starts = 0;
+
+  bslash &= ~*carry;
+  follows = bslash << 1 | *carry;
+  odd_starts = bslash & ~JLITE_MINIFY_EVEN_BITS & ~follows;
+  even_starts = odd_starts + bslash;
+  *carry = even_starts < bslash;
+  return (JLITE_MINIFY_EVEN_BITS ^ (even_starts << 1)) & follows;
+}
+
+/* Bit i is the XOR of bits 0..i, marking the inside of strings. */
+static inline uint64_t jlite_minify_prefix_xor(uint64_t bits)
+{
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+/*
+ * Append the bytes of a full block selected by keep to out at o and return
+ * the new output position. Runs of kept bytes are copied 8 bytes at a time
+ * from a private copy of the block, so stores may run past the end of a
+ * run; they are kept below the end of the block, which the output never
+ * overtakes, and that keeps in-place operation safe.
+ */
+static inline int jlite_minify_block(const char *block, uint64_t keep,
+    char *out, int o)
+{
+  char copy[JLITE_MINIFY_BLOCK];
+  uint64_t word = 0;
+  uint64_t rest = 0;
+  int start = 0;
+  int run = 0;
+  int i = 0;
+
+  memcpy(copy, block, sizeof(copy));
+  while (keep)
+  {
+    start = __builtin_ctzll(keep);
+    /* Adding the lowest set bit clears the lowest run of ones. */
+    rest = keep & (keep + (keep & (0 - keep)));
+    run = __builtin_popcountll(keep ^ rest);
+    keep = rest;
+
+    if (start + ((run + 7) & ~7) <= JLITE_MINIFY_BLOCK)
+    {
+      for (i = 0; i < run; i += 8)
+      {
+        word = jlite_swar_load(copy + start + i);
+        memcpy(out + o + i, &word, sizeof(word));
+      }
+    }
+    else
+    {
+      memcpy(out + o, copy + start, (size_t) run);
+    }
+    o += run;
+  }
+  return o;
+}
+
+int jlite_minify(const char *jsonstr, int jsonstr_len, char *out,
+    int *out_len, int flags)
+{
+  if (!jsonstr || jsonstr_len <= 0 || !out || !out_len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  if (flags & JLITE_MINIFY_VALIDATE)
+  {
+    return jlite_validate_minify(jsonstr, jsonstr_len, out, out_len, NULL);
+  }
+
+  jlite_minify_masks_t masks;
+  char tail[JLITE_MINIFY_BLOCK];
+  const char *block = NULL;
+  uint64_t escape_carry = 0;
+  uint64_t string_carry = 0;
+  uint64_t strings = 0;
+  uint64_t keep = 0;
+  int pos = 0;
+  int len = 0;
+  int o = 0;
+  int i = 0;
+
+  for (pos = 0; pos < jsonstr_len; pos += JLITE_MINIFY_BLOCK)
+  {
+    block = jsonstr + pos;
+    len = jsonstr_len - pos;
+    if (len < JLITE_MINIFY_BLOCK)
+    {
+      memset(tail, 0, sizeof(tail));
+      memcpy(tail, block, (size_t) len);
+      block = tail;
+    }
+    else
+    {
+      len = JLITE_MINIFY_BLOCK;
+    }
+
+    jlite_minify_classify(block, &masks);
+    strings = jlite_minify_prefix_xor(masks.quote &
+        ~jlite_minify_escaped(masks.bslash, &escape_carry)) ^ string_carry;
+    string_carry = (uint64_t) ((int64_t) strings >> 63);
+    keep = ~(masks.ws & ~strings);
+
+    if (keep == ~0ULL && len == JLITE_MINIFY_BLOCK)
+    {
+      memmove(out + o, block, JLITE_MINIFY_BLOCK);
+      o += JLITE_MINIFY_BLOCK;
+      continue;
+    }
+
+    if (len < JLITE_MINIFY_BLOCK)
+    {
+      for (i = 0; i < len; i++)
+      {
+        out[o] = block[i];
+        o += (int) ((keep >> i) & 1);
+      }
+      continue;
+    }
+
+    o = jlite_minify_block(block, keep, out, o);
+  }
+
+  *out_len = o;
+  return JLITE_OK;
+}
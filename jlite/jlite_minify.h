@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_minify.h
+ * @brief Whitespace stripping for JSON strings.
+ *
+ */
+
+#ifndef _JLITE_MINIFY_H
+#define _JLITE_MINIFY_H
+
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Validate while minifying, see jlite_validate_minify(). */
+#define JLITE_MINIFY_VALIDATE 0x1
+
+/**
+ * @brief Remove whitespace outside strings from a JSON string.
+ *
+ * Without flags the input is assumed to be well formed and is processed
+ * 64 bytes at a time: quotes, backslashes and whitespace are classified
+ * with SIMD compares, escaped quotes are removed and string interiors are
+ * masked with a prefix XOR before whitespace is dropped. Malformed input is
+ * copied without error, minus its whitespace outside what look like
+ * strings. With JLITE_MINIFY_VALIDATE the output is guaranteed to be valid
+ * JSON, at the speed of jlite_validate().
+ *
+ * @param jsonstr Pointer to JSON string.
+ * @param jsonstr_len Length of JSON string.
+ * @param out Output buffer of at least jsonstr_len bytes. It may be
+ * jsonstr itself for in-place operation. It is not NUL terminated.
+ * @param out_len Pointer to an int variable to get the output length.
+ * @param flags 0 or JLITE_MINIFY_VALIDATE.
+ *
+ * @return errcode, validation errors as for jlite_validate()
+ *
+ */
+
+int jlite_minify(const char *jsonstr, int jsonstr_len, char *out,
+    int *out_len, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_MINIFY_H */
@@ -0,0 +1,878 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_msgpack.c
+ * @brief This file contains the MessagePack transcoder API definition.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jlite_msgpack.h"
+
+typedef struct
+{
+  uint8_t *buf;
+  size_t len;
+  size_t max_len;
+} jlite_mp_out_t;
+
+typedef struct
+{
+  char *text;
+  int len;
+  int max_len;
+} jlite_mp_text_t;
+
+typedef struct
+{
+  int tok;
+  int key;
+  uint32_t items;
+  uint32_t remaining;
+} jlite_mp_frame_t;
+
+/* Encoding */
+
+static int jlite_mp_put(jlite_mp_out_t *out, uint8_t op, uint64_t value,
+    int bytes)
+{
+  if (out->max_len - out->len < (size_t) bytes + 1)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  out->buf[out->len++] = op;
+  while (bytes--)
+  {
+    out->buf[out->len++] = (uint8_t) (value >> (8 * bytes));
+  }
+  return JLITE_OK;
+}
+
+/* Header of a str, array or map: fix form below fix_limit, else 8/16/32. */
+static int jlite_mp_header(jlite_mp_out_t *out, uint8_t fix,
+    uint32_t fix_limit, uint8_t op8, uint8_t op16, uint32_t n)
+{
+  if (n < fix_limit)
+  {
+    return jlite_mp_put(out, (uint8_t) (fix | n), 0, 0);
+  }
+  if (op8 && n <= 0xff)
+  {
+    return jlite_mp_put(out, op8, n, 1);
+  }
+  if (n <= 0xffff)
+  {
+    return jlite_mp_put(out, op16, n, 2);
+  }
+  return jlite_mp_put(out, (uint8_t) (op16 + 1), n, 4);
+}
+
+static int jlite_mp_put_int(jlite_mp_out_t *out, int64_t value)
+{
+  if (value >= 0)
+  {
+    if (value < 0x80)
+    {
+      return jlite_mp_put(out, (uint8_t) value, 0, 0);
+    }
+    if (value <= 0xff)
+    {
+      return jlite_mp_put(out, 0xcc, (uint64_t) value, 1);
+    }
+    if (value <= 0xffff)
+    {
+      return jlite_mp_put(out, 0xcd, (uint64_t) value, 2);
+    }
+    if (value <= 0xffffffffLL)
+    {
+      return jlite_mp_put(out, 0xce, (uint64_t) value, 4);
+    }
+    return jlite_mp_put(out, 0xcf, (uint64_t) value, 8);
+  }
+  if (value >= -32)
+  {
+    return jlite_mp_put(out, (uint8_t) value, 0, 0);
+  }
+  if (value >= INT8_MIN)
+  {
+    return jlite_mp_put(out, 0xd0, (uint8_t) value, 1);
+  }
+  if (value >= INT16_MIN)
+  {
+    return jlite_mp_put(out, 0xd1, (uint16_t) value, 2);
+  }
+  if (value >= INT32_MIN)
+  {
+    return jlite_mp_put(out, 0xd2, (uint32_t) value, 4);
+  }
+  return jlite_mp_put(out, 0xd3, (uint64_t) value, 8);
+}
+
+static int jlite_mp_put_double(jlite_mp_out_t *out, double value)
+{
+  uint64_t bits = 0;
+
+  memcpy(&bits, &value, sizeof(bits));
+  return jlite_mp_put(out, 0xcb, bits, 8);
+}
+
+static int jlite_mp_hex4(const char *str, uint32_t *cp)
+{
+  int i = 0;
+
+  *cp = 0;
+  for (i = 0; i < 4; i++)
+  {
+    *cp <<= 4;
+    if (str[i] >= '0' && str[i] <= '9')
+    {
+      *cp |= (uint32_t) (str[i] - '0');
+    }
+    else if ((str[i] | 0x20) >= 'a' && (str[i] | 0x20) <= 'f')
+    {
+      *cp |= (uint32_t) ((str[i] | 0x20) - 'a' + 10);
+    }
+    else
+    {
+      return -JLITE_E_INVALID_JSON;
+    }
+  }
+  return JLITE_OK;
+}
+
+/*
+ * Unescape the raw JSON string str into dst, or only count its length if
+ * dst is NULL. \u escapes become UTF-8, surrogate pairs are combined.
+ */
+static int jlite_mp_unescape(const char *str, int len, uint8_t *dst,
+    size_t *dst_len)
+{
+  const char *end = str + len;
+  const char *esc = NULL;
+  size_t n = 0;
+  uint32_t cp = 0;
+  uint32_t low = 0;
+  uint8_t ch = 0;
+
+  while (str < end)
+  {
+    esc = memchr(str, '\\', (size_t) (end - str));
+    if (!esc)
+    {
+      esc = end;
+    }
+    if (dst)
+    {
+      memcpy(dst + n, str, (size_t) (esc - str));
+    }
+    n += (size_t) (esc - str);
+    str = esc;
+    if (str == end)
+    {
+      break;
+    }
+    if (end - str < 2)
+    {
+      return -JLITE_E_INVALID_JSON;
+    }
+
+    switch (str[1])
+    {
+      case '"': ch = '"'; break;
+      case '\\': ch = '\\'; break;
+      case '/': ch = '/'; break;
+      case 'b': ch = '\b'; break;
+      case 'f': ch = '\f'; break;
+      case 'n': ch = '\n'; break;
+      case 'r': ch = '\r'; break;
+      case 't': ch = '\t'; break;
+      case 'u':
+        if (end - str < 6 || jlite_mp_hex4(str + 2, &cp) != JLITE_OK)
+        {
+          return -JLITE_E_INVALID_JSON;
+        }
+        str += 6;
+        if (cp >= 0xd800 && cp <= 0xdbff && end - str >= 6 &&
+            str[0] == '\\' && str[1] == 'u' &&
+            jlite_mp_hex4(str + 2, &low) == JLITE_OK &&
+            low >= 0xdc00 && low <= 0xdfff)
+        {
+          cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+          str += 6;
+        }
+        if (dst)
+        {
+          if (cp < 0x80)
+          {
+            dst[n] = (uint8_t) cp;
+          }
+          else if (cp < 0x800)
+          {
+            dst[n] = (uint8_t) (0xc0 | (cp >> 6));
+            dst[n + 1] = (uint8_t) (0x80 | (cp & 0x3f));
+          }
+          else if (cp < 0x10000)
+          {
+            dst[n] = (uint8_t) (0xe0 | (cp >> 12));
+            dst[n + 1] = (uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+            dst[n + 2] = (uint8_t) (0x80 | (cp & 0x3f));
+          }
+          else
+          {
+            dst[n] = (uint8_t) (0xf0 | (cp >> 18));
+            dst[n + 1] = (uint8_t) (0x80 | ((cp >> 12) & 0x3f));
+            dst[n + 2] = (uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+            dst[n + 3] = (uint8_t) (0x80 | (cp & 0x3f));
+          }
+        }
+        n += cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+        continue;
+      default:
+        return -JLITE_E_INVALID_JSON;
+    }
+    if (dst)
+    {
+      dst[n] = ch;
+    }
+    n++;
+    str += 2;
+  }
+
+  *dst_len = n;
+  return JLITE_OK;
+}
+
+static int jlite_mp_put_str(jlite_mp_out_t *out, const char *str, int len)
+{
+  size_t n = (size_t) len;
+  int escaped = memchr(str, '\\', (size_t) len) != NULL;
+  int ret = 0;
+
+  if (escaped)
+  {
+    ret = jlite_mp_unescape(str, len, NULL, &n);
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+  if (n > 0xffffffffULL)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  ret = jlite_mp_header(out, 0xa0, 32, 0xd9, 0xda, (uint32_t) n);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+  if (out->max_len - out->len < n)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  if (escaped)
+  {
+    jlite_mp_unescape(str, len, out->buf + out->len, &n);
+  }
+  else
+  {
+    memcpy(out->buf + out->len, str, n);
+  }
+  out->len += n;
+  return JLITE_OK;
+}
+
+/* By kind, so bare words of lenient builds are not taken for literals. */
+static int jlite_mp_put_primitive(jlite_mp_out_t *out, const char *jsonstr,
+    const jlitetok_t *tok)
+{
+  const char *str = jsonstr + tok->start;
+  int len = tok->end - tok->start;
+  jsmnkind_t kind = (jsmnkind_t) tok->kind;
+  int64_t value_int = 0;
+  double value = 0;
+
+  if (kind == JSMN_KIND_NONE)
+  {
+    kind = jsmn_primitive_kind(str, (size_t) len);
+  }
+
+  switch (kind)
+  {
+    case JSMN_KIND_TRUE:
+      return jlite_mp_put(out, 0xc3, 0, 0);
+    case JSMN_KIND_FALSE:
+      return jlite_mp_put(out, 0xc2, 0, 0);
+    case JSMN_KIND_NULL:
+      return jlite_mp_put(out, 0xc0, 0, 0);
+    case JSMN_KIND_INT:
+      if (jlite_number_to_int64(str, len, &value_int) == JLITE_OK)
+      {
+        return jlite_mp_put_int(out, value_int);
+      }
+      break;
+    case JSMN_KIND_FLOAT:
+      break;
+    default:
+      return -JLITE_E_NOT_SUPPORTED;
+  }
+  if (jlite_number_to_double(str, len, &value) == JLITE_OK)
+  {
+    return jlite_mp_put_double(out, value);
+  }
+  return -JLITE_E_NOT_NUMBER;
+}
+
+int jlite_msgpack_encode(jliteobj_t *jsonobj, uint8_t *buf, size_t max_len,
+    size_t *len)
+{
+  if (!jsonobj || !jsonobj->tokens || !buf || !len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  const char *jsonstr = jsonobj->jsonstr;
+  jlite_mp_out_t out;
+  int pending = 1;
+  int pos = jsonobj->cur_pos - 1;
+  int ret = JLITE_OK;
+
+  out.buf = buf;
+  out.len = 0;
+  out.max_len = max_len;
+
+  /*
+   * Tokens are in document order and carry their element counts, which is
+   * exactly what MessagePack headers need, so each token is encoded on its
+   * own.
+   */
+  while (pending && ret == JLITE_OK)
+  {
+    switch (tokens[pos].type)
+    {
+      case JSMN_OBJECT:
+        ret = jlite_mp_header(&out, 0x80, 16, 0, 0xde,
+            (uint32_t) tokens[pos].size);
+        break;
+      case JSMN_ARRAY:
+        ret = jlite_mp_header(&out, 0x90, 16, 0, 0xdc,
+            (uint32_t) tokens[pos].size);
+        break;
+      case JSMN_STRING:
+        ret = jlite_mp_put_str(&out, jsonstr + tokens[pos].start,
+            tokens[pos].end - tokens[pos].start);
+        break;
+      default:
+        ret = jlite_mp_put_primitive(&out, jsonstr, &tokens[pos]);
+        break;
+    }
+    pending += tokens[pos].size - 1;
+    pos++;
+  }
+
+  *len = out.len;
+  return ret;
+}
+
+/* Decoding */
+
+/* Literals are written once after the input copy, shared by their tokens. */
+static const char jlite_mp_literals[] = "nullfalsetrue";
+
+#define JLITE_MP_NULL 0
+#define JLITE_MP_FALSE 4
+#define JLITE_MP_TRUE 9
+
+static const double jlite_mp_pow10[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+  1e13, 1e14, 1e15, 1e16, 1e17
+};
+
+static int jlite_mp_emit(jlite_mp_text_t *t, const char *str, int len)
+{
+  if (t->max_len - t->len < len)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  memcpy(t->text + t->len, str, (size_t) len);
+  t->len += len;
+  return JLITE_OK;
+}
+
+/*
+ * Decimal digits of value with a point before the last frac of them,
+ * e.g. 9419 and 2 give "94.19". The digits are counted first and written
+ * backwards in place, two at a time.
+ */
+static int jlite_mp_emit_decimal(jlite_mp_text_t *t, uint64_t value,
+    int frac, int negative)
+{
+  static const char pairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233"
+      "34353637383940414243444546474849505152535455565758596061626364656667"
+      "6869707172737475767778798081828384858687888990919293949596979899";
+  uint64_t limit = 10;
+  char *out = NULL;
+  int digits = 1;
+  int len = 0;
+  int r = 0;
+
+  while (digits < 20 && value >= limit)
+  {
+    digits++;
+    limit *= 10;
+  }
+  if (digits <= frac)
+  {
+    digits = frac + 1;
+  }
+  len = negative + digits + (frac ? 1 : 0);
+  if (t->max_len - t->len < len)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  out = t->text + t->len + len;
+  t->len += len;
+  if (frac)
+  {
+    /* Fraction digits one by one, the point goes between them. */
+    while (frac--)
+    {
+      *--out = (char) ('0' + value % 10);
+      value /= 10;
+    }
+    *--out = '.';
+  }
+  while (value >= 100)
+  {
+    r = (int) (value % 100) * 2;
+    value /= 100;
+    *--out = pairs[r + 1];
+    *--out = pairs[r];
+  }
+  if (value >= 10)
+  {
+    r = (int) value * 2;
+    *--out = pairs[r + 1];
+    *--out = pairs[r];
+  }
+  else
+  {
+    *--out = (char) ('0' + value);
+  }
+  if (negative)
+  {
+    *--out = '-';
+  }
+  return JLITE_OK;
+}
+
+static int jlite_mp_emit_int(jlite_mp_text_t *t, int64_t value)
+{
+  if (value < 0)
+  {
+    return jlite_mp_emit_decimal(t, 0 - (uint64_t) value, 0, 1);
+  }
+  return jlite_mp_emit_decimal(t, (uint64_t) value, 0, 0);
+}
+
+/* m = round(value * 10^k) if m / 10^k reads back exactly as value, else 0. */
+static double jlite_mp_fixed(double value, int k)
+{
+  double scaled = value * jlite_mp_pow10[k];
+  double m = 0;
+
+  if (scaled >= 9007199254740991.5)
+  {
+    return 0;
+  }
+  /* Round to integer: below 2^52 adding 2^52 drops the fraction. */
+  m = scaled < 4503599627370496.0 ?
+      (scaled + 4503599627370496.0) - 4503599627370496.0 : scaled;
+  return m / jlite_mp_pow10[k] == value ? m : 0;
+}
+
+#ifdef __SIZEOF_INT128__
+/*
+ * Exact round(value * 10^k) for 1 <= value < 2^53: value is f * 2^e with an
+ * integer f, so the product is computed on integers without rounding error.
+ */
+static uint64_t jlite_mp_fixed_exact(double value, int k)
+{
+  static const uint64_t pow10[] =
+  {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL
+  };
+  unsigned __int128 product = 0;
+  uint64_t bits = 0;
+  uint64_t f = 0;
+  int shift = 0;
+
+  memcpy(&bits, &value, sizeof(bits));
+  f = (bits & ((1ULL << 52) - 1)) | (1ULL << 52);
+  shift = 1075 - (int) ((bits >> 52) & 0x7ff);
+  product = (unsigned __int128) f * pow10[k];
+  if (shift <= 0)
+  {
+    return (uint64_t) (product << -shift);
+  }
+  return (uint64_t) ((product + ((unsigned __int128) 1 << (shift - 1))) >>
+      shift);
+}
+#endif
+
+/*
+ * Shortest fixed-point text which reads back to the same double. With
+ * m below 2^53 and k at most 17, m and 10^k are exact operands, so
+ * m / 10^k is correctly rounded like the reader's own conversion. A k that
+ * works keeps working for larger k, so the smallest is found by bisection
+ * below the largest k the digits allow. Values which came from JSON stop at
+ * their original digits. Values needing 17 significant digits, which always
+ * read back, are rounded exactly; the rest go through snprintf().
+ */
+static int jlite_mp_emit_double(jlite_mp_text_t *t, double value)
+{
+  char buffer[32];
+  double abs_value = fabs(value);
+  double found = 0;
+  double m = 0;
+  int int_digits = 1;
+  int lo = 0;
+  int hi = 0;
+  int k = 0;
+
+  if (!isfinite(value))
+  {
+    return jlite_mp_emit(t, jlite_mp_literals + JLITE_MP_NULL, 4);
+  }
+  if (abs_value >= 1e-5 && abs_value < 1e15)
+  {
+    while (int_digits < 16 && abs_value >= jlite_mp_pow10[int_digits])
+    {
+      int_digits++;
+    }
+    /* 16 significant digits, fewer if that does not fit 2^53. */
+    hi = 16 - int_digits;
+    if (abs_value * jlite_mp_pow10[hi] >= 9007199254740991.5 && hi > 0)
+    {
+      hi--;
+    }
+    m = jlite_mp_fixed(abs_value, hi);
+    if (m != 0)
+    {
+      while (lo < hi)
+      {
+        k = (lo + hi) / 2;
+        found = jlite_mp_fixed(abs_value, k);
+        if (found != 0)
+        {
+          hi = k;
+          m = found;
+        }
+        else
+        {
+          lo = k + 1;
+        }
+      }
+      return jlite_mp_emit_decimal(t, (uint64_t) m, hi, value < 0);
+    }
+#ifdef __SIZEOF_INT128__
+    if (abs_value >= 1)
+    {
+      return jlite_mp_emit_decimal(t,
+          jlite_mp_fixed_exact(abs_value, 17 - int_digits), 17 - int_digits,
+          value < 0);
+    }
+#endif
+  }
+  return jlite_mp_emit(t, buffer,
+      snprintf(buffer, sizeof(buffer), "%.17g", value));
+}
+
+static uint64_t jlite_mp_get(const uint8_t *p, int bytes)
+{
+  uint64_t value = 0;
+
+  while (bytes--)
+  {
+    value = (value << 8) | *p++;
+  }
+  return value;
+}
+
+int jlite_msgpack_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, const uint8_t *buf, size_t len, char *text,
+    int max_text_len)
+{
+  if (!jsonobj || !tokens || !num_tokens || !buf || !len || !text ||
+      max_text_len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_mp_frame_t stack[JLITE_MSGPACK_MAX_DEPTH];
+  jlite_mp_frame_t *top = NULL;
+  const uint8_t *p = buf;
+  const uint8_t *end = buf + len;
+  jlite_mp_text_t t;
+  jlitetok_t *tok = NULL;
+  uint64_t value = 0;
+  uint32_t n = 0;
+  uint8_t op = 0;
+  float value_float = 0;
+  double value_double = 0;
+  int literals = 0;
+  int is_key = 0;
+  int depth = 0;
+  int count = 0;
+  int bytes = 0;
+  int ret = JLITE_OK;
+
+  /*
+   * Strings and containers keep their place in a copy of the input, so
+   * string bodies need no work. Literals and numbers are written as text
+   * after it, which puts their offsets out of document order.
+   */
+  if ((size_t) max_text_len < len + sizeof(jlite_mp_literals) - 1)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  memcpy(text, buf, len);
+  literals = (int) len;
+  memcpy(text + literals, jlite_mp_literals, sizeof(jlite_mp_literals) - 1);
+  t.text = text;
+  t.len = literals + (int) sizeof(jlite_mp_literals) - 1;
+  t.max_len = max_text_len;
+
+/* Fail unless n more input bytes are available. */
+#define JLITE_MP_NEED(n) \
+  do \
+  { \
+    if ((size_t) (end - p) < (size_t) (n)) \
+    { \
+      return -JLITE_E_INVALID_JSON; \
+    } \
+  } while (0)
+
+  do
+  {
+    /* Close finished containers, then place the next item in its parent. */
+    while (depth && stack[depth - 1].remaining == 0)
+    {
+      depth--;
+      tokens[stack[depth].tok].end = (int) (p - buf);
+    }
+    if (!depth && count)
+    {
+      break;
+    }
+
+    if (count == num_tokens)
+    {
+      return -JLITE_E_NO_BUFFER_MEM;
+    }
+    tok = &tokens[count];
+    tok->parent = -1;
+    is_key = 0;
+    if (depth)
+    {
+      top = &stack[depth - 1];
+      if (tokens[top->tok].type != JSMN_OBJECT)
+      {
+        tok->parent = top->tok;
+      }
+      else if (top->remaining % 2 == 0)
+      {
+        is_key = 1;
+        tok->parent = top->tok;
+        top->key = count;
+      }
+      else
+      {
+        tok->parent = top->key;
+      }
+      top->remaining--;
+    }
+
+    JLITE_MP_NEED(1);
+    op = *p++;
+    tok->type = JSMN_PRIMITIVE;
+    tok->kind = JSMN_KIND_NONE;
+    tok->size = is_key;
+    tok->start = t.len;
+    bytes = 0;
+
+    if (op <= 0x7f || op >= 0xe0)
+    {
+      ret = jlite_mp_emit_int(&t, (int8_t) op);
+      tok->end = t.len;
+    }
+    else if (op <= 0x9f || (op >= 0xdc && op <= 0xdf))
+    {
+      /* Containers: fix forms, then 16 and 32 bit counts. */
+      if (op <= 0x9f)
+      {
+        n = op & 0x0f;
+      }
+      else
+      {
+        bytes = op & 1 ? 4 : 2;
+        JLITE_MP_NEED(bytes);
+        n = (uint32_t) jlite_mp_get(p, bytes);
+        p += bytes;
+      }
+      if (n > 0x7fffffff)
+      {
+        return -JLITE_E_INVALID_JSON;
+      }
+      if (depth == JLITE_MSGPACK_MAX_DEPTH)
+      {
+        return -JLITE_E_NO_BUFFER_MEM;
+      }
+      tok->type = op <= 0x8f || op >= 0xde ? JSMN_OBJECT : JSMN_ARRAY;
+      tok->size = (int) n;
+      tok->start = (int) (p - buf) - bytes - 1;
+      stack[depth].tok = count;
+      stack[depth].key = -1;
+      stack[depth].remaining = tok->type == JSMN_OBJECT ? n * 2 : n;
+      depth++;
+    }
+    else if (op <= 0xbf || (op >= 0xd9 && op <= 0xdb))
+    {
+      if (op <= 0xbf)
+      {
+        n = op & 0x1f;
+      }
+      else
+      {
+        bytes = 1 << (op - 0xd9);
+        JLITE_MP_NEED(bytes);
+        n = (uint32_t) jlite_mp_get(p, bytes);
+        p += bytes;
+      }
+      JLITE_MP_NEED(n);
+      tok->type = JSMN_STRING;
+      tok->start = (int) (p - buf);
+      tok->end = tok->start + (int) n;
+      p += n;
+    }
+    else
+    {
+      switch (op)
+      {
+        case 0xc0:
+          tok->start = literals + JLITE_MP_NULL;
+          tok->end = tok->start + 4;
+          break;
+        case 0xc2:
+          tok->start = literals + JLITE_MP_FALSE;
+          tok->end = tok->start + 5;
+          break;
+        case 0xc3:
+          tok->start = literals + JLITE_MP_TRUE;
+          tok->end = tok->start + 4;
+          break;
+        case 0xca:
+          JLITE_MP_NEED(4);
+          n = (uint32_t) jlite_mp_get(p, 4);
+          p += 4;
+          memcpy(&value_float, &n, sizeof(value_float));
+          ret = jlite_mp_emit_double(&t, value_float);
+          break;
+        case 0xcb:
+          JLITE_MP_NEED(8);
+          value = jlite_mp_get(p, 8);
+          p += 8;
+          memcpy(&value_double, &value, sizeof(value_double));
+          ret = jlite_mp_emit_double(&t, value_double);
+          break;
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+          bytes = 1 << (op - 0xcc);
+          JLITE_MP_NEED(bytes);
+          ret = jlite_mp_emit_decimal(&t, jlite_mp_get(p, bytes), 0, 0);
+          p += bytes;
+          break;
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3:
+          bytes = 1 << (op - 0xd0);
+          JLITE_MP_NEED(bytes);
+          value = jlite_mp_get(p, bytes);
+          p += bytes;
+          /* Sign-extend from the encoded width. */
+          if (bytes < 8 && (value >> (8 * bytes - 1)))
+          {
+            value |= ~0ULL << (8 * bytes);
+          }
+          ret = jlite_mp_emit_int(&t, (int64_t) value);
+          break;
+        case 0xc1:
+          return -JLITE_E_INVALID_JSON;
+        default:
+          /* bin, ext and fixext */
+          return -JLITE_E_NOT_SUPPORTED;
+      }
+      if (op >= 0xca)
+      {
+        tok->end = t.len;
+      }
+    }
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+    if (tok->type == JSMN_PRIMITIVE)
+    {
+      tok->kind = (unsigned char) jsmn_primitive_kind(text + tok->start,
+          (size_t) (tok->end - tok->start));
+    }
+    if (is_key && tok->type != JSMN_STRING)
+    {
+      return -JLITE_E_NOT_SUPPORTED;
+    }
+    count++;
+  } while (depth);
+
+#undef JLITE_MP_NEED
+
+  if (p != end)
+  {
+    return -JLITE_E_INVALID_JSON;
+  }
+
+  memset(jsonobj, 0, sizeof(*jsonobj));
+  jsonobj->jsonstr = text;
+  jsonobj->jsonstr_len = t.len;
+  jsonobj->tokens = tokens;
+  jsonobj->num_tokens = count;
+  jsonobj->cur_pos = 1;
+  return JLITE_OK;
+}
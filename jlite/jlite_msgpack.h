@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_msgpack.h
+ * @brief MessagePack transcoding to and from the token array.
+ *
+ */
+
+#ifndef _JLITE_MSGPACK_H
+#define _JLITE_MSGPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum container nesting jlite_msgpack_parse_init() accepts. */
+#ifndef JLITE_MSGPACK_MAX_DEPTH
+#define JLITE_MSGPACK_MAX_DEPTH 1024
+#endif
+
+/**
+ * @brief Encode the current JSON value as MessagePack.
+ *
+ * The current object or array of jsonobj, the whole document right after
+ * jlite_parse_init(), is encoded by one walk over its tokens. Integers
+ * which fit int64 use the smallest integer format, other numbers float64.
+ * Strings are unescaped once, here, so a reader never sees JSON escapes.
+ * Primitives are encoded by kind; bare words a lenient build accepts are
+ * not true, false or null and fail with JLITE_E_NOT_SUPPORTED.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param buf Buffer for the MessagePack bytes.
+ * @param max_len Size of buf.
+ * @param len Pointer to a size_t variable to get the encoded length.
+ *
+ * @return errcode, JLITE_E_INVALID_JSON for a malformed string escape,
+ * JLITE_E_NOT_SUPPORTED for a bare word.
+ *
+ */
+
+int jlite_msgpack_encode(jliteobj_t *jsonobj, uint8_t *buf, size_t max_len,
+    size_t *len);
+
+/**
+ * @brief Initialize JSON object from a MessagePack buffer.
+ *
+ * Equivalent of jlite_parse_init() for MessagePack: afterwards the getter
+ * APIs work on jsonobj. No byte is scanned to find the end of a value, the
+ * lengths come from the MessagePack headers, which makes this much cheaper
+ * than parsing the JSON form. Binary, extension types and non-string map
+ * keys are not supported.
+ *
+ * jsonobj->jsonstr is text, which is not JSON: it holds a copy of buf,
+ * followed by the literals null, false and true and then the decimal text
+ * of every number. String tokens cover the string bodies inside the copy,
+ * container tokens their MessagePack bytes, and primitive tokens the text
+ * appended after it, so token offsets are not in document order. Strings
+ * and keys come back unescaped, as the encoder stored them: a key written
+ * a\"b in JSON is found by the key a"b here, and string getters return the
+ * unescaped bytes. raw() of jlite.hpp and other consumers of jsonstr see
+ * those bytes for strings and binary MessagePack for containers.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param tokens Pointer to array of JSON tokens.
+ * @param num_tokens Number of tokens in tokens array.
+ * @param buf MessagePack bytes.
+ * @param len Length of buf.
+ * @param text Buffer for the text described above, at least len bytes
+ * plus the literals and numbers, owned by the caller while jsonobj is used.
+ * @param max_text_len Size of text.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if tokens or text are too small,
+ * JLITE_E_INVALID_JSON for truncated or malformed input.
+ *
+ */
+
+int jlite_msgpack_parse_init(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, const uint8_t *buf, size_t len, char *text,
+    int max_text_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_MSGPACK_H */
@@ -0,0 +1,265 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_number.c
+ * @brief This file contains the number conversion APIs definition, which
+ * decode JSON numbers directly from their spans in the JSON string.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "jlite.h"
+#include "jlite_simd.h"
+
+/* Longest number handed to strtod() when the fast path cannot be used. */
+#define JLITE_NUMBER_MAX_SLOW_LEN 64
+
+/* Powers of ten which are exactly representable as double. */
+static const double jlite_number_pow10[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#ifdef JLITE_SWAR_LITTLE_ENDIAN
+#define JLITE_NUMBER_SWAR 1
+#endif
+
+/*
+ * Accumulate the digits at str[*pos..len) into *mantissa. Digits that do
+ * not fit in 19 decimal places are counted in *dropped instead. Returns
+ * the number of digits consumed.
+ */
+static int jlite_number_digits(const char *str, int len, int *pos,
+    uint64_t *mantissa, int *dropped)
+{
+  int start = *pos;
+  int cur = *pos;
+  uint64_t m = *mantissa;
+
+#ifdef JLITE_NUMBER_SWAR
+  uint64_t word = 0;
+
+  /* Eight digits at a time while they certainly fit in 19 digits. */
+  while (cur + 8 <= len && m < 100000000000ULL)
+  {
+    memcpy(&word, str + cur, sizeof(word));
+    if (!jlite_swar_is_8_digits(word))
+    {
+      break;
+    }
+    m = m * 100000000ULL + jlite_swar_parse_8_digits(word);
+    cur += 8;
+  }
+#endif
+
+  for (; cur < len && str[cur] >= '0' && str[cur] <= '9'; cur++)
+  {
+    if (m < 1000000000000000000ULL)
+    {
+      m = m * 10 + (uint64_t) (str[cur] - '0');
+    }
+    else
+    {
+      (*dropped)++;
+    }
+  }
+
+  *mantissa = m;
+  *pos = cur;
+  return cur - start;
+}
+
+int jlite_number_to_int64(const char *str, int len, int64_t *value)
+{
+  if (!str || !value || len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  uint64_t mantissa = 0;
+  int dropped = 0;
+  int negative = 0;
+  int pos = 0;
+
+  if (str[pos] == '-')
+  {
+    negative = 1;
+    pos++;
+  }
+
+#ifdef JLITE_NUMBER_SWAR
+  /*
+   * Up to eight digits are converted without a branch per digit: they are
+   * right-aligned in a word of '0' bytes, which only adds leading zeros.
+   */
+  if (len - pos > 0 && len - pos <= 8)
+  {
+    uint64_t word = 0x3030303030303030ULL;
+
+    memcpy((char *) &word + (8 - (len - pos)), str + pos,
+        (size_t) (len - pos));
+    if (!jlite_swar_is_8_digits(word))
+    {
+      return -JLITE_E_NOT_NUMBER;
+    }
+    mantissa = jlite_swar_parse_8_digits(word);
+    *value = negative ? -(int64_t) mantissa : (int64_t) mantissa;
+    return JLITE_OK;
+  }
+#endif
+
+  if (jlite_number_digits(str, len, &pos, &mantissa, &dropped) == 0 ||
+      pos != len)
+  {
+    return -JLITE_E_NOT_NUMBER;
+  }
+
+  if (dropped || mantissa > (uint64_t) INT64_MAX + (uint64_t) negative)
+  {
+    return -JLITE_E_OUT_OF_BOUND;
+  }
+
+  *value = negative ? (int64_t) (0 - mantissa) : (int64_t) mantissa;
+  return JLITE_OK;
+}
+
+static int jlite_number_to_double_slow(const char *str, int len,
+    double *value)
+{
+  char buffer[JLITE_NUMBER_MAX_SLOW_LEN + 1];
+  char *end = NULL;
+
+  if (len > JLITE_NUMBER_MAX_SLOW_LEN)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  memcpy(buffer, str, (size_t) len);
+  buffer[len] = '\0';
+  *value = strtod(buffer, &end);
+  if (end != buffer + len)
+  {
+    return -JLITE_E_NOT_NUMBER;
+  }
+  return JLITE_OK;
+}
+
+int jlite_number_to_double(const char *str, int len, double *value)
+{
+  if (!str || !value || len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  uint64_t mantissa = 0;
+  int dropped = 0;
+  int truncated = 0;
+  int negative = 0;
+  int exponent = 0;
+  int exp_value = 0;
+  int exp_negative = 0;
+  int digits = 0;
+  int pos = 0;
+  double result = 0;
+
+  if (str[pos] == '-')
+  {
+    negative = 1;
+    pos++;
+  }
+
+  /* Integer digits beyond the mantissa raise the exponent. */
+  if (jlite_number_digits(str, len, &pos, &mantissa, &dropped) == 0)
+  {
+    return -JLITE_E_NOT_NUMBER;
+  }
+  exponent = dropped;
+  truncated = dropped;
+
+  /* Fraction digits kept in the mantissa lower the exponent. */
+  if (pos < len && str[pos] == '.')
+  {
+    pos++;
+    dropped = 0;
+    digits = jlite_number_digits(str, len, &pos, &mantissa, &dropped);
+    if (digits == 0)
+    {
+      return -JLITE_E_NOT_NUMBER;
+    }
+    exponent -= digits - dropped;
+    truncated |= dropped;
+  }
+
+  if (pos < len && (str[pos] == 'e' || str[pos] == 'E'))
+  {
+    pos++;
+    if (pos < len && (str[pos] == '+' || str[pos] == '-'))
+    {
+      exp_negative = str[pos] == '-';
+      pos++;
+    }
+    if (pos >= len || str[pos] < '0' || str[pos] > '9')
+    {
+      return -JLITE_E_NOT_NUMBER;
+    }
+    for (; pos < len && str[pos] >= '0' && str[pos] <= '9'; pos++)
+    {
+      if (exp_value < 100000)
+      {
+        exp_value = exp_value * 10 + (str[pos] - '0');
+      }
+    }
+    exponent += exp_negative ? -exp_value : exp_value;
+  }
+
+  if (pos != len)
+  {
+    return -JLITE_E_NOT_NUMBER;
+  }
+
+  /*
+   * Exact when both the mantissa and the power of ten are exactly
+   * representable (Clinger's fast path), otherwise defer to strtod().
+   */
+  if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 &&
+      exponent <= 22)
+  {
+    result = (double) mantissa;
+    if (exponent < 0)
+    {
+      result /= jlite_number_pow10[-exponent];
+    }
+    else
+    {
+      result *= jlite_number_pow10[exponent];
+    }
+    *value = negative ? -result : result;
+    return JLITE_OK;
+  }
+
+  return jlite_number_to_double_slow(str, len, value);
+}
@@ -0,0 +1,557 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_project.c
+ * @brief This file contains the projection parsing API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_project.h"
+#include "jlite_validate.h"
+#include "jlite_simd.h"
+
+typedef struct
+{
+  const char *js;
+  int len;
+  int pos;
+  jlitetok_t *tokens;
+  int num_tokens;
+  int toknext;
+  const jlite_path_t *paths;
+  int num_paths;
+} jlite_project_t;
+
+static int jlite_path_add(jlite_path_t *path, const char *key, int len)
+{
+  int used = 0;
+
+  if (path->num_segs == JLITE_PATH_MAX_SEGS)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  if (path->num_segs)
+  {
+    used = path->seg_off[path->num_segs - 1];
+    if (path->seg_len[path->num_segs - 1] > 0)
+    {
+      used += path->seg_len[path->num_segs - 1];
+    }
+  }
+  if (len < 0)
+  {
+    path->seg_off[path->num_segs] = (short) used;
+    path->seg_len[path->num_segs++] = -1;
+    return JLITE_OK;
+  }
+
+  if (used + len > JLITE_PATH_MAX_LEN)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  memcpy(path->keys + used, key, (size_t) len);
+  path->seg_off[path->num_segs] = (short) used;
+  path->seg_len[path->num_segs++] = (short) len;
+  return JLITE_OK;
+}
+
+int jlite_path_compile(jlite_path_t *path, const char *expr)
+{
+  if (!path || !expr)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  const char *p = expr;
+  const char *key = NULL;
+  int ret = 0;
+
+  memset(path, 0, sizeof(*path));
+  if (*p == '$')
+  {
+    p++;
+  }
+
+  while (*p)
+  {
+    if (*p == '[')
+    {
+      if (p[1] == '*' && p[2] == ']')
+      {
+        ret = jlite_path_add(path, NULL, -1);
+        p += 3;
+      }
+      else if (p[1] == '"')
+      {
+        key = p + 2;
+        p = strchr(key, '"');
+        if (!p || p[1] != ']')
+        {
+          return -JLITE_E_INVALID_PARAM;
+        }
+        ret = jlite_path_add(path, key, (int) (p - key));
+        p += 2;
+      }
+      else
+      {
+        return -JLITE_E_INVALID_PARAM;
+      }
+    }
+    else
+    {
+      /* A bare key is only allowed first, otherwise it follows a dot. */
+      if (*p == '.')
+      {
+        p++;
+      }
+      else if (p != expr)
+      {
+        return -JLITE_E_INVALID_PARAM;
+      }
+      if (*p == '*')
+      {
+        ret = jlite_path_add(path, NULL, -1);
+        p++;
+      }
+      else
+      {
+        key = p;
+        while (*p && *p != '.' && *p != '[')
+        {
+          p++;
+        }
+        if (p == key)
+        {
+          return -JLITE_E_INVALID_PARAM;
+        }
+        ret = jlite_path_add(path, key, (int) (p - key));
+      }
+    }
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+
+  return JLITE_OK;
+}
+
+static void jlite_project_ws(jlite_project_t *s)
+{
+  s->pos = jlite_simd_skip_ws(s->js, s->pos, s->len);
+}
+
+/* Position of the closing quote of the string opening at pos. */
+static int jlite_project_string_end(const jlite_project_t *s, int pos)
+{
+  pos++;
+  for (;;)
+  {
+    pos = jlite_simd_string_scan(s->js, pos, s->len);
+    if (s->js[pos] == '"')
+    {
+      return pos;
+    }
+    pos += s->js[pos] == '\\' ? 2 : 1;
+  }
+}
+
+static int jlite_project_primitive_end(const jlite_project_t *s, int pos)
+{
+  for (; pos < s->len; pos++)
+  {
+    switch (s->js[pos])
+    {
+      case ' ': case '\t': case '\r': case '\n': case ',': case ']': case '}':
+        return pos;
+      default:
+        break;
+    }
+  }
+  return pos;
+}
+
+/* The input is validated, so brackets can simply be counted. */
+static void jlite_project_skip(jlite_project_t *s)
+{
+  int depth = 0;
+  char c = s->js[s->pos];
+
+  if (c == '"')
+  {
+    s->pos = jlite_project_string_end(s, s->pos) + 1;
+    return;
+  }
+  if (c != '{' && c != '[')
+  {
+    s->pos = jlite_project_primitive_end(s, s->pos);
+    return;
+  }
+
+  do
+  {
+    s->pos = jlite_simd_struct_scan(s->js, s->pos, s->len);
+    c = s->js[s->pos];
+    if (c == '"')
+    {
+      s->pos = jlite_project_string_end(s, s->pos);
+    }
+    else if (c == '{' || c == '[')
+    {
+      depth++;
+    }
+    else if (c == '}' || c == ']')
+    {
+      depth--;
+    }
+    s->pos++;
+  } while (depth > 0);
+}
+
+static int jlite_project_alloc(jlite_project_t *s, jsmntype_t type,
+    int start, int end, int parent)
+{
+  jlitetok_t *tok = NULL;
+
+  if (s->toknext >= s->num_tokens)
+  {
+    return -1;
+  }
+  tok = &s->tokens[s->toknext];
+  tok->type = (unsigned char) type;
+  tok->kind = JSMN_KIND_NONE;
+  tok->start = start;
+  tok->end = end;
+  tok->size = 0;
+  tok->parent = parent;
+  if (parent >= 0)
+  {
+    s->tokens[parent].size++;
+  }
+  return s->toknext++;
+}
+
+/* Drop token pos and everything after it. */
+static void jlite_project_rollback(jlite_project_t *s, int pos)
+{
+  if (s->tokens[pos].parent >= 0)
+  {
+    s->tokens[s->tokens[pos].parent].size--;
+  }
+  s->toknext = pos;
+}
+
+/*
+ * Emit all tokens of the value at pos below parent. Like jsmn, the open
+ * container is found again through the parent links when one closes.
+ */
+static int jlite_project_emit(jlite_project_t *s, int parent)
+{
+  int root = s->toknext;
+  int cur = parent;
+  int done = -1;
+  int end = 0;
+  int tok = 0;
+  char c = 0;
+
+  for (;;)
+  {
+    jlite_project_ws(s);
+    c = s->js[s->pos];
+    switch (c)
+    {
+      case '{':
+      case '[':
+        tok = jlite_project_alloc(s, c == '{' ? JSMN_OBJECT : JSMN_ARRAY,
+            s->pos, -1, cur);
+        if (tok < 0)
+        {
+          return -JLITE_E_NO_BUFFER_MEM;
+        }
+        cur = tok;
+        s->pos++;
+        continue;
+      case '}':
+      case ']':
+        s->tokens[cur].end = ++s->pos;
+        done = cur;
+        cur = s->tokens[cur].parent;
+        break;
+      case ',':
+      case ':':
+        s->pos++;
+        continue;
+      case '"':
+        end = jlite_project_string_end(s, s->pos);
+        tok = jlite_project_alloc(s, JSMN_STRING, s->pos + 1, end, cur);
+        if (tok < 0)
+        {
+          return -JLITE_E_NO_BUFFER_MEM;
+        }
+        s->pos = end + 1;
+        if (cur >= 0 && s->tokens[cur].type == JSMN_OBJECT)
+        {
+          /* A key, its value follows as its child. */
+          cur = tok;
+          continue;
+        }
+        done = tok;
+        break;
+      default:
+        end = jlite_project_primitive_end(s, s->pos);
+        tok = jlite_project_alloc(s, JSMN_PRIMITIVE, s->pos, end, cur);
+        if (tok < 0)
+        {
+          return -JLITE_E_NO_BUFFER_MEM;
+        }
+        s->tokens[tok].kind = (unsigned char) jsmn_primitive_kind(
+            s->js + s->pos, (size_t) (end - s->pos));
+        s->pos = end;
+        done = tok;
+        break;
+    }
+
+    if (done == root)
+    {
+      return JLITE_OK;
+    }
+    if (cur >= 0 && s->tokens[cur].type == JSMN_STRING)
+    {
+      cur = s->tokens[cur].parent;
+    }
+  }
+}
+
+/*
+ * Paths of mask selecting the member with the given key (NULL for an array
+ * element) at depth; those ending there are also set in full.
+ */
+static uint32_t jlite_project_match(const jlite_project_t *s, uint32_t mask,
+    int depth, const char *key, int key_len, uint32_t *full)
+{
+  const jlite_path_t *path = NULL;
+  uint32_t child = 0;
+  int len = 0;
+  int i = 0;
+
+  *full = 0;
+  for (i = 0; i < s->num_paths; i++)
+  {
+    if (!(mask & (1u << i)))
+    {
+      continue;
+    }
+    path = &s->paths[i];
+    len = path->seg_len[depth];
+    if (len < 0 || (key && len == key_len &&
+        !memcmp(path->keys + path->seg_off[depth], key, (size_t) len)))
+    {
+      child |= 1u << i;
+      if (path->num_segs == depth + 1)
+      {
+        *full |= 1u << i;
+      }
+    }
+  }
+  return child;
+}
+
+/*
+ * Fill the members of container tok, whose opening bracket has been read,
+ * for the paths of mask. Recursion is bounded by JLITE_PATH_MAX_SEGS since
+ * values no path continues into are skipped or emitted without it.
+ */
+static int jlite_project_container(jlite_project_t *s, int tok, int depth,
+    uint32_t mask)
+{
+  int is_object = s->tokens[tok].type == JSMN_OBJECT;
+  uint32_t child = 0;
+  uint32_t full = 0;
+  int key_end = 0;
+  int parent = 0;
+  int value = 0;
+  int key = 0;
+  int ret = 0;
+  char c = 0;
+
+  for (;;)
+  {
+    jlite_project_ws(s);
+    c = s->js[s->pos];
+    if (c == '}' || c == ']')
+    {
+      s->tokens[tok].end = ++s->pos;
+      return JLITE_OK;
+    }
+    if (c == ',')
+    {
+      s->pos++;
+      continue;
+    }
+
+    key = -1;
+    parent = tok;
+    if (is_object)
+    {
+      key_end = jlite_project_string_end(s, s->pos);
+      child = jlite_project_match(s, mask, depth, s->js + s->pos + 1,
+          key_end - s->pos - 1, &full);
+      if (child)
+      {
+        key = jlite_project_alloc(s, JSMN_STRING, s->pos + 1, key_end, tok);
+        if (key < 0)
+        {
+          return -JLITE_E_NO_BUFFER_MEM;
+        }
+        parent = key;
+      }
+      s->pos = key_end + 1;
+      jlite_project_ws(s);
+      s->pos++;
+      jlite_project_ws(s);
+    }
+    else
+    {
+      child = jlite_project_match(s, mask, depth, NULL, 0, &full);
+    }
+
+    c = s->js[s->pos];
+    if (!child)
+    {
+      jlite_project_skip(s);
+      continue;
+    }
+    if (full)
+    {
+      ret = jlite_project_emit(s, parent);
+    }
+    else if (c == '{' || c == '[')
+    {
+      value = jlite_project_alloc(s, c == '{' ? JSMN_OBJECT : JSMN_ARRAY,
+          s->pos, -1, parent);
+      if (value < 0)
+      {
+        return -JLITE_E_NO_BUFFER_MEM;
+      }
+      s->pos++;
+      ret = jlite_project_container(s, value, depth + 1, child);
+      if (ret == JLITE_OK && key >= 0 && !s->tokens[value].size)
+      {
+        jlite_project_rollback(s, key);
+      }
+    }
+    else if (key >= 0)
+    {
+      /* The path goes on but the value is a scalar. */
+      jlite_project_skip(s);
+      jlite_project_rollback(s, key);
+    }
+    else
+    {
+      ret = jlite_project_emit(s, parent);
+    }
+    if (ret != JLITE_OK)
+    {
+      return ret;
+    }
+  }
+}
+
+int jlite_parse_project(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int jsonstr_len,
+    const jlite_path_t *paths, int num_paths)
+{
+  if (!jsonobj || !tokens || num_tokens <= 0 || !jsonstr ||
+      jsonstr_len <= 0 || !paths || num_paths <= 0 ||
+      num_paths > JLITE_PROJECT_MAX_PATHS)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_project_t s;
+  uint32_t mask = 0;
+  uint32_t full = 0;
+  int root = 0;
+  int ret = 0;
+  int i = 0;
+  char c = 0;
+
+  ret = jlite_validate(jsonstr, jsonstr_len, NULL);
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  memset(&s, 0, sizeof(s));
+  s.js = jsonstr;
+  s.len = jsonstr_len;
+  s.tokens = tokens;
+  s.num_tokens = num_tokens;
+  s.paths = paths;
+  s.num_paths = num_paths;
+  for (i = 0; i < num_paths; i++)
+  {
+    mask |= 1u << i;
+    if (!paths[i].num_segs)
+    {
+      full = 1;
+    }
+  }
+
+  jlite_project_ws(&s);
+  c = jsonstr[s.pos];
+  if (full || (c != '{' && c != '['))
+  {
+    ret = jlite_project_emit(&s, -1);
+  }
+  else
+  {
+    root = jlite_project_alloc(&s, c == '{' ? JSMN_OBJECT : JSMN_ARRAY,
+        s.pos, -1, -1);
+    s.pos++;
+    ret = jlite_project_container(&s, root, 0, mask);
+  }
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+
+  memset(jsonobj, 0, sizeof(*jsonobj));
+  jsonobj->j_parser.pos = (unsigned int) s.pos;
+  jsonobj->j_parser.toknext = (unsigned int) s.toknext;
+  jsonobj->j_parser.toksuper = -1;
+#if JLITE_STATS
+  jsonobj->stats.parse_bytes = (unsigned long) jsonstr_len;
+  jsonobj->stats.tokens_produced = (unsigned long) s.toknext;
+#endif
+  jsonobj->jsonstr = jsonstr;
+  jsonobj->jsonstr_len = jsonstr_len;
+  jsonobj->tokens = tokens;
+  jsonobj->num_tokens = s.toknext;
+  jsonobj->cur_pos = 1;
+
+  return JLITE_OK;
+}
@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_project.h
+ * @brief Projection parsing which keeps tokens only for selected paths.
+ *
+ */
+
+#ifndef _JLITE_PROJECT_H
+#define _JLITE_PROJECT_H
+
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of segments of a compiled path. */
+#ifndef JLITE_PATH_MAX_SEGS
+#define JLITE_PATH_MAX_SEGS 16
+#endif
+
+/* Maximum total key length of a compiled path. */
+#ifndef JLITE_PATH_MAX_LEN
+#define JLITE_PATH_MAX_LEN 128
+#endif
+
+/* Maximum number of paths of one projection. */
+#define JLITE_PROJECT_MAX_PATHS 32
+
+/**
+ * @brief Compiled path, see jlite_path_compile().
+ *
+ */
+
+typedef struct
+{
+  int num_segs;
+  short seg_off[JLITE_PATH_MAX_SEGS];
+  short seg_len[JLITE_PATH_MAX_SEGS];  /* -1 for a wildcard. */
+  char keys[JLITE_PATH_MAX_LEN];
+} jlite_path_t;
+
+/**
+ * @brief Compile a path expression.
+ *
+ * A path is a sequence of segments, optionally starting with "$": ".key"
+ * (or "key" first) selects an object member, "[\"key\"]" a member whose
+ * key contains any character but '"', and ".*" or "[*]" every member or
+ * element. Keys are compared with the raw JSON text, without unescaping.
+ * An empty path or "$" selects the whole document.
+ *
+ * @param path Pointer to path to fill.
+ * @param expr Path expression, e.g. "user.name" or "items[*].id".
+ *
+ * @return errcode, JLITE_E_INVALID_PARAM for a malformed expression,
+ * JLITE_E_NO_BUFFER_MEM if it exceeds JLITE_PATH_MAX_SEGS or
+ * JLITE_PATH_MAX_LEN.
+ *
+ */
+
+int jlite_path_compile(jlite_path_t *path, const char *expr);
+
+/**
+ * @brief Initialize the JSON object from a projection of the given string.
+ *
+ * The whole string is validated as with jlite_validate(), but tokens are
+ * only filled for the values selected by the paths, their ancestors and
+ * the keys leading to them, so token memory grows with the selection
+ * rather than the document. Containers without a selected value are left
+ * out, except elements of arrays selected with a wildcard, which are kept
+ * (emptied if nothing in them is selected) so element positions do not
+ * move. The result is a normal JSON object for all getters.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param tokens Pointer to array of JSON tokens.
+ * @param num_tokens Number of tokens in tokens array.
+ * @param jsonstr Pointer to JSON string to parse.
+ * @param jsonstr_len Length of JSON string.
+ * @param paths Compiled paths to keep.
+ * @param num_paths Number of paths, up to JLITE_PROJECT_MAX_PATHS.
+ *
+ * @return errcode as for jlite_validate(), JLITE_E_NO_BUFFER_MEM if the
+ * selection needs more tokens.
+ *
+ */
+
+int jlite_parse_project(jliteobj_t *jsonobj, jlitetok_t *tokens,
+    int num_tokens, char *jsonstr, int jsonstr_len,
+    const jlite_path_t *paths, int num_paths);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_PROJECT_H */
@@ -0,0 +1,723 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_query.c
+ * @brief This file contains the JSONPath query API definition.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "jlite_query.h"
+
+enum
+{
+  JLITE_QOP_CHILD,        /* a: key */
+  JLITE_QOP_WILDCARD,
+  JLITE_QOP_DESCEND,      /* a: key */
+  JLITE_QOP_DESCEND_ANY,
+  JLITE_QOP_INDEX,        /* a: index, negative from the end */
+  JLITE_QOP_SLICE,        /* a: start, b: end, c: step, flags: which set */
+  JLITE_QOP_FILTER,       /* a: first key, b: number of keys, cmp, lit */
+};
+
+enum
+{
+  JLITE_QCMP_EXISTS,
+  JLITE_QCMP_EQ,
+  JLITE_QCMP_NE,
+  JLITE_QCMP_LT,
+  JLITE_QCMP_LE,
+  JLITE_QCMP_GT,
+  JLITE_QCMP_GE,
+};
+
+enum
+{
+  JLITE_QLIT_NUMBER,      /* num */
+  JLITE_QLIT_STRING,      /* c: key holding the raw text */
+  JLITE_QLIT_WORD,        /* c: key holding true, false or null */
+};
+
+#define JLITE_QSLICE_START 1
+#define JLITE_QSLICE_END 2
+
+typedef struct
+{
+  jlite_query_t *query;
+  const char *expr;
+  const char *p;
+} jlite_query_compiler_t;
+
+typedef struct
+{
+  int pos;
+  int remaining;
+  int index;
+  uint32_t state;
+} jlite_query_frame_t;
+
+/* Compiler */
+
+static int jlite_query_key(jlite_query_compiler_t *qc, const char *key,
+    int len)
+{
+  jlite_query_t *query = qc->query;
+
+  if (query->num_keys == JLITE_QUERY_MAX_KEYS ||
+      query->text_len + len > JLITE_QUERY_MAX_TEXT)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  memcpy(query->text + query->text_len, key, (size_t) len);
+  query->key_off[query->num_keys] = (short) query->text_len;
+  query->key_len[query->num_keys] = (short) len;
+  query->text_len += len;
+  return query->num_keys++;
+}
+
+static jlite_query_insn_t *jlite_query_insn(jlite_query_compiler_t *qc,
+    int op)
+{
+  jlite_query_insn_t *insn = NULL;
+
+  if (qc->query->num_insns == JLITE_QUERY_MAX_STEPS)
+  {
+    return NULL;
+  }
+  insn = &qc->query->insns[qc->query->num_insns++];
+  memset(insn, 0, sizeof(*insn));
+  insn->op = (unsigned char) op;
+  return insn;
+}
+
+static void jlite_query_ws(jlite_query_compiler_t *qc)
+{
+  while (*qc->p == ' ')
+  {
+    qc->p++;
+  }
+}
+
+/* A dotted name runs up to the next '.' or '['. */
+static int jlite_query_name(jlite_query_compiler_t *qc)
+{
+  const char *start = qc->p;
+
+  while (*qc->p && *qc->p != '.' && *qc->p != '[')
+  {
+    qc->p++;
+  }
+  if (qc->p == start)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  return jlite_query_key(qc, start, (int) (qc->p - start));
+}
+
+/* A quoted string in single or double quotes, kept raw. */
+static int jlite_query_quoted(jlite_query_compiler_t *qc)
+{
+  char quote = *qc->p;
+  const char *start = qc->p + 1;
+  const char *end = NULL;
+
+  if (quote != '\'' && quote != '"')
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  end = strchr(start, quote);
+  if (!end)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  qc->p = end + 1;
+  return jlite_query_key(qc, start, (int) (end - start));
+}
+
+static int jlite_query_int(jlite_query_compiler_t *qc, int *value)
+{
+  char *end = NULL;
+  long n = strtol(qc->p, &end, 10);
+
+  if (end == qc->p)
+  {
+    return 0;
+  }
+  qc->p = end;
+  *value = (int) n;
+  return 1;
+}
+
+static int jlite_query_filter(jlite_query_compiler_t *qc)
+{
+  jlite_query_insn_t *insn = NULL;
+  static const char *ops[] = { "==", "!=", "<=", ">=", "<", ">" };
+  static const int cmps[] = { JLITE_QCMP_EQ, JLITE_QCMP_NE, JLITE_QCMP_LE,
+      JLITE_QCMP_GE, JLITE_QCMP_LT, JLITE_QCMP_GT };
+  const char *start = NULL;
+  char *end = NULL;
+  int key = 0;
+  int i = 0;
+
+  insn = jlite_query_insn(qc, JLITE_QOP_FILTER);
+  if (!insn)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  jlite_query_ws(qc);
+  if (*qc->p++ != '@')
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  insn->a = qc->query->num_keys;
+  for (;;)
+  {
+    if (*qc->p == '.')
+    {
+      qc->p++;
+      start = qc->p;
+      while (*qc->p && !strchr(".[ =!<>)", *qc->p))
+      {
+        qc->p++;
+      }
+      key = qc->p == start ? -JLITE_E_INVALID_PARAM :
+          jlite_query_key(qc, start, (int) (qc->p - start));
+    }
+    else if (*qc->p == '[')
+    {
+      qc->p++;
+      key = jlite_query_quoted(qc);
+      if (key >= 0 && *qc->p++ != ']')
+      {
+        key = -JLITE_E_INVALID_PARAM;
+      }
+    }
+    else
+    {
+      break;
+    }
+    if (key < 0)
+    {
+      return key;
+    }
+    insn->b++;
+  }
+
+  jlite_query_ws(qc);
+  insn->cmp = JLITE_QCMP_EXISTS;
+  for (i = 0; i < (int) (sizeof(ops) / sizeof(ops[0])); i++)
+  {
+    if (!strncmp(qc->p, ops[i], strlen(ops[i])))
+    {
+      insn->cmp = (unsigned char) cmps[i];
+      qc->p += strlen(ops[i]);
+      break;
+    }
+  }
+
+  if (insn->cmp != JLITE_QCMP_EXISTS)
+  {
+    jlite_query_ws(qc);
+    if (*qc->p == '\'' || *qc->p == '"')
+    {
+      insn->lit = JLITE_QLIT_STRING;
+      insn->c = jlite_query_quoted(qc);
+    }
+    else if (!strncmp(qc->p, "true", 4) || !strncmp(qc->p, "null", 4) ||
+        !strncmp(qc->p, "false", 5))
+    {
+      insn->lit = JLITE_QLIT_WORD;
+      insn->c = jlite_query_key(qc, qc->p, *qc->p == 'f' ? 5 : 4);
+      qc->p += *qc->p == 'f' ? 5 : 4;
+    }
+    else
+    {
+      insn->lit = JLITE_QLIT_NUMBER;
+      insn->num = strtod(qc->p, &end);
+      insn->c = end == qc->p ? -JLITE_E_INVALID_PARAM : 0;
+      qc->p = end;
+    }
+    if (insn->c < 0)
+    {
+      return insn->c;
+    }
+  }
+
+  jlite_query_ws(qc);
+  if (*qc->p++ != ')')
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  return JLITE_OK;
+}
+
+/* The inside of [...], after the '['. */
+static int jlite_query_bracket(jlite_query_compiler_t *qc, int descend)
+{
+  jlite_query_insn_t *insn = NULL;
+  int value = 0;
+  int ret = JLITE_OK;
+
+  jlite_query_ws(qc);
+  if (!descend && qc->p[0] == '?' && qc->p[1] == '(')
+  {
+    qc->p += 2;
+    ret = jlite_query_filter(qc);
+  }
+  else if (*qc->p == '*')
+  {
+    qc->p++;
+    insn = jlite_query_insn(qc, descend ? JLITE_QOP_DESCEND_ANY :
+        JLITE_QOP_WILDCARD);
+    ret = insn ? JLITE_OK : -JLITE_E_NO_BUFFER_MEM;
+  }
+  else if (*qc->p == '\'' || *qc->p == '"')
+  {
+    insn = jlite_query_insn(qc, descend ? JLITE_QOP_DESCEND :
+        JLITE_QOP_CHILD);
+    ret = insn ? jlite_query_quoted(qc) : -JLITE_E_NO_BUFFER_MEM;
+    if (ret >= 0)
+    {
+      insn->a = ret;
+      ret = JLITE_OK;
+    }
+  }
+  else if (descend)
+  {
+    ret = -JLITE_E_INVALID_PARAM;
+  }
+  else
+  {
+    insn = jlite_query_insn(qc, JLITE_QOP_INDEX);
+    if (!insn)
+    {
+      return -JLITE_E_NO_BUFFER_MEM;
+    }
+    if (jlite_query_int(qc, &value))
+    {
+      insn->a = value;
+      insn->flags |= JLITE_QSLICE_START;
+    }
+    if (*qc->p == ':')
+    {
+      insn->op = JLITE_QOP_SLICE;
+      insn->c = 1;
+      qc->p++;
+      if (jlite_query_int(qc, &value))
+      {
+        insn->b = value;
+        insn->flags |= JLITE_QSLICE_END;
+      }
+      if (*qc->p == ':')
+      {
+        qc->p++;
+        if (!jlite_query_int(qc, &insn->c) || insn->c <= 0)
+        {
+          ret = -JLITE_E_INVALID_PARAM;
+        }
+      }
+    }
+    else if (!(insn->flags & JLITE_QSLICE_START))
+    {
+      ret = -JLITE_E_INVALID_PARAM;
+    }
+  }
+
+  if (ret != JLITE_OK)
+  {
+    return ret;
+  }
+  jlite_query_ws(qc);
+  if (*qc->p != ']')
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+  qc->p++;
+  return JLITE_OK;
+}
+
+static int jlite_query_step(jlite_query_compiler_t *qc)
+{
+  jlite_query_insn_t *insn = NULL;
+  int descend = 0;
+  int ret = 0;
+
+  if (*qc->p == '[')
+  {
+    qc->p++;
+    return jlite_query_bracket(qc, 0);
+  }
+  if (*qc->p != '.')
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  qc->p++;
+  if (*qc->p == '.')
+  {
+    descend = 1;
+    qc->p++;
+    if (*qc->p == '[')
+    {
+      qc->p++;
+      return jlite_query_bracket(qc, 1);
+    }
+  }
+  if (*qc->p == '*')
+  {
+    qc->p++;
+    insn = jlite_query_insn(qc, descend ? JLITE_QOP_DESCEND_ANY :
+        JLITE_QOP_WILDCARD);
+    return insn ? JLITE_OK : -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  insn = jlite_query_insn(qc, descend ? JLITE_QOP_DESCEND : JLITE_QOP_CHILD);
+  if (!insn)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+  ret = jlite_query_name(qc);
+  insn->a = ret;
+  return ret < 0 ? ret : JLITE_OK;
+}
+
+int jlite_query_compile(jlite_query_t *query, const char *expr,
+    int *err_offset)
+{
+  if (!query || !expr)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_query_compiler_t qc;
+  int ret = JLITE_OK;
+
+  memset(query, 0, sizeof(*query));
+  qc.query = query;
+  qc.expr = expr;
+  qc.p = expr;
+  if (*qc.p == '$')
+  {
+    qc.p++;
+  }
+
+  while (*qc.p && ret == JLITE_OK)
+  {
+    ret = jlite_query_step(&qc);
+  }
+
+  if (err_offset)
+  {
+    *err_offset = ret == JLITE_OK ? -1 : (int) (qc.p - expr);
+  }
+  return ret;
+}
+
+/* Evaluator */
+
+static int jlite_query_key_eq(const jlite_query_t *query, int key,
+    const jliteobj_t *jsonobj, const jlitetok_t *tok)
+{
+  return tok->end - tok->start == query->key_len[key] &&
+      !memcmp(jsonobj->jsonstr + tok->start, query->text + query->key_off[key],
+      (size_t) query->key_len[key]);
+}
+
+static int jlite_query_cmp(int cmp, int order)
+{
+  switch (cmp)
+  {
+    case JLITE_QCMP_EQ: return order == 0;
+    case JLITE_QCMP_NE: return order != 0;
+    case JLITE_QCMP_LT: return order < 0;
+    case JLITE_QCMP_LE: return order <= 0;
+    case JLITE_QCMP_GT: return order > 0;
+    case JLITE_QCMP_GE: return order >= 0;
+    default: return 1;
+  }
+}
+
+/* Evaluate the filter of insn on the value at pos. */
+static int jlite_query_filter_match(const jlite_query_t *query,
+    const jlite_query_insn_t *insn, const jliteobj_t *jsonobj, int pos)
+{
+  const jlitetok_t *tokens = jsonobj->tokens;
+  const jlitetok_t *tok = NULL;
+  double value = 0;
+  int members = 0;
+  int key = 0;
+  int len = 0;
+  int lit_len = 0;
+  int order = 0;
+
+  /* Follow @.k1.k2... one object level at a time. */
+  for (key = insn->a; key < insn->a + insn->b; key++)
+  {
+    if (tokens[pos].type != JSMN_OBJECT)
+    {
+      return 0;
+    }
+    members = tokens[pos].size;
+    pos++;
+    while (members && !jlite_query_key_eq(query, key, jsonobj, &tokens[pos]))
+    {
+      pos = (int) jlite_next_sibling(tokens, pos);
+      members--;
+    }
+    if (!members)
+    {
+      return 0;
+    }
+    pos++;
+  }
+
+  if (insn->cmp == JLITE_QCMP_EXISTS)
+  {
+    return 1;
+  }
+
+  tok = &tokens[pos];
+  len = tok->end - tok->start;
+  switch (insn->lit)
+  {
+    case JLITE_QLIT_NUMBER:
+      if (tok->type != JSMN_PRIMITIVE ||
+          jlite_number_to_double(jsonobj->jsonstr + tok->start, len,
+          &value) != JLITE_OK)
+      {
+        return insn->cmp == JLITE_QCMP_NE;
+      }
+      order = (value > insn->num) - (value < insn->num);
+      break;
+    case JLITE_QLIT_STRING:
+    case JLITE_QLIT_WORD:
+      if (tok->type != (insn->lit == JLITE_QLIT_STRING ? JSMN_STRING :
+          JSMN_PRIMITIVE))
+      {
+        return insn->cmp == JLITE_QCMP_NE;
+      }
+      lit_len = query->key_len[insn->c];
+      order = memcmp(jsonobj->jsonstr + tok->start,
+          query->text + query->key_off[insn->c],
+          (size_t) (len < lit_len ? len : lit_len));
+      if (!order)
+      {
+        order = (len > lit_len) - (len < lit_len);
+      }
+      break;
+    default:
+      return 0;
+  }
+  return jlite_query_cmp(insn->cmp, order);
+}
+
+/*
+ * States a child reaches from its parent's state: bit k set means the
+ * value has matched the first k steps. key is the member key token, or -1
+ * for an array element with the given index.
+ */
+static uint32_t jlite_query_advance(const jlite_query_t *query,
+    const jliteobj_t *jsonobj, uint32_t state, int key, int index, int size,
+    int value)
+{
+  const jlite_query_insn_t *insn = NULL;
+  const jlitetok_t *key_tok = key >= 0 ? &jsonobj->tokens[key] : NULL;
+  uint32_t next = 0;
+  int start = 0;
+  int end = 0;
+  int k = 0;
+
+  for (k = 0; k < query->num_insns; k++)
+  {
+    if (!(state & (1u << k)))
+    {
+      continue;
+    }
+    insn = &query->insns[k];
+    switch (insn->op)
+    {
+      case JLITE_QOP_CHILD:
+        if (key_tok && jlite_query_key_eq(query, insn->a, jsonobj, key_tok))
+        {
+          next |= 2u << k;
+        }
+        break;
+      case JLITE_QOP_WILDCARD:
+        next |= 2u << k;
+        break;
+      case JLITE_QOP_DESCEND:
+        next |= 1u << k;
+        if (key_tok && jlite_query_key_eq(query, insn->a, jsonobj, key_tok))
+        {
+          next |= 2u << k;
+        }
+        break;
+      case JLITE_QOP_DESCEND_ANY:
+        next |= 3u << k;
+        break;
+      case JLITE_QOP_INDEX:
+        if (!key_tok &&
+            index == (insn->a < 0 ? insn->a + size : insn->a))
+        {
+          next |= 2u << k;
+        }
+        break;
+      case JLITE_QOP_SLICE:
+        if (key_tok)
+        {
+          break;
+        }
+        start = !(insn->flags & JLITE_QSLICE_START) ? 0 :
+            insn->a < 0 ? insn->a + size : insn->a;
+        end = !(insn->flags & JLITE_QSLICE_END) ? size :
+            insn->b < 0 ? insn->b + size : insn->b;
+        if (start < 0)
+        {
+          start = 0;
+        }
+        if (index >= start && index < end && (index - start) % insn->c == 0)
+        {
+          next |= 2u << k;
+        }
+        break;
+      case JLITE_QOP_FILTER:
+        if (jlite_query_filter_match(query, insn, jsonobj, value))
+        {
+          next |= 2u << k;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return next;
+}
+
+int jlite_query_run(const jlite_query_t *query, jliteobj_t *jsonobj,
+    jlite_query_cb_t cb, void *ctx, int *num_matches)
+{
+  if (!query || !jsonobj || !jsonobj->tokens || !cb)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_query_frame_t stack[JLITE_QUERY_MAX_DEPTH];
+  jlite_query_frame_t *frame = NULL;
+  const jlitetok_t *tokens = jsonobj->tokens;
+  uint32_t done = 1u << query->num_insns;
+  uint32_t live = done - 1;
+  uint32_t state = 0;
+  int depth = 0;
+  int matches = 0;
+  int stop = 0;
+  int root = jsonobj->cur_pos - 1;
+  int pos = 0;
+  int key = 0;
+  int value = 0;
+
+  if (num_matches)
+  {
+    *num_matches = 0;
+  }
+  if (root < 0 || root >= jsonobj->num_tokens)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  if (!query->num_insns)
+  {
+    if (num_matches)
+    {
+      *num_matches = 1;
+    }
+    cb(jsonobj, root, ctx);
+    return JLITE_OK;
+  }
+  if (tokens[root].type != JSMN_OBJECT && tokens[root].type != JSMN_ARRAY)
+  {
+    return JLITE_OK;
+  }
+
+  stack[0].pos = root;
+  stack[0].remaining = tokens[root].size;
+  stack[0].index = 0;
+  stack[0].state = 1;
+  depth = 1;
+  pos = root + 1;
+
+  while (depth && !stop)
+  {
+    frame = &stack[depth - 1];
+    if (!frame->remaining)
+    {
+      depth--;
+      continue;
+    }
+    frame->remaining--;
+
+    key = -1;
+    value = pos;
+    if (tokens[frame->pos].type == JSMN_OBJECT)
+    {
+      key = pos;
+      value = pos + 1;
+    }
+    state = jlite_query_advance(query, jsonobj, frame->state, key,
+        frame->index++, tokens[frame->pos].size, value);
+
+    if (state & done)
+    {
+      matches++;
+      stop = cb(jsonobj, value, ctx);
+    }
+
+    if ((state & live) &&
+        (tokens[value].type == JSMN_OBJECT || tokens[value].type == JSMN_ARRAY))
+    {
+      if (depth == JLITE_QUERY_MAX_DEPTH)
+      {
+        return -JLITE_E_NO_BUFFER_MEM;
+      }
+      frame = &stack[depth++];
+      frame->pos = value;
+      frame->remaining = tokens[value].size;
+      frame->index = 0;
+      frame->state = state & live;
+      pos = value + 1;
+    }
+    else
+    {
+      pos = (int) jlite_next_sibling(tokens, value);
+    }
+  }
+
+  if (num_matches)
+  {
+    *num_matches = matches;
+  }
+  return JLITE_OK;
+}
@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_query.h
+ * @brief JSONPath subset compiled to bytecode and run over parsed tokens.
+ *
+ */
+
+#ifndef _JLITE_QUERY_H
+#define _JLITE_QUERY_H
+
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of steps of a compiled query. */
+#define JLITE_QUERY_MAX_STEPS 31
+
+/* Maximum number of keys and string literals of a compiled query. */
+#ifndef JLITE_QUERY_MAX_KEYS
+#define JLITE_QUERY_MAX_KEYS 32
+#endif
+
+/* Maximum total length of the keys and string literals of a query. */
+#ifndef JLITE_QUERY_MAX_TEXT
+#define JLITE_QUERY_MAX_TEXT 256
+#endif
+
+/* Maximum nesting the evaluator follows below the query root. */
+#ifndef JLITE_QUERY_MAX_DEPTH
+#define JLITE_QUERY_MAX_DEPTH 1024
+#endif
+
+/**
+ * @brief One bytecode instruction, private to the query engine.
+ *
+ */
+
+typedef struct
+{
+  unsigned char op;
+  unsigned char cmp;
+  unsigned char lit;
+  unsigned char flags;
+  int a;
+  int b;
+  int c;
+  double num;
+} jlite_query_insn_t;
+
+/**
+ * @brief Compiled query, see jlite_query_compile().
+ *
+ */
+
+typedef struct
+{
+  int num_insns;
+  jlite_query_insn_t insns[JLITE_QUERY_MAX_STEPS];
+  int num_keys;
+  short key_off[JLITE_QUERY_MAX_KEYS];
+  short key_len[JLITE_QUERY_MAX_KEYS];
+  int text_len;
+  char text[JLITE_QUERY_MAX_TEXT];
+} jlite_query_t;
+
+/**
+ * @brief Callback receiving each match of a query.
+ *
+ * @param jsonobj Pointer to JSON object being queried.
+ * @param pos Token position of the matched value.
+ * @param ctx Caller context passed to jlite_query_run().
+ *
+ * @return 0 to continue, non-zero to stop the query.
+ *
+ */
+
+typedef int (*jlite_query_cb_t)(jliteobj_t *jsonobj, int pos, void *ctx);
+
+/**
+ * @brief Compile a JSONPath expression.
+ *
+ * Supported are "$" (optional), ".key", "['key']" or "[\"key\"]", ".*" and
+ * "[*]", recursive descent "..key", "..*" and "..['key']", indexes "[n]"
+ * (negative from the end), slices "[start:end:step]" with a positive step,
+ * and filters "[?(@.a.b)]" or "[?(@.a.b OP literal)]" where OP is one of
+ * == != < <= > >= and the literal a number, a quoted string, true, false
+ * or null. Numbers compare by value, strings by their raw JSON text.
+ *
+ * @param query Pointer to query to fill.
+ * @param expr JSONPath expression.
+ * @param err_offset Pointer to an int variable to get the offset where
+ * compilation stopped, -1 on success, may be NULL.
+ *
+ * @return errcode, JLITE_E_INVALID_PARAM for a malformed expression,
+ * JLITE_E_NO_BUFFER_MEM if it exceeds the JLITE_QUERY_MAX_* limits.
+ *
+ */
+
+int jlite_query_compile(jlite_query_t *query, const char *expr,
+    int *err_offset);
+
+/**
+ * @brief Run a compiled query.
+ *
+ * The query root "$" is the current object or array of jsonobj, so a
+ * query can start from a value selected with the getters. The tokens are
+ * walked once in order, tracking for every open container the set of
+ * query steps reached there; subtrees no step can continue into are
+ * skipped. Matches are reported once each, in document order. Nothing is
+ * allocated, the walk uses a fixed stack of JLITE_QUERY_MAX_DEPTH levels.
+ *
+ * @param query Pointer to compiled query.
+ * @param jsonobj Pointer to JSON object.
+ * @param cb Callback for every match.
+ * @param ctx Context passed to cb.
+ * @param num_matches Pointer to an int variable to get the number of
+ * matches reported, may be NULL.
+ *
+ * @return errcode, JLITE_E_NO_BUFFER_MEM if the query follows nesting
+ * deeper than JLITE_QUERY_MAX_DEPTH.
+ *
+ */
+
+int jlite_query_run(const jlite_query_t *query, jliteobj_t *jsonobj,
+    jlite_query_cb_t cb, void *ctx, int *num_matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_QUERY_H */
@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_shape.c
+ * @brief This file contains the shape cache API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_shape_internal.h"
+#include "jlite_hash.h"
+
+/*
+ * Objects are told apart by the key they are stored under; elements of an
+ * array take the key of the array, marked once per array level.
+ */
+static uint64_t jlite_shape_context(const jliteobj_t *jsonobj)
+{
+  const jlitetok_t *tokens = jsonobj->tokens;
+  int parent = tokens[jsonobj->cur_pos - 1].parent;
+  uint64_t seed = 0;
+
+  while (parent >= 0 && tokens[parent].type == JSMN_ARRAY)
+  {
+    seed = seed * 31 + 1;
+    parent = tokens[parent].parent;
+  }
+  if (parent < 0)
+  {
+    return seed;
+  }
+  return jlite_hash_bytes(jsonobj->jsonstr + tokens[parent].start,
+      (size_t) (tokens[parent].end - tokens[parent].start), seed).lo;
+}
+
+int jlite_shape_init(jlite_shape_t *shape, jlite_shape_entry_t *entries,
+    int num_entries)
+{
+  if (!shape || !entries || num_entries <= 0 ||
+      (num_entries & (num_entries - 1)))
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  memset(shape, 0, sizeof(*shape));
+  memset(entries, 0, (size_t) num_entries * sizeof(*entries));
+  shape->entries = entries;
+  shape->mask = (uint32_t) num_entries - 1;
+  return JLITE_OK;
+}
+
+int jlite_shape_attach(jliteobj_t *jsonobj, jlite_shape_t *shape)
+{
+  if (!jsonobj || (shape && !shape->entries))
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jsonobj->shape = shape;
+  return JLITE_OK;
+}
+
+int jlite_shape_get_stats(jlite_shape_t *shape, jlite_shape_stats_t *stats)
+{
+  if (!shape || !stats)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  *stats = shape->stats;
+  return JLITE_OK;
+}
+
+int jlite_shape_predict(jlite_shape_t *shape, const jliteobj_t *jsonobj,
+    const char *key, jlite_shape_probe_t *probe)
+{
+  if (!shape || !jsonobj || !key || !probe)
+  {
+    return -1;
+  }
+
+  const jlitetok_t *tokens = jsonobj->tokens;
+  size_t key_len = strlen(key);
+  uint64_t hash = jlite_hash_bytes(key, key_len,
+      jlite_shape_context(jsonobj)).lo;
+  int pos = 0;
+
+  probe->tag = (uint32_t) (hash >> 32) | 1;
+  probe->entry = &shape->entries[(uint32_t) hash & shape->mask];
+  if (probe->entry->tag != probe->tag)
+  {
+    shape->stats.cold++;
+    return -1;
+  }
+
+  /* A key token whose parent is the object is one of its member keys. */
+  pos = jsonobj->cur_pos + probe->entry->offset;
+  if (pos < jsonobj->num_tokens &&
+      tokens[pos].parent == jsonobj->cur_pos - 1 &&
+      tokens[pos].type == JSMN_STRING &&
+      (size_t) (tokens[pos].end - tokens[pos].start) == key_len &&
+      !memcmp(jsonobj->jsonstr + tokens[pos].start, key, key_len))
+  {
+    shape->stats.hits++;
+    return pos;
+  }
+
+  shape->stats.misses++;
+  return -1;
+}
+
+void jlite_shape_learn(const jlite_shape_probe_t *probe,
+    const jliteobj_t *jsonobj, int pos)
+{
+  if (!probe || !probe->entry || !jsonobj || pos < jsonobj->cur_pos)
+  {
+    return;
+  }
+
+  probe->entry->tag = probe->tag;
+  probe->entry->offset = pos - jsonobj->cur_pos;
+}
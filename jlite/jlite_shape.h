@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_shape.h
+ * @brief Shape cache predicting key positions across documents.
+ *
+ */
+
+#ifndef _JLITE_SHAPE_H
+#define _JLITE_SHAPE_H
+
+#include <stdint.h>
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Shape cache counters.
+ *
+ */
+
+typedef struct
+{
+  unsigned long hits;    /* Lookups answered by the predicted token. */
+  unsigned long misses;  /* Predictions which did not match, then scanned. */
+  unsigned long cold;    /* Lookups without a prediction, then scanned. */
+} jlite_shape_stats_t;
+
+/**
+ * @brief One learned key position, private to the shape cache.
+ *
+ */
+
+typedef struct
+{
+  uint32_t tag;
+  int offset;
+} jlite_shape_entry_t;
+
+/**
+ * @brief Shape cache over a caller-provided entry table.
+ *
+ */
+
+typedef struct jlite_shape
+{
+  jlite_shape_entry_t *entries;
+  uint32_t mask;
+  jlite_shape_stats_t stats;
+} jlite_shape_t;
+
+/**
+ * @brief Initialize a shape cache.
+ *
+ * Each entry remembers, for one key in one kind of object, the token
+ * offset of the key from the start of the object. Objects are told apart
+ * by the key they are stored under, so for documents of one schema the
+ * entries learned on the first document predict every later lookup.
+ * Predictions are always checked against the key, so a stale or shared
+ * entry costs a scan, never a wrong result.
+ *
+ * @param shape Pointer to shape cache.
+ * @param entries Entry table, owned by the caller while the shape is used.
+ * @param num_entries Number of entries, a power of two.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_shape_init(jlite_shape_t *shape, jlite_shape_entry_t *entries,
+    int num_entries);
+
+/**
+ * @brief Use a shape cache for the key lookups of a JSON object.
+ *
+ * jlite_parse_init() detaches any shape, so attach it again after every
+ * parse. One shape can serve any number of documents in turn, but not
+ * several threads at once.
+ *
+ * @param jsonobj Pointer to JSON object.
+ * @param shape Pointer to shape cache, NULL to detach.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_shape_attach(jliteobj_t *jsonobj, jlite_shape_t *shape);
+
+/**
+ * @brief Get the shape cache counters.
+ *
+ * @param shape Pointer to shape cache.
+ * @param stats Pointer to stats structure to fill.
+ *
+ * @return errcode
+ *
+ */
+
+int jlite_shape_get_stats(jlite_shape_t *shape, jlite_shape_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_SHAPE_H */
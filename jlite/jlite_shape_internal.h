@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_shape_internal.h
+ * @brief Shape cache hooks used by the key lookup of jlite.c.
+ *
+ * Only jlite.c and jlite_shape.c include this header, it is private to
+ * the library.
+ *
+ */
+
+#ifndef _JLITE_SHAPE_INTERNAL_H
+#define _JLITE_SHAPE_INTERNAL_H
+
+#include "jlite_shape.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lookup state passed from prediction to learning.
+ *
+ */
+
+typedef struct
+{
+  jlite_shape_entry_t *entry;
+  uint32_t tag;
+} jlite_shape_probe_t;
+
+/**
+ * @brief Look up the predicted position of a key in the current object.
+ *
+ * Used by the key lookup of jlite.c; on a miss the caller scans and
+ * passes the found position to jlite_shape_learn().
+ *
+ * @param shape Pointer to shape cache.
+ * @param jsonobj Pointer to JSON object, cur_pos inside an object.
+ * @param key Key to look up.
+ * @param probe Lookup state for jlite_shape_learn().
+ *
+ * @return token position of the key, or -1 without a matching prediction.
+ *
+ */
+
+int jlite_shape_predict(jlite_shape_t *shape, const jliteobj_t *jsonobj,
+    const char *key, jlite_shape_probe_t *probe);
+
+/**
+ * @brief Record where a key was found after a missed prediction.
+ *
+ * @param probe Lookup state from jlite_shape_predict().
+ * @param jsonobj Pointer to JSON object.
+ * @param pos Token position of the key.
+ *
+ */
+
+void jlite_shape_learn(const jlite_shape_probe_t *probe,
+    const jliteobj_t *jsonobj, int pos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_SHAPE_INTERNAL_H */
@@ -0,0 +1,280 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_simd.h
+ * @brief Internal helpers which scan JSON text several bytes at a time.
+ *
+ * SSE2 is used when the compiler targets it, otherwise the helpers fall
+ * back to 64-bit SWAR (SIMD within a register) arithmetic, which works on
+ * any target. This header is private to the library.
+ *
+ */
+
+#ifndef _JLITE_SIMD_H
+#define _JLITE_SIMD_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) && !defined(JLITE_NO_SIMD)
+#include <emmintrin.h>
+#define JLITE_SIMD_SSE2 1
+#endif
+
+#define JLITE_SWAR_ONES 0x0101010101010101ULL
+#define JLITE_SWAR_HIGHS 0x8080808080808080ULL
+
+static inline uint64_t jlite_swar_load(const char *ptr)
+{
+  uint64_t word = 0;
+
+  memcpy(&word, ptr, sizeof(word));
+  return word;
+}
+
+/* Non-zero if any byte of word is zero. */
+static inline uint64_t jlite_swar_has_zero(uint64_t word)
+{
+  return (word - JLITE_SWAR_ONES) & ~word & JLITE_SWAR_HIGHS;
+}
+
+/* Non-zero if any byte of word equals c. */
+static inline uint64_t jlite_swar_has_byte(uint64_t word, unsigned char c)
+{
+  return jlite_swar_has_zero(word ^ (JLITE_SWAR_ONES * c));
+}
+
+/* Non-zero if any byte of word is below n (n <= 128) or is not ASCII. */
+static inline uint64_t jlite_swar_has_less_or_high(uint64_t word,
+    unsigned char n)
+{
+  return ((word - JLITE_SWAR_ONES * n) | word) & JLITE_SWAR_HIGHS;
+}
+
+/* High bit set in exactly the bytes of word which equal c. */
+static inline uint64_t jlite_swar_eq(uint64_t word, unsigned char c)
+{
+  const uint64_t lows = JLITE_SWAR_ONES * 0x7F;
+  uint64_t diff = word ^ (JLITE_SWAR_ONES * c);
+
+  return ~(((diff & lows) + lows) | diff) & JLITE_SWAR_HIGHS;
+}
+
+/* Gather the high bit of each byte into bit i for byte i. */
+static inline unsigned int jlite_swar_movemask(uint64_t highs)
+{
+  return (unsigned int) (((highs >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define JLITE_SWAR_LITTLE_ENDIAN 1
+
+/* Non-zero if all eight bytes of word are ASCII digits. */
+static inline int jlite_swar_is_8_digits(uint64_t word)
+{
+  return ((word & 0xF0F0F0F0F0F0F0F0ULL) |
+      (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+      0x3333333333333333ULL;
+}
+
+/* Convert eight ASCII digits at once, first digit in the lowest byte. */
+static inline uint32_t jlite_swar_parse_8_digits(uint64_t word)
+{
+  word = (word & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+  word = (word & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+  return (uint32_t) ((word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+#endif
+
+/*
+ * Return the first position at or after pos holding a byte which needs
+ * attention inside a string: a quote, a backslash, a control character or
+ * a non-ASCII byte. Returns len if there is none.
+ */
+static inline int jlite_simd_string_scan(const char *jsonstr, int pos,
+    int len)
+{
+#ifdef JLITE_SIMD_SSE2
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i bslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(0x20);
+  __m128i chunk;
+  int mask = 0;
+
+  for (; pos + 16 <= len; pos += 16)
+  {
+    chunk = _mm_loadu_si128((const __m128i *) (jsonstr + pos));
+    /* Signed compare catches both control and non-ASCII bytes. */
+    mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+            _mm_cmpeq_epi8(chunk, bslash)),
+        _mm_cmplt_epi8(chunk, space)));
+    if (mask)
+    {
+      return pos + __builtin_ctz((unsigned int) mask);
+    }
+  }
+#endif
+
+  for (; pos + 8 <= len; pos += 8)
+  {
+    uint64_t word = jlite_swar_load(jsonstr + pos);
+
+    if (jlite_swar_has_byte(word, '"') | jlite_swar_has_byte(word, '\\') |
+        jlite_swar_has_less_or_high(word, 0x20))
+    {
+      break;
+    }
+  }
+
+  for (; pos < len; pos++)
+  {
+    unsigned char c = (unsigned char) jsonstr[pos];
+
+    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80)
+    {
+      return pos;
+    }
+  }
+  return len;
+}
+
+/*
+ * Return the first position at or after pos holding a quote or a bracket,
+ * the bytes which matter when skipping a container. Returns len if there
+ * is none. '[' and '{' (and ']' and '}') differ only in bit 0x20.
+ */
+static inline int jlite_simd_struct_scan(const char *jsonstr, int pos,
+    int len)
+{
+#ifdef JLITE_SIMD_SSE2
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i lower = _mm_set1_epi8(0x20);
+  const __m128i open = _mm_set1_epi8('{');
+  const __m128i close = _mm_set1_epi8('}');
+  __m128i chunk;
+  __m128i folded;
+  int mask = 0;
+
+  for (; pos + 16 <= len; pos += 16)
+  {
+    chunk = _mm_loadu_si128((const __m128i *) (jsonstr + pos));
+    folded = _mm_or_si128(chunk, lower);
+    mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+        _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+            _mm_cmpeq_epi8(folded, close))));
+    if (mask)
+    {
+      return pos + __builtin_ctz((unsigned int) mask);
+    }
+  }
+#endif
+
+  for (; pos + 8 <= len; pos += 8)
+  {
+    uint64_t word = jlite_swar_load(jsonstr + pos);
+    uint64_t folded = word | (JLITE_SWAR_ONES * 0x20);
+
+    if (jlite_swar_has_byte(word, '"') | jlite_swar_has_byte(folded, '{') |
+        jlite_swar_has_byte(folded, '}'))
+    {
+      break;
+    }
+  }
+
+  for (; pos < len; pos++)
+  {
+    char c = (char) (jsonstr[pos] | 0x20);
+
+    if (jsonstr[pos] == '"' || c == '{' || c == '}')
+    {
+      return pos;
+    }
+  }
+  return len;
+}
+
+/*
+ * Return the first position at or after pos which is not a JSON
+ * whitespace character, or len.
+ */
+static inline int jlite_simd_skip_ws(const char *jsonstr, int pos, int len)
+{
+  while (pos < len)
+  {
+    switch (jsonstr[pos])
+    {
+      case ' ': case '\t': case '\r': case '\n':
+        pos++;
+        break;
+      default:
+        return pos;
+    }
+  }
+  return pos;
+}
+
+/*
+ * Return the first position at or after pos which is not an ASCII digit,
+ * or len.
+ */
+static inline int jlite_simd_skip_digits(const char *jsonstr, int pos,
+    int len)
+{
+#ifdef JLITE_SIMD_SSE2
+  /* Bytes above 0x7F compare as negative, so signed compares suffice. */
+  const __m128i below = _mm_set1_epi8('0' - 1);
+  const __m128i above = _mm_set1_epi8('9' + 1);
+  __m128i chunk;
+  int mask = 0;
+
+  for (; pos + 16 <= len; pos += 16)
+  {
+    chunk = _mm_loadu_si128((const __m128i *) (jsonstr + pos));
+    mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(chunk, below),
+        _mm_cmplt_epi8(chunk, above))) ^ 0xFFFF;
+    if (mask)
+    {
+      return pos + __builtin_ctz((unsigned int) mask);
+    }
+  }
+#elif defined(JLITE_SWAR_LITTLE_ENDIAN)
+  for (; pos + 8 <= len; pos += 8)
+  {
+    if (!jlite_swar_is_8_digits(jlite_swar_load(jsonstr + pos)))
+    {
+      break;
+    }
+  }
+#endif
+
+  while (pos < len && jsonstr[pos] >= '0' && jsonstr[pos] <= '9')
+  {
+    pos++;
+  }
+  return pos;
+}
+
+#endif /* _JLITE_SIMD_H */
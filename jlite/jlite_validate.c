@@ -0,0 +1,505 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_validate.c
+ * @brief This file contains the validation-only API definition.
+ *
+ */
+
+#include <string.h>
+#include "jlite_validate.h"
+#include "jlite_simd.h"
+
+#define JLITE_VALIDATE_STACK_WORDS ((JLITE_VALIDATE_MAX_DEPTH + 63) / 64)
+
+/*
+ * Container stack of the validator, one bit per nesting level, set for
+ * objects and clear for arrays.
+ */
+typedef struct
+{
+  uint64_t bits[JLITE_VALIDATE_STACK_WORDS];
+  int depth;
+} jlite_validate_stack_t;
+
+static int jlite_validate_push(jlite_validate_stack_t *stack, int is_object)
+{
+  uint64_t bit = 0;
+
+  if (stack->depth >= JLITE_VALIDATE_MAX_DEPTH)
+  {
+    return -JLITE_E_NO_BUFFER_MEM;
+  }
+
+  bit = 1ULL << (stack->depth & 63);
+  if (is_object)
+  {
+    stack->bits[stack->depth >> 6] |= bit;
+  }
+  else
+  {
+    stack->bits[stack->depth >> 6] &= ~bit;
+  }
+  stack->depth++;
+  return JLITE_OK;
+}
+
+static int jlite_validate_top_is_object(const jlite_validate_stack_t *stack)
+{
+  int top = stack->depth - 1;
+
+  return (int) ((stack->bits[top >> 6] >> (top & 63)) & 1);
+}
+
+static int jlite_validate_is_hex(char c)
+{
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+      (c >= 'A' && c <= 'F');
+}
+
+static int jlite_validate_is_cont(const char *jsonstr, int pos, int len)
+{
+  return pos < len && ((unsigned char) jsonstr[pos] & 0xC0) == 0x80;
+}
+
+/*
+ * Return the length of the well-formed UTF-8 sequence at pos (Unicode
+ * table 3-7: no overlong forms, no surrogates, nothing above U+10FFFF),
+ * or 0 if the sequence is invalid.
+ */
+static int jlite_validate_utf8(const char *jsonstr, int pos, int len)
+{
+  unsigned char lead = (unsigned char) jsonstr[pos];
+  unsigned char next = 0;
+
+  if (lead >= 0xC2 && lead <= 0xDF)
+  {
+    return jlite_validate_is_cont(jsonstr, pos + 1, len) ? 2 : 0;
+  }
+
+  if (pos + 1 >= len)
+  {
+    return 0;
+  }
+  next = (unsigned char) jsonstr[pos + 1];
+
+  if (lead >= 0xE0 && lead <= 0xEF)
+  {
+    if ((lead == 0xE0 && next < 0xA0) || (lead == 0xED && next > 0x9F) ||
+        (next & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+    return jlite_validate_is_cont(jsonstr, pos + 2, len) ? 3 : 0;
+  }
+
+  if (lead >= 0xF0 && lead <= 0xF4)
+  {
+    if ((lead == 0xF0 && next < 0x90) || (lead == 0xF4 && next > 0x8F) ||
+        (next & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+    return jlite_validate_is_cont(jsonstr, pos + 2, len) &&
+        jlite_validate_is_cont(jsonstr, pos + 3, len) ? 4 : 0;
+  }
+
+  return 0;
+}
+
+/*
+ * Validate the string starting at the opening quote at *pos. On success
+ * *pos is moved after the closing quote, on error it is the error offset.
+ */
+static int jlite_validate_string(const char *jsonstr, int len, int *pos)
+{
+  int cur = *pos + 1;
+  int seq = 0;
+  int i = 0;
+  unsigned char c = 0;
+
+  for (;;)
+  {
+    cur = jlite_simd_string_scan(jsonstr, cur, len);
+    if (cur >= len)
+    {
+      *pos = len;
+      return -JLITE_E_INVALID_JSON;
+    }
+
+    c = (unsigned char) jsonstr[cur];
+    if (c == '"')
+    {
+      *pos = cur + 1;
+      return JLITE_OK;
+    }
+
+    if (c == '\\')
+    {
+      if (cur + 1 >= len)
+      {
+        *pos = len;
+        return -JLITE_E_INVALID_JSON;
+      }
+      switch (jsonstr[cur + 1])
+      {
+        case '"': case '\\': case '/': case 'b':
+        case 'f': case 'n': case 'r': case 't':
+          cur += 2;
+          break;
+        case 'u':
+          for (i = 2; i < 6; i++)
+          {
+            if (cur + i >= len)
+            {
+              *pos = len;
+              return -JLITE_E_INVALID_JSON;
+            }
+            if (!jlite_validate_is_hex(jsonstr[cur + i]))
+            {
+              *pos = cur + i;
+              return -JLITE_E_INVALID_JSON;
+            }
+          }
+          cur += 6;
+          break;
+        default:
+          *pos = cur + 1;
+          return -JLITE_E_INVALID_JSON;
+      }
+    }
+    else if (c < 0x20)
+    {
+      *pos = cur;
+      return -JLITE_E_INVALID_JSON;
+    }
+    else
+    {
+      seq = jlite_validate_utf8(jsonstr, cur, len);
+      if (!seq)
+      {
+        *pos = cur;
+        return -JLITE_E_INVALID_UTF8;
+      }
+      cur += seq;
+    }
+  }
+}
+
+static int jlite_validate_digits(const char *jsonstr, int len, int cur)
+{
+  while (cur < len && jsonstr[cur] >= '0' && jsonstr[cur] <= '9')
+  {
+    cur++;
+  }
+  return cur;
+}
+
+/*
+ * Validate the number starting at *pos. The character following it is
+ * checked by the caller like after any other value.
+ */
+static int jlite_validate_number(const char *jsonstr, int len, int *pos)
+{
+  int cur = *pos;
+  int digits = 0;
+
+  if (jsonstr[cur] == '-')
+  {
+    cur++;
+  }
+
+  if (cur < len && jsonstr[cur] == '0')
+  {
+    cur++;
+  }
+  else if (cur < len && jsonstr[cur] >= '1' && jsonstr[cur] <= '9')
+  {
+    cur = jlite_validate_digits(jsonstr, len, cur + 1);
+  }
+  else
+  {
+    *pos = cur;
+    return -JLITE_E_INVALID_JSON;
+  }
+
+  if (cur < len && jsonstr[cur] == '.')
+  {
+    digits = cur + 1;
+    cur = jlite_simd_skip_digits(jsonstr, digits, len);
+    if (cur == digits)
+    {
+      *pos = cur;
+      return -JLITE_E_INVALID_JSON;
+    }
+  }
+
+  if (cur < len && (jsonstr[cur] == 'e' || jsonstr[cur] == 'E'))
+  {
+    cur++;
+    if (cur < len && (jsonstr[cur] == '+' || jsonstr[cur] == '-'))
+    {
+      cur++;
+    }
+    digits = cur;
+    cur = jlite_validate_digits(jsonstr, len, digits);
+    if (cur == digits)
+    {
+      *pos = cur;
+      return -JLITE_E_INVALID_JSON;
+    }
+  }
+
+  *pos = cur;
+  return JLITE_OK;
+}
+
+static int jlite_validate_literal(const char *jsonstr, int len, int *pos,
+    const char *literal, int literal_len)
+{
+  int i = 0;
+
+  for (i = 0; i < literal_len; i++)
+  {
+    if (*pos + i >= len || jsonstr[*pos + i] != literal[i])
+    {
+      *pos += i;
+      return -JLITE_E_INVALID_JSON;
+    }
+  }
+  *pos += literal_len;
+  return JLITE_OK;
+}
+
+/*
+ * Output of the validator when it also minifies: everything between mark
+ * and the next run of whitespace is copied to out when that run is
+ * skipped. out may alias the input since it never gets ahead of it.
+ */
+typedef struct
+{
+  char *out;
+  int out_len;
+  int mark;
+} jlite_validate_emit_t;
+
+static inline int jlite_validate_ws(jlite_validate_emit_t *emit,
+    const char *jsonstr, int pos, int len)
+{
+  int next = jlite_simd_skip_ws(jsonstr, pos, len);
+
+  if (emit->out && next != pos)
+  {
+    memmove(emit->out + emit->out_len, jsonstr + emit->mark,
+        (size_t) (pos - emit->mark));
+    emit->out_len += pos - emit->mark;
+    emit->mark = next;
+  }
+  return next;
+}
+
+static int jlite_validate_run(const char *jsonstr, int len,
+    jlite_validate_emit_t *emit, int *err_offset)
+{
+  jlite_validate_stack_t stack;
+  int pos = 0;
+  int ret = JLITE_OK;
+
+  stack.depth = 0;
+
+value:
+  pos = jlite_validate_ws(emit, jsonstr, pos, len);
+  if (pos >= len)
+  {
+    ret = -JLITE_E_INVALID_JSON;
+    goto out;
+  }
+
+  switch (jsonstr[pos])
+  {
+    case '{':
+      ret = jlite_validate_push(&stack, 1);
+      if (ret != JLITE_OK)
+      {
+        goto out;
+      }
+      pos = jlite_validate_ws(emit, jsonstr, pos + 1, len);
+      if (pos < len && jsonstr[pos] == '}')
+      {
+        pos++;
+        stack.depth--;
+        goto after_value;
+      }
+      goto member;
+    case '[':
+      ret = jlite_validate_push(&stack, 0);
+      if (ret != JLITE_OK)
+      {
+        goto out;
+      }
+      pos = jlite_validate_ws(emit, jsonstr, pos + 1, len);
+      if (pos < len && jsonstr[pos] == ']')
+      {
+        pos++;
+        stack.depth--;
+        goto after_value;
+      }
+      goto value;
+    case '"':
+      ret = jlite_validate_string(jsonstr, len, &pos);
+      break;
+    case 't':
+      ret = jlite_validate_literal(jsonstr, len, &pos, "true", 4);
+      break;
+    case 'f':
+      ret = jlite_validate_literal(jsonstr, len, &pos, "false", 5);
+      break;
+    case 'n':
+      ret = jlite_validate_literal(jsonstr, len, &pos, "null", 4);
+      break;
+    case '-': case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      ret = jlite_validate_number(jsonstr, len, &pos);
+      break;
+    default:
+      ret = -JLITE_E_INVALID_JSON;
+      break;
+  }
+  if (ret != JLITE_OK)
+  {
+    goto out;
+  }
+
+after_value:
+  pos = jlite_validate_ws(emit, jsonstr, pos, len);
+  if (stack.depth == 0)
+  {
+    if (pos != len)
+    {
+      ret = -JLITE_E_INVALID_JSON;
+    }
+    goto out;
+  }
+  if (pos >= len)
+  {
+    ret = -JLITE_E_INVALID_JSON;
+    goto out;
+  }
+
+  switch (jsonstr[pos])
+  {
+    case ',':
+      pos++;
+      if (jlite_validate_top_is_object(&stack))
+      {
+        pos = jlite_validate_ws(emit, jsonstr, pos, len);
+        goto member;
+      }
+      goto value;
+    case '}':
+      if (!jlite_validate_top_is_object(&stack))
+      {
+        ret = -JLITE_E_INVALID_JSON;
+        goto out;
+      }
+      pos++;
+      stack.depth--;
+      goto after_value;
+    case ']':
+      if (jlite_validate_top_is_object(&stack))
+      {
+        ret = -JLITE_E_INVALID_JSON;
+        goto out;
+      }
+      pos++;
+      stack.depth--;
+      goto after_value;
+    default:
+      ret = -JLITE_E_INVALID_JSON;
+      goto out;
+  }
+
+member:
+  /* pos is at the key of an object member, whitespace already skipped. */
+  if (pos >= len || jsonstr[pos] != '"')
+  {
+    ret = -JLITE_E_INVALID_JSON;
+    goto out;
+  }
+  ret = jlite_validate_string(jsonstr, len, &pos);
+  if (ret != JLITE_OK)
+  {
+    goto out;
+  }
+  pos = jlite_validate_ws(emit, jsonstr, pos, len);
+  if (pos >= len || jsonstr[pos] != ':')
+  {
+    ret = -JLITE_E_INVALID_JSON;
+    goto out;
+  }
+  pos++;
+  goto value;
+
+out:
+  if (ret == JLITE_OK && emit->out)
+  {
+    memmove(emit->out + emit->out_len, jsonstr + emit->mark,
+        (size_t) (len - emit->mark));
+    emit->out_len += len - emit->mark;
+  }
+  if (err_offset)
+  {
+    *err_offset = ret == JLITE_OK ? -1 : pos;
+  }
+  return ret;
+}
+
+int jlite_validate(const char *jsonstr, int jsonstr_len, int *err_offset)
+{
+  if (!jsonstr || jsonstr_len <= 0)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_validate_emit_t emit = { NULL, 0, 0 };
+
+  return jlite_validate_run(jsonstr, jsonstr_len, &emit, err_offset);
+}
+
+int jlite_validate_minify(const char *jsonstr, int jsonstr_len, char *out,
+    int *out_len, int *err_offset)
+{
+  if (!jsonstr || jsonstr_len <= 0 || !out || !out_len)
+  {
+    return -JLITE_E_INVALID_PARAM;
+  }
+
+  jlite_validate_emit_t emit = { out, 0, 0 };
+  int ret = 0;
+
+  ret = jlite_validate_run(jsonstr, jsonstr_len, &emit, err_offset);
+  *out_len = ret == JLITE_OK ? emit.out_len : 0;
+  return ret;
+}
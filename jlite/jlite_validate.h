@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Raunak Laddha
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * @file jlite_validate.h
+ * @brief Validation-only API which checks a JSON string without tokens.
+ *
+ */
+
+#ifndef _JLITE_VALIDATE_H
+#define _JLITE_VALIDATE_H
+
+#include "jlite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum nesting of objects and arrays accepted by jlite_validate(). */
+#ifndef JLITE_VALIDATE_MAX_DEPTH
+#define JLITE_VALIDATE_MAX_DEPTH 1024
+#endif
+
+/**
+ * @brief Validate a JSON string.
+ *
+ * This checks the string against the strict RFC 8259 grammar (any value at
+ * the top level, no trailing commas, numbers and literals as specified,
+ * only whitespace around the value) and checks that strings are valid
+ * UTF-8 without raw control characters. No tokens are allocated and the
+ * text is scanned several bytes at a time.
+ *
+ * @param jsonstr Pointer to JSON string.
+ * @param jsonstr_len Length of JSON string.
+ * @param err_offset Pointer to an int variable to get the offset of the
+ * first invalid byte, may be NULL. Set to jsonstr_len for truncated input.
+ *
+ * @return errcode, JLITE_E_INVALID_JSON for grammar errors,
+ * JLITE_E_INVALID_UTF8 for encoding errors, JLITE_E_NO_BUFFER_MEM if the
+ * nesting is deeper than JLITE_VALIDATE_MAX_DEPTH.
+ *
+ */
+
+int jlite_validate(const char *jsonstr, int jsonstr_len, int *err_offset);
+
+/**
+ * @brief Validate a JSON string and copy it without insignificant
+ * whitespace in the same pass.
+ *
+ * Validation is the same as jlite_validate(). Whitespace outside strings is
+ * dropped, everything else is copied unchanged, so the output parses to the
+ * same tokens as the input.
+ *
+ * @param jsonstr Pointer to JSON string.
+ * @param jsonstr_len Length of JSON string.
+ * @param out Output buffer of at least jsonstr_len bytes. It may be
+ * jsonstr itself for in-place operation. It is not NUL terminated, and
+ * holds partial output if the input is invalid.
+ * @param out_len Pointer to an int variable to get the output length.
+ * @param err_offset As for jlite_validate(), may be NULL.
+ *
+ * @return errcode as for jlite_validate()
+ *
+ */
+
+int jlite_validate_minify(const char *jsonstr, int jsonstr_len, char *out,
+    int *out_len, int *err_offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _JLITE_VALIDATE_H */
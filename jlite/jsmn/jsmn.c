@@ -12,6 +12,7 @@ static jsmntok_t *jsmn_alloc_token(jsmn_parser *parser,
 	tok = &tokens[parser->toknext++];
 	tok->start = tok->end = -1;
 	tok->size = 0;
+	tok->kind = JSMN_KIND_NONE;
 #ifdef JSMN_PARENT_LINKS
 	tok->parent = -1;
 #endif
@@ -22,7 +23,7 @@ static jsmntok_t *jsmn_alloc_token(jsmn_parser *parser,
  * Fills token type and boundaries.
  */
 static void jsmn_fill_token(jsmntok_t *token, jsmntype_t type,
-                            int start, int end) {
+                            jsmnint_t start, jsmnint_t end) {
 	token->type = type;
 	token->start = start;
 	token->end = end;
@@ -35,9 +36,17 @@ static void jsmn_fill_token(jsmntok_t *token, jsmntype_t type,
 static int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
 		size_t len, jsmntok_t *tokens, size_t num_tokens) {
 	jsmntok_t *token;
-	int start;
+	jsmnint_t start;
+	jsmnkind_t kind = JSMN_KIND_OTHER;
+	size_t mark = 0;
 
 	start = parser->pos;
+	/* Numbers and literals are classified while they are scanned, the
+	 * loop below only has to find the delimiter. */
+	if (tokens != NULL) {
+		kind = jsmn_scan_kind(js, len, parser->pos, &mark);
+		parser->pos = (jsmnuint_t) mark;
+	}
 
 	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
 		switch (js[parser->pos]) {
@@ -71,6 +80,8 @@ found:
 		return JSMN_ERROR_NOMEM;
 	}
 	jsmn_fill_token(token, JSMN_PRIMITIVE, start, parser->pos);
+	token->kind = (unsigned char) ((size_t) parser->pos == mark ? kind :
+			JSMN_KIND_OTHER);
 #ifdef JSMN_PARENT_LINKS
 	token->parent = parser->toksuper;
 #endif
@@ -85,7 +96,7 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
 		size_t len, jsmntok_t *tokens, size_t num_tokens) {
 	jsmntok_t *token;
 
-	int start = parser->pos;
+	jsmnint_t start = parser->pos;
 
 	parser->pos++;
 
@@ -148,12 +159,12 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
 /**
  * Parse JSON string and fill tokens.
  */
-int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
-		jsmntok_t *tokens, unsigned int num_tokens) {
+jsmnint_t jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_t *tokens, jsmnuint_t num_tokens) {
 	int r;
-	int i;
+	jsmnint_t i;
 	jsmntok_t *token;
-	int count = parser->toknext;
+	jsmnint_t count = parser->toknext;
 
 	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
 		char c;
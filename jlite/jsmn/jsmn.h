@@ -9,6 +9,19 @@ extern "C" {
 
 #define JSMN_PARENT_LINKS
 
+/*
+ * Offsets, sizes and token indices. Define JSMN_LARGE for documents of
+ * 2 GB and more, which makes them pointer sized; tokens then take 40 bytes
+ * instead of 20, so the default stays 32-bit.
+ */
+#ifdef JSMN_LARGE
+typedef ptrdiff_t jsmnint_t;
+typedef size_t jsmnuint_t;
+#else
+typedef int jsmnint_t;
+typedef unsigned int jsmnuint_t;
+#endif
+
 /**
  * JSON type identifier. Basic types are:
  * 	o Object
@@ -24,6 +37,24 @@ typedef enum {
 	JSMN_PRIMITIVE = 4
 } jsmntype_t;
 
+/**
+ * Kind of a JSMN_PRIMITIVE token, set by the tokenizer so that readers can
+ * tell primitives apart without comparing text. JSMN_KIND_INT is an integer
+ * which fits int64_t, JSMN_KIND_FLOAT any other JSON number (fraction,
+ * exponent or a wider integer). Other bare words, which the lenient grammar
+ * accepts, are JSMN_KIND_OTHER. Objects, arrays and strings are
+ * JSMN_KIND_NONE.
+ */
+typedef enum {
+	JSMN_KIND_NONE = 0,
+	JSMN_KIND_TRUE = 1,
+	JSMN_KIND_FALSE = 2,
+	JSMN_KIND_NULL = 3,
+	JSMN_KIND_INT = 4,
+	JSMN_KIND_FLOAT = 5,
+	JSMN_KIND_OTHER = 6
+} jsmnkind_t;
+
 enum jsmnerr {
 	/* Not enough tokens were provided */
 	JSMN_ERROR_NOMEM = -1,
@@ -35,17 +66,20 @@ enum jsmnerr {
 
 /**
  * JSON token description.
- * type		type (object, array, string etc.)
+ * type		type (object, array, string etc.), a jsmntype_t
+ * kind		kind of primitive (true, false, null, int, float), a jsmnkind_t
  * start	start position in JSON data string
  * end		end position in JSON data string
+ * Type and kind are stored as bytes so the token keeps its size.
  */
 typedef struct {
-	jsmntype_t type;
-	int start;
-	int end;
-	int size;
+	unsigned char type;
+	unsigned char kind;
+	jsmnint_t start;
+	jsmnint_t end;
+	jsmnint_t size;
 #ifdef JSMN_PARENT_LINKS
-	int parent;
+	jsmnint_t parent;
 #endif
 } jsmntok_t;
 
@@ -54,11 +88,102 @@ typedef struct {
  * the string being parsed now and current position in that string
  */
 typedef struct {
-	unsigned int pos; /* offset in the JSON string */
-	unsigned int toknext; /* next token to allocate */
-	int toksuper; /* superior token node, e.g parent object or array */
+	jsmnuint_t pos; /* offset in the JSON string */
+	jsmnuint_t toknext; /* next token to allocate */
+	jsmnint_t toksuper; /* superior token node, e.g parent object or array */
 } jsmn_parser;
 
+/**
+ * Scan the number or literal starting at js[pos], pos < len. Returns its kind
+ * and sets *end past it; the primitive has that kind only if it ends there,
+ * otherwise it is JSMN_KIND_OTHER.
+ */
+static inline jsmnkind_t jsmn_scan_kind(const char *js, size_t len,
+		size_t pos, size_t *end) {
+	static const char int64_min[] = "9223372036854775808";
+	size_t digits;
+	size_t mark;
+	size_t i = pos;
+	int negative = 0;
+	int real = 0;
+
+	*end = pos;
+	switch (js[pos]) {
+		case 't':
+			if (len - pos >= 4 && js[pos + 1] == 'r' && js[pos + 2] == 'u' &&
+					js[pos + 3] == 'e') {
+				*end = pos + 4;
+				return JSMN_KIND_TRUE;
+			}
+			return JSMN_KIND_OTHER;
+		case 'f':
+			if (len - pos >= 5 && js[pos + 1] == 'a' && js[pos + 2] == 'l' &&
+					js[pos + 3] == 's' && js[pos + 4] == 'e') {
+				*end = pos + 5;
+				return JSMN_KIND_FALSE;
+			}
+			return JSMN_KIND_OTHER;
+		case 'n':
+			if (len - pos >= 4 && js[pos + 1] == 'u' && js[pos + 2] == 'l' &&
+					js[pos + 3] == 'l') {
+				*end = pos + 4;
+				return JSMN_KIND_NULL;
+			}
+			return JSMN_KIND_OTHER;
+		case '-':
+			negative = 1;
+			i++;
+			break;
+	}
+
+	/* -?[0-9]+(.[0-9]+)?([eE][+-]?[0-9]+)? */
+	for (mark = i; i < len && js[i] >= '0' && js[i] <= '9'; i++);
+	digits = i - mark;
+	if (digits == 0) {
+		return JSMN_KIND_OTHER;
+	}
+	if (i < len && js[i] == '.') {
+		for (mark = ++i; i < len && js[i] >= '0' && js[i] <= '9'; i++);
+		if (mark == i) {
+			return JSMN_KIND_OTHER;
+		}
+		real = 1;
+	}
+	if (i < len && (js[i] == 'e' || js[i] == 'E')) {
+		if (++i < len && (js[i] == '+' || js[i] == '-')) {
+			i++;
+		}
+		for (mark = i; i < len && js[i] >= '0' && js[i] <= '9'; i++);
+		if (mark == i) {
+			return JSMN_KIND_OTHER;
+		}
+		real = 1;
+	}
+	*end = i;
+	if (real || digits > 19) {
+		return JSMN_KIND_FLOAT;
+	}
+	/* 19 digits may not fit, compare against 2^63 (-2^63 fits). */
+	if (digits == 19) {
+		mark = pos + (size_t) negative;
+		for (i = 0; i < 19 && js[mark + i] == int64_min[i]; i++);
+		if (i == 19 ? !negative : js[mark + i] > int64_min[i]) {
+			return JSMN_KIND_FLOAT;
+		}
+	}
+	return JSMN_KIND_INT;
+}
+
+/**
+ * Classify the primitive js[0..len), len > 0.
+ */
+static inline jsmnkind_t jsmn_primitive_kind(const char *js, size_t len) {
+	size_t end;
+	jsmnkind_t kind = jsmn_scan_kind(js, len, 0, &end);
+
+	return end == len ? kind : JSMN_KIND_OTHER;
+}
+
 /**
  * Create JSON parser over an array of tokens
  */
@@ -68,8 +193,8 @@ void jsmn_init(jsmn_parser *parser);
  * Run JSON parser. It parses a JSON data string into and array of tokens, each describing
  * a single JSON object.
  */
-int jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
-		jsmntok_t *tokens, unsigned int num_tokens);
+jsmnint_t jsmn_parse(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_t *tokens, jsmnuint_t num_tokens);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,445 @@
+/*
+ * Policy-instantiated jsmn tokenizer.
+ *
+ * This header is a template: define the policy macros below and include it
+ * once per variant. Every policy is resolved by the preprocessor, so each
+ * instantiation carries no runtime tests for features it does not use, and
+ * any number of variants can coexist in one binary.
+ *
+ *	#define JSMN_TPL_NAME		jsmn_parse_lenient
+ *	#define JSMN_TPL_EMIT		1	0: only count tokens
+ *	#define JSMN_TPL_STRICT		0	1: RFC style primitives, see jsmn.c
+ *	#define JSMN_TPL_PARENT_LINKS	1	use and fill token->parent
+ *	#define JSMN_TPL_COMPACT	0	emit jsmntok_compact_t
+ *	#define JSMN_TPL_STORAGE	static
+ *	#include "jsmn_tpl.h"
+ *
+ * The generated function has the jsmn_parse signature with the token type
+ * selected by JSMN_TPL_COMPACT. Compact tokens keep 32-bit fields under
+ * JSMN_LARGE, so that variant is limited to documents below 2 GB, and have
+ * no room for the primitive kind. Counting variants ignore the token array
+ * and return the same count jsmn_parse does with tokens == NULL. Without
+ * parent links the parent field is left untouched and closing brackets are
+ * matched by scanning back through the tokens, which is quadratic on wide
+ * documents.
+ */
+
+#ifndef __JSMN_TPL_H_
+#define __JSMN_TPL_H_
+
+#include "jsmn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Compact token: 16 bytes instead of 20. Type and size share one word,
+ * use the accessors below.
+ */
+typedef struct {
+	int start;
+	int end;
+	unsigned int info;
+	int parent;
+} jsmntok_compact_t;
+
+#define JSMN_COMPACT_TYPE(t) ((jsmntype_t) ((t)->info & 7u))
+#define JSMN_COMPACT_SIZE(t) ((int) ((t)->info >> 3))
+
+#ifdef __cplusplus
+}
+#endif
+
+#define JSMN_TPL_CAT_(a, b) a##b
+#define JSMN_TPL_CAT(a, b) JSMN_TPL_CAT_(a, b)
+
+#endif /* __JSMN_TPL_H_ */
+
+#ifdef JSMN_TPL_NAME
+
+#ifndef JSMN_TPL_EMIT
+#define JSMN_TPL_EMIT 1
+#endif
+#ifndef JSMN_TPL_STRICT
+#define JSMN_TPL_STRICT 0
+#endif
+#ifndef JSMN_TPL_PARENT_LINKS
+#define JSMN_TPL_PARENT_LINKS 1
+#endif
+#ifndef JSMN_TPL_COMPACT
+#define JSMN_TPL_COMPACT 0
+#endif
+#ifndef JSMN_TPL_STORAGE
+#define JSMN_TPL_STORAGE static
+#endif
+
+#if JSMN_TPL_COMPACT
+#define JSMN_TPL_TOKEN jsmntok_compact_t
+#define JSMN_TPL_TYPE(t) JSMN_COMPACT_TYPE(t)
+#define JSMN_TPL_SIZE(t) JSMN_COMPACT_SIZE(t)
+#define JSMN_TPL_SIZE_INC(t) ((t)->info += 8u)
+#define JSMN_TPL_RESET(t) ((t)->info = 0u)
+#define JSMN_TPL_SET_TYPE(t, ty) ((t)->info = (unsigned int) (ty))
+#define JSMN_TPL_KINDS 0
+#else
+#define JSMN_TPL_TOKEN jsmntok_t
+#define JSMN_TPL_TYPE(t) ((t)->type)
+#define JSMN_TPL_SIZE(t) ((t)->size)
+#define JSMN_TPL_SIZE_INC(t) ((t)->size++)
+#define JSMN_TPL_RESET(t) ((t)->size = 0)
+#define JSMN_TPL_SET_TYPE(t, ty) ((t)->type = (unsigned char) (ty), \
+		(t)->kind = JSMN_KIND_NONE, (t)->size = 0)
+#define JSMN_TPL_KINDS JSMN_TPL_EMIT
+#endif
+
+#define JSMN_TPL_FN(suffix) JSMN_TPL_CAT(JSMN_TPL_NAME, suffix)
+
+#if JSMN_TPL_EMIT
+/**
+ * Allocates a fresh unused token from the token pool.
+ */
+static JSMN_TPL_TOKEN *JSMN_TPL_FN(_alloc_token)(jsmn_parser *parser,
+		JSMN_TPL_TOKEN *tokens, size_t num_tokens) {
+	JSMN_TPL_TOKEN *tok;
+	if (parser->toknext >= num_tokens) {
+		return NULL;
+	}
+	tok = &tokens[parser->toknext++];
+	tok->start = tok->end = -1;
+	JSMN_TPL_RESET(tok);
+#if JSMN_TPL_PARENT_LINKS
+	tok->parent = -1;
+#endif
+	return tok;
+}
+#endif
+
+/**
+ * Fills next available token with JSON primitive.
+ */
+static int JSMN_TPL_FN(_parse_primitive)(jsmn_parser *parser, const char *js,
+		size_t len, JSMN_TPL_TOKEN *tokens, size_t num_tokens) {
+	jsmnint_t start;
+#if JSMN_TPL_KINDS
+	jsmnkind_t kind;
+	size_t mark;
+#endif
+
+	start = parser->pos;
+#if JSMN_TPL_KINDS
+	/* Numbers and literals are classified while they are scanned, the
+	 * loop below only has to find the delimiter. */
+	kind = jsmn_scan_kind(js, len, parser->pos, &mark);
+	parser->pos = (jsmnuint_t) mark;
+#endif
+
+	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+		switch (js[parser->pos]) {
+#if !JSMN_TPL_STRICT
+			/* In strict mode primitive must be followed by "," or "}" or "]" */
+			case ':':
+#endif
+			case '\t' : case '\r' : case '\n' : case ' ' :
+			case ','  : case ']'  : case '}' :
+				goto found;
+		}
+		if (js[parser->pos] < 32 || js[parser->pos] >= 127) {
+			parser->pos = start;
+			return JSMN_ERROR_INVAL;
+		}
+	}
+#if JSMN_TPL_STRICT
+	/* In strict mode primitive must be followed by a comma/object/array */
+	parser->pos = start;
+	return JSMN_ERROR_PART;
+#endif
+
+found:
+#if JSMN_TPL_EMIT
+	{
+		JSMN_TPL_TOKEN *token;
+		token = JSMN_TPL_FN(_alloc_token)(parser, tokens, num_tokens);
+		if (token == NULL) {
+			parser->pos = start;
+			return JSMN_ERROR_NOMEM;
+		}
+		JSMN_TPL_SET_TYPE(token, JSMN_PRIMITIVE);
+		token->start = start;
+		token->end = parser->pos;
+#if JSMN_TPL_KINDS
+		token->kind = (unsigned char) ((size_t) parser->pos == mark ? kind :
+				JSMN_KIND_OTHER);
+#endif
+#if JSMN_TPL_PARENT_LINKS
+		token->parent = parser->toksuper;
+#endif
+	}
+#else
+	(void) tokens;
+	(void) num_tokens;
+#endif
+	parser->pos--;
+	return 0;
+}
+
+/**
+ * Fills next token with JSON string.
+ */
+static int JSMN_TPL_FN(_parse_string)(jsmn_parser *parser, const char *js,
+		size_t len, JSMN_TPL_TOKEN *tokens, size_t num_tokens) {
+	jsmnint_t start = parser->pos;
+
+	parser->pos++;
+
+	/* Skip starting quote */
+	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+		char c = js[parser->pos];
+
+		/* Quote: end of string */
+		if (c == '\"') {
+#if JSMN_TPL_EMIT
+			JSMN_TPL_TOKEN *token;
+			token = JSMN_TPL_FN(_alloc_token)(parser, tokens, num_tokens);
+			if (token == NULL) {
+				parser->pos = start;
+				return JSMN_ERROR_NOMEM;
+			}
+			JSMN_TPL_SET_TYPE(token, JSMN_STRING);
+			token->start = start + 1;
+			token->end = parser->pos;
+#if JSMN_TPL_PARENT_LINKS
+			token->parent = parser->toksuper;
+#endif
+#else
+			(void) tokens;
+			(void) num_tokens;
+#endif
+			return 0;
+		}
+
+		/* Backslash: Quoted symbol expected */
+		if (c == '\\' && parser->pos + 1 < len) {
+			int i;
+			parser->pos++;
+			switch (js[parser->pos]) {
+				/* Allowed escaped symbols */
+				case '\"': case '/' : case '\\' : case 'b' :
+				case 'f' : case 'r' : case 'n'  : case 't' :
+					break;
+				/* Allows escaped symbol \uXXXX */
+				case 'u':
+					parser->pos++;
+					for(i = 0; i < 4 && parser->pos < len && js[parser->pos] != '\0'; i++) {
+						/* If it isn't a hex character we have an error */
+						if(!((js[parser->pos] >= 48 && js[parser->pos] <= 57) || /* 0-9 */
+									(js[parser->pos] >= 65 && js[parser->pos] <= 70) || /* A-F */
+									(js[parser->pos] >= 97 && js[parser->pos] <= 102))) { /* a-f */
+							parser->pos = start;
+							return JSMN_ERROR_INVAL;
+						}
+						parser->pos++;
+					}
+					parser->pos--;
+					break;
+				/* Unexpected symbol */
+				default:
+					parser->pos = start;
+					return JSMN_ERROR_INVAL;
+			}
+		}
+	}
+	parser->pos = start;
+	return JSMN_ERROR_PART;
+}
+
+/**
+ * Parse JSON string and fill tokens.
+ */
+JSMN_TPL_STORAGE jsmnint_t JSMN_TPL_NAME(jsmn_parser *parser, const char *js,
+		size_t len, JSMN_TPL_TOKEN *tokens, jsmnuint_t num_tokens) {
+	int r;
+	jsmnint_t count = parser->toknext;
+#if JSMN_TPL_EMIT
+	jsmnint_t i;
+	JSMN_TPL_TOKEN *token;
+	jsmntype_t type;
+#endif
+
+	for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+		char c;
+
+		c = js[parser->pos];
+		switch (c) {
+			case '{': case '[':
+				count++;
+#if JSMN_TPL_EMIT
+				token = JSMN_TPL_FN(_alloc_token)(parser, tokens, num_tokens);
+				if (token == NULL)
+					return JSMN_ERROR_NOMEM;
+				if (parser->toksuper != -1) {
+					JSMN_TPL_SIZE_INC(&tokens[parser->toksuper]);
+#if JSMN_TPL_PARENT_LINKS
+					token->parent = parser->toksuper;
+#endif
+				}
+				JSMN_TPL_SET_TYPE(token, c == '{' ? JSMN_OBJECT : JSMN_ARRAY);
+				token->start = parser->pos;
+				parser->toksuper = parser->toknext - 1;
+#endif
+				break;
+			case '}': case ']':
+#if JSMN_TPL_EMIT
+				type = (c == '}' ? JSMN_OBJECT : JSMN_ARRAY);
+#if JSMN_TPL_PARENT_LINKS
+				if (parser->toknext < 1) {
+					return JSMN_ERROR_INVAL;
+				}
+				token = &tokens[parser->toknext - 1];
+				for (;;) {
+					if (token->start != -1 && token->end == -1) {
+						if (JSMN_TPL_TYPE(token) != type) {
+							return JSMN_ERROR_INVAL;
+						}
+						token->end = parser->pos + 1;
+						parser->toksuper = token->parent;
+						break;
+					}
+					if (token->parent == -1) {
+						if(JSMN_TPL_TYPE(token) != type || parser->toksuper == -1) {
+							return JSMN_ERROR_INVAL;
+						}
+						break;
+					}
+					token = &tokens[token->parent];
+				}
+#else
+				for (i = parser->toknext - 1; i >= 0; i--) {
+					token = &tokens[i];
+					if (token->start != -1 && token->end == -1) {
+						if (JSMN_TPL_TYPE(token) != type) {
+							return JSMN_ERROR_INVAL;
+						}
+						parser->toksuper = -1;
+						token->end = parser->pos + 1;
+						break;
+					}
+				}
+				/* Error if unmatched closing bracket */
+				if (i == -1) return JSMN_ERROR_INVAL;
+				for (; i >= 0; i--) {
+					token = &tokens[i];
+					if (token->start != -1 && token->end == -1) {
+						parser->toksuper = i;
+						break;
+					}
+				}
+#endif
+#endif
+				break;
+			case '\"':
+				r = JSMN_TPL_FN(_parse_string)(parser, js, len, tokens, num_tokens);
+				if (r < 0) return r;
+				count++;
+#if JSMN_TPL_EMIT
+				if (parser->toksuper != -1)
+					JSMN_TPL_SIZE_INC(&tokens[parser->toksuper]);
+#endif
+				break;
+			case '\t' : case '\r' : case '\n' : case ' ':
+				break;
+			case ':':
+				parser->toksuper = parser->toknext - 1;
+				break;
+			case ',':
+#if JSMN_TPL_EMIT
+				if (parser->toksuper != -1 &&
+						JSMN_TPL_TYPE(&tokens[parser->toksuper]) != JSMN_ARRAY &&
+						JSMN_TPL_TYPE(&tokens[parser->toksuper]) != JSMN_OBJECT) {
+#if JSMN_TPL_PARENT_LINKS
+					parser->toksuper = tokens[parser->toksuper].parent;
+#else
+					for (i = parser->toknext - 1; i >= 0; i--) {
+						if (JSMN_TPL_TYPE(&tokens[i]) == JSMN_ARRAY ||
+								JSMN_TPL_TYPE(&tokens[i]) == JSMN_OBJECT) {
+							if (tokens[i].start != -1 && tokens[i].end == -1) {
+								parser->toksuper = i;
+								break;
+							}
+						}
+					}
+#endif
+				}
+#endif
+				break;
+#if JSMN_TPL_STRICT
+			/* In strict mode primitives are: numbers and booleans */
+			case '-': case '0': case '1' : case '2': case '3' : case '4':
+			case '5': case '6': case '7' : case '8': case '9':
+			case 't': case 'f': case 'n' :
+#if JSMN_TPL_EMIT
+				/* And they must not be keys of the object */
+				if (parser->toksuper != -1) {
+					JSMN_TPL_TOKEN *t = &tokens[parser->toksuper];
+					if (JSMN_TPL_TYPE(t) == JSMN_OBJECT ||
+							(JSMN_TPL_TYPE(t) == JSMN_STRING && JSMN_TPL_SIZE(t) != 0)) {
+						return JSMN_ERROR_INVAL;
+					}
+				}
+#endif
+#else
+			/* In non-strict mode every unquoted value is a primitive */
+			default:
+#endif
+				r = JSMN_TPL_FN(_parse_primitive)(parser, js, len, tokens, num_tokens);
+				if (r < 0) return r;
+				count++;
+#if JSMN_TPL_EMIT
+				if (parser->toksuper != -1)
+					JSMN_TPL_SIZE_INC(&tokens[parser->toksuper]);
+#endif
+				break;
+
+#if JSMN_TPL_STRICT
+			/* Unexpected char in strict mode */
+			default:
+				return JSMN_ERROR_INVAL;
+#endif
+		}
+	}
+
+#if JSMN_TPL_EMIT
+#if JSMN_TPL_PARENT_LINKS
+	/* Every open container is on the parent chain of toksuper, so this
+	 * costs the nesting depth rather than the token count. Callers feeding
+	 * a growing buffer run it once per step. */
+	for (i = parser->toksuper; i >= 0; i = tokens[i].parent) {
+#else
+	for (i = parser->toknext - 1; i >= 0; i--) {
+#endif
+		/* Unmatched opened object or array */
+		if (tokens[i].start != -1 && tokens[i].end == -1) {
+			return JSMN_ERROR_PART;
+		}
+	}
+#endif
+
+	return count;
+}
+
+#undef JSMN_TPL_FN
+#undef JSMN_TPL_TOKEN
+#undef JSMN_TPL_TYPE
+#undef JSMN_TPL_SIZE
+#undef JSMN_TPL_SIZE_INC
+#undef JSMN_TPL_RESET
+#undef JSMN_TPL_SET_TYPE
+#undef JSMN_TPL_KINDS
+#undef JSMN_TPL_NAME
+#undef JSMN_TPL_EMIT
+#undef JSMN_TPL_STRICT
+#undef JSMN_TPL_PARENT_LINKS
+#undef JSMN_TPL_COMPACT
+#undef JSMN_TPL_STORAGE
+
+#endif /* JSMN_TPL_NAME */
@@ -0,0 +1,20 @@
+#include "jsmn_variants.h"
+
+#define JSMN_TPL_NAME jsmn_parse_count
+#define JSMN_TPL_EMIT 0
+#define JSMN_TPL_STORAGE
+#include "jsmn_tpl.h"
+
+#define JSMN_TPL_NAME jsmn_parse_lenient
+#define JSMN_TPL_STORAGE
+#include "jsmn_tpl.h"
+
+#define JSMN_TPL_NAME jsmn_parse_strict
+#define JSMN_TPL_STRICT 1
+#define JSMN_TPL_STORAGE
+#include "jsmn_tpl.h"
+
+#define JSMN_TPL_NAME jsmn_parse_compact
+#define JSMN_TPL_COMPACT 1
+#define JSMN_TPL_STORAGE
+#include "jsmn_tpl.h"
@@ -0,0 +1,42 @@
+#ifndef __JSMN_VARIANTS_H_
+#define __JSMN_VARIANTS_H_
+
+#include "jsmn_tpl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Ready-made instantiations of jsmn_tpl.h. All take an initialized parser
+ * and return what jsmn_parse returns for the same configuration.
+ */
+
+/* Count tokens only, lenient grammar. Same as jsmn_parse with NULL tokens. */
+jsmnint_t jsmn_parse_count(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_t *tokens, jsmnuint_t num_tokens);
+
+/* Lenient grammar with parent links. Same as jsmn_parse. */
+jsmnint_t jsmn_parse_lenient(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_t *tokens, jsmnuint_t num_tokens);
+
+/* Strict grammar (JSMN_STRICT) with parent links. */
+jsmnint_t jsmn_parse_strict(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_t *tokens, jsmnuint_t num_tokens);
+
+/* Lenient grammar with parent links into compact tokens. */
+jsmnint_t jsmn_parse_compact(jsmn_parser *parser, const char *js, size_t len,
+		jsmntok_compact_t *tokens, jsmnuint_t num_tokens);
+
+/* The variant following JSMN_STRICT like jsmn_parse, as used by jlite. */
+#ifdef JSMN_STRICT
+#define jsmn_parse_default jsmn_parse_strict
+#else
+#define jsmn_parse_default jsmn_parse_lenient
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JSMN_VARIANTS_H_ */
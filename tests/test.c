@@ -2,9 +2,69 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../jlite/jlite.h"
+#include "../jlite/jlite_lazy.h"
+#include "../jlite/jlite_validate.h"
+#include "../jlite/jlite_minify.h"
+#include "../jlite/jlite_hash.h"
+#include "../jlite/jlite_cache.h"
+#include "../jlite/jlite_shape.h"
+#include "../jlite/jlite_project.h"
+#include "../jlite/jlite_query.h"
+#include "../jlite/jlite_aggregate.h"
+#include "../jlite/jlite_columns.h"
+#include "../jlite/jlite_msgpack.h"
+#include "../jlite/jlite_inflate.h"
+#include "../jlite/jlite_ingest.h"
+#include "../jlite/jlite_file.h"
+#include "../jlite/jlite_index.h"
+#include "../jlite/jlite_intern.h"
+#include <zlib.h>
+#include "../jlite/jsmn/jsmn_variants.h"
 
 #define TEST_J_STR "{\"test_obj\":{\"array_array\":[[\"array1_str_0\",\"array1_str_1\",\"array1_str_2\",\"array1_str_3\"],[\"array1_str_4\",\"array1_str_5\",\"array1_str_6\",\"array1_str_7\"]],\"str_test\":\"johndoe1\",\"int_test\":315,\"float_test\":115.16,\"bool_test\":false,\"obj_test\":{\"obj_int_test\":11994,\"obj_str_test\":\"ra1unak\",\"obj_float_test\":161.04},\"array_test_str\":[\"array_str_0\",\"array_str_1\",\"array_str_2\",\"array_str_3\"],\"array_test_obj\":[{\"obj_int_test\":16,\"obj_str_test\":\"array_obj_1\",\"obj_float_test\":94.19},{\"obj_int_test\":4,\"obj_str_test\":\"array_obj_2\",\"obj_float_test\":16.04},{\"obj_int_test\":25,\"obj_str_test\":\"array_obj_3\",\"obj_float_test\":19.16}],\"array_test_int\":[16,4,1994],\"array_test_float\":[19.94,4.16,94.1604]},\"array_array\":[[\"array_str_0\",\"array_str_1\",\"array_str_2\",\"array_str_3\"],[\"array_str_4\",\"array_str_5\",\"array_str_6\",\"array_str_7\"]],\"str_test\":\"johndoe\",\"int_test\":35,\"float_test\":15.16,\"bool_test\":true,\"obj_test\":{\"obj_int_test\":1994,\"obj_str_test\":\"raunak\",\"obj_float_test\":16.04},\"array_test_str\":[\"array_str_0\",\"array_str_1\",\"array_str_2\",\"array_str_3\"],\"array_test_obj\":[{\"obj_int_test\":16,\"obj_str_test\":\"array_obj_1\",\"obj_float_test\":94.19},{\"obj_int_test\":4,\"obj_str_test\":\"array_obj_2\",\"obj_float_test\":16.04},{\"obj_int_test\":25,\"obj_str_test\":\"array_obj_3\",\"obj_float_test\":19.16}],\"array_test_int\":[16,4,1994],\"array_test_float\":[19.94,4.16,94.1604]}"
 
+static int query_print(jliteobj_t *jsonobj, int pos, void *ctx)
+{
+  (void) ctx;
+  printf(" %.*s", (int) (jsonobj->tokens[pos].end - jsonobj->tokens[pos].start),
+      jsonobj->jsonstr + jsonobj->tokens[pos].start);
+  return 0;
+}
+
+typedef struct
+{
+  const uint8_t *buf;
+  size_t len;
+  size_t pos;
+} inflate_src_t;
+
+/* Hands out the compressed bytes a few at a time. */
+static long inflate_read(void *ctx, uint8_t *buf, size_t len)
+{
+  inflate_src_t *src = (inflate_src_t *) ctx;
+  size_t n = src->len - src->pos < 7 ? src->len - src->pos : 7;
+
+  (void) len;
+  memcpy(buf, src->buf + src->pos, n);
+  src->pos += n;
+  return (long) n;
+}
+
+/* Records the result and int_test of every ingested file by index. */
+static int ingest_record(void *ctx, int index, jliteobj_t *jsonobj, int ret)
+{
+  int *results = (int *) ctx;
+  int value = 0;
+
+  if (ret == JLITE_OK)
+  {
+    jlite_get_value_int(jsonobj, "int_test", &value);
+  }
+  results[2 * index] = ret;
+  results[2 * index + 1] = value;
+  return 0;
+}
+
 int main(void)
 {
   int ret = 0;
@@ -286,5 +346,796 @@ int main(void)
     printf("Array release successful\r\n");
   }
 
+  int values_int[8];
+  double values_double[8];
+  int num_values = 0;
+
+  ret = jlite_get_json_array(&jsonobj, "array_test_float", &size);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_get_json_array_doubles(&jsonobj, values_double, 8,
+        &num_values);
+    jlite_release_json_array(&jsonobj);
+  }
+  if (ret != JLITE_OK)
+  {
+    printf("Bulk doubles ret %d at %d\r\n", ret, num_values);
+  }
+  else
+  {
+    printf("Bulk doubles %d: %f %f %f\r\n", num_values, values_double[0],
+        values_double[1], values_double[2]);
+  }
+
+  ret = jlite_get_json_array(&jsonobj, "array_test_str", &size);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_get_json_array_ints(&jsonobj, values_int, 8, &num_values);
+    jlite_release_json_array(&jsonobj);
+  }
+  printf("Bulk ints of strings ret %d at %d\r\n", ret, num_values);
+
+  /* Elements after nested objects and arrays. */
+  char walk_str[] = "{\"w\":[{\"a\":{\"b\":1},\"c\":[1,2]},[[1,2],3],7]}";
+  jlitetok_t walk_tokens[32];
+  jliteobj_t walk_obj;
+  int walk_last = 0;
+
+  ret = jlite_parse_init(&walk_obj, walk_tokens, 32, walk_str,
+      (int) strlen(walk_str));
+  ret |= jlite_get_json_array(&walk_obj, "w", &size);
+  ret |= jlite_get_json_array_element_int(&walk_obj, 2, &walk_last);
+  ret |= jlite_get_array_element_array(&walk_obj, 1, &size);
+  ret |= jlite_get_json_array_element_int(&walk_obj, 1, &value_int);
+  ret |= jlite_release_array_element_array(&walk_obj);
+  printf("ARRAY WALK RET %d LAST %d NESTED %d", ret, walk_last, value_int);
+  ret = jlite_get_json_array_element_int(&walk_obj, 3, &value_int);
+  printf(" PAST END %d", ret);
+  walk_last = 0;
+  ret = jlite_get_array_element_object(&walk_obj, 0);
+  ret |= jlite_release_array_element_object(&walk_obj);
+  ret |= jlite_get_json_array_element_int(&walk_obj, 2, &walk_last);
+  printf(" AFTER RELEASE %d %d\r\n", ret, walk_last);
+
+  jlitelazy_t lazy_root;
+  jlitelazy_t lazy_obj;
+  jlitelazy_t lazy_array;
+  jlitelazy_t lazy_elem;
+
+  ret = jlite_lazy_init(&lazy_root, j_str, j_str_len);
+  if (ret != JLITE_OK)
+  {
+    printf("LAZY INIT RET IS %d\r\n", ret);
+  }
+
+  ret = jlite_lazy_get_value_int(&lazy_root, "int_test", &value_int);
+  if (ret != JLITE_OK)
+  {
+    printf("LAZY INT_TEST RET IS %d\r\n", ret);
+  }
+  else
+  {
+    printf("LAZY INT_TEST VALUE_INT %d\n", value_int);
+  }
+
+  ret = jlite_lazy_get_value_str(&lazy_root, "str_test", value_str, 50);
+  if (ret != JLITE_OK)
+  {
+    printf("LAZY STR_TEST RET IS %d\r\n", ret);
+  }
+  else
+  {
+    printf("LAZY STR_TEST VALUE %s\r\n", value_str);
+  }
+
+  ret = jlite_lazy_find(&lazy_root, "test_obj", &lazy_obj);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_get_value_bool(&lazy_obj, "bool_test", &bool_test);
+  }
+  if (ret != JLITE_OK)
+  {
+    printf("LAZY BOOL_TEST RET IS %d\r\n", ret);
+  }
+  else
+  {
+    printf("LAZY BOOL_TEST VALUE %d\r\n", bool_test);
+  }
+
+  ret = jlite_lazy_find(&lazy_obj, "array_test_obj", &lazy_array);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_size(&lazy_array, &size);
+  }
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_element(&lazy_array, 2, &lazy_elem);
+  }
+  if (ret == JLITE_OK)
+  {
+    ret = jlite_lazy_get_value_float(&lazy_elem, "obj_float_test",
+        &value_float);
+  }
+  if (ret != JLITE_OK)
+  {
+    printf("LAZY ARRAY OBJ RET IS %d\r\n", ret);
+  }
+  else
+  {
+    printf("LAZY ARRAY size %d FLOAT_TEST VALUE_FLOAT %f\n", size,
+        value_float);
+  }
+
+  int err_offset = 0;
+
+  ret = jlite_validate(j_str, j_str_len, &err_offset);
+  printf("VALIDATE RET %d OFFSET %d\r\n", ret, err_offset);
+
+  ret = jlite_validate("{\"a\":[1,2,]}", 12, &err_offset);
+  printf("VALIDATE TRAILING COMMA RET %d OFFSET %d\r\n", ret, err_offset);
+
+  ret = jlite_validate("[\"\xc0\xaf\"]", 6, &err_offset);
+  printf("VALIDATE OVERLONG UTF8 RET %d OFFSET %d\r\n", ret, err_offset);
+
+  ret = jlite_validate("[1.12345678901234567890x]", 25, &err_offset);
+  printf("VALIDATE LONG FRACTION RET %d OFFSET %d", ret, err_offset);
+  ret = jlite_validate("-0.1234567890123456789e-12", 26, &err_offset);
+  printf(" %d %d", ret, err_offset);
+  ret = jlite_validate("[0.e5]", 6, &err_offset);
+  printf(" %d %d\r\n", ret, err_offset);
+
+  char pretty[] = "{ \"a\" : [ 1, 2 ],\n  \"s\" : \"x \\\" y\" }";
+  char minified[sizeof(pretty)];
+
+  ret = jlite_minify(pretty, strlen(pretty), minified, &len, 0);
+  printf("MINIFY RET %d %.*s\r\n", ret, len, minified);
+
+  ret = jlite_minify(pretty, strlen(pretty), pretty, &len,
+      JLITE_MINIFY_VALIDATE);
+  printf("MINIFY IN PLACE VALIDATE RET %d %.*s\r\n", ret, len, pretty);
+
+  ret = jlite_minify("[1, 2,]", 7, minified, &len, JLITE_MINIFY_VALIDATE);
+  printf("MINIFY VALIDATE TRAILING COMMA RET %d\r\n", ret);
+
+  jliteobj_t hashed;
+  jliteobj_t other;
+  jlitetok_t hashed_tokens[200];
+  jlitetok_t other_tokens[200];
+  jlite_hash_t hashes[200];
+  jlite_hash_t other_hashes[200];
+  char *reordered = "{ \"b\": [1, {\"y\": 2.0, \"x\": \"s\"}], \"a\": 1e0 }";
+  char *original = "{\"a\":1,\"b\":[1,{\"x\":\"s\",\"y\":2}]}";
+  int equal = 0;
+
+  jlite_parse_init(&other, other_tokens, 200, reordered, strlen(reordered));
+  jlite_hash_tokens(&other, other_hashes, 200);
+  jlite_parse_init(&hashed, hashed_tokens, 200, original, strlen(original));
+  jlite_hash_tokens(&hashed, hashes, 200);
+  ret = jlite_hash_subtree_equal(&hashed, hashes, 0, &other, other_hashes, 0,
+      &equal);
+  printf("HASH EQUAL RET %d EQUAL %d SAME ROOT HASH %d\r\n", ret, equal,
+      hashes[0].lo == other_hashes[0].lo && hashes[0].hi == other_hashes[0].hi);
+
+  /* {"x":"s","y":2} against {"y":2.0,"x":"s"}, then against [1,{...}]. */
+  ret = jlite_hash_subtree_equal(&hashed, hashes, 6, &other, other_hashes, 4,
+      &equal);
+  printf("HASH SUBTREE RET %d EQUAL %d\r\n", ret, equal);
+
+  ret = jlite_hash_subtree_equal(&hashed, hashes, 6, &other, other_hashes, 2,
+      &equal);
+  printf("HASH SUBTREE MISMATCH RET %d EQUAL %d\r\n", ret, equal);
+
+  /* Ids a double cannot tell apart. */
+  char *big_id = "{\"id\":9007199254740993}";
+  char *next_id = "{\"id\":9007199254740992}";
+
+  jlite_parse_init(&hashed, hashed_tokens, 200, big_id, strlen(big_id));
+  jlite_hash_tokens(&hashed, hashes, 200);
+  jlite_parse_init(&other, other_tokens, 200, next_id, strlen(next_id));
+  jlite_hash_tokens(&other, other_hashes, 200);
+  ret = jlite_hash_subtree_equal(&hashed, hashes, 0, &other, other_hashes, 0,
+      &equal);
+  printf("HASH BIG INT RET %d EQUAL %d SAME ROOT HASH %d", ret, equal,
+      hashes[0].lo == other_hashes[0].lo && hashes[0].hi == other_hashes[0].hi);
+  ret = jlite_hash_subtree_equal(&hashed, hashes, 0, &hashed, hashes, 0,
+      &equal);
+  printf(" SELF %d\r\n", equal);
+
+  static char cache_arena[16384];
+  jlite_cache_t cache;
+  jlite_cache_stats_t cache_stats;
+  jliteobj_t cached;
+
+  ret = jlite_cache_init(&cache, cache_arena, sizeof(cache_arena), 2);
+  printf("CACHE INIT RET %d\r\n", ret);
+  ret = jlite_cache_parse(&cache, &cached, original, strlen(original));
+  jlite_cache_release(&cache, &cached);
+  ret |= jlite_cache_parse(&cache, &cached, original, strlen(original));
+  ret |= jlite_get_value_int(&cached, "a", &value_int);
+  jlite_cache_release(&cache, &cached);
+  jlite_cache_get_stats(&cache, &cache_stats);
+  printf("CACHE RET %d A %d HITS %lu MISSES %lu\r\n", ret, value_int,
+      cache_stats.hits, cache_stats.misses);
+  jlite_cache_destroy(&cache);
+
+  jlite_shape_entry_t shape_entries[64];
+  jlite_shape_t shape;
+  jlite_shape_stats_t shape_stats;
+  int i = 0;
+  char *messages[2] = {
+    "{\"id\":1,\"tags\":[\"a\"],\"user\":{\"name\":\"x\",\"age\":30}}",
+    "{\"id\":2,\"tags\":[\"b\"],\"user\":{\"name\":\"y\",\"age\":41}}",
+  };
+
+  jlite_shape_init(&shape, shape_entries, 64);
+  for (i = 0; i < 2; i++)
+  {
+    jlite_parse_init(&other, other_tokens, 200, messages[i],
+        strlen(messages[i]));
+    jlite_shape_attach(&other, &shape);
+    ret = jlite_get_value_int(&other, "id", &value_int);
+    ret |= jlite_get_json_object(&other, "user");
+    ret |= jlite_get_value_int(&other, "age", &value_int);
+    jlite_release_json_object(&other);
+  }
+  jlite_shape_get_stats(&shape, &shape_stats);
+  printf("SHAPE RET %d AGE %d HITS %lu MISSES %lu COLD %lu\r\n", ret,
+      value_int, shape_stats.hits, shape_stats.misses, shape_stats.cold);
+
+  jlite_path_t paths[2];
+  jliteobj_t projected;
+  jlitetok_t projected_tokens[32];
+
+  jlite_path_compile(&paths[0], "obj_test.obj_str_test");
+  jlite_path_compile(&paths[1], "array_test_obj[*].obj_int_test");
+  ret = jlite_parse_project(&projected, projected_tokens, 32, j_str, j_str_len,
+      paths, 2);
+  printf("PROJECT RET %d TOKENS %d\r\n", ret, (int) projected.num_tokens);
+  ret = jlite_get_json_array(&projected, "array_test_obj", &size);
+  ret |= jlite_get_array_element_object(&projected, 2);
+  ret |= jlite_get_value_int(&projected, "obj_int_test", &value_int);
+  printf("PROJECT ELEMENT RET %d SIZE %d INT %d\r\n", ret, size, value_int);
+  projected.cur_pos = 1;
+  ret = jlite_get_json_object(&projected, "obj_test");
+  ret |= jlite_get_value_str(&projected, "obj_str_test", value_str, 50);
+  printf("PROJECT OBJECT RET %d STR %s\r\n", ret, value_str);
+  ret = jlite_get_json_object(&projected, "obj_float_test");
+  printf("PROJECT DROPPED RET %d\r\n", ret);
+  jlite_release_json_object(&projected);
+
+  jlite_query_t query;
+  int matches = 0;
+  const char *queries[] = {
+    "$..obj_str_test",
+    "$.array_test_obj[?(@.obj_int_test > 10)].obj_float_test",
+    "$.test_obj.array_array[*][1:3]",
+    "$.array_test_int[-1]",
+  };
+
+  for (i = 0; i < (int) (sizeof(queries) / sizeof(queries[0])); i++)
+  {
+    jsonobj.cur_pos = 1;
+    ret = jlite_query_compile(&query, queries[i], &err_offset);
+    printf("QUERY %s:", queries[i]);
+    ret |= jlite_query_run(&query, &jsonobj, query_print, NULL, &matches);
+    printf(" RET %d MATCHES %d\r\n", ret, matches);
+  }
+  ret = jlite_query_compile(&query, "$.a[?(@.b ~ 1)]", &err_offset);
+  printf("QUERY BAD RET %d OFFSET %d\r\n", ret, err_offset);
+
+  jlite_agg_t agg;
+
+  jsonobj.cur_pos = 1;
+  ret = jlite_get_json_array(&jsonobj, "array_test_int", &size);
+  ret |= jlite_aggregate_array(&jsonobj, &agg);
+  jlite_release_json_array(&jsonobj);
+  printf("AGGREGATE RET %d COUNT %ld SUM %lld MIN %g MAX %g EXACT %d\r\n",
+      ret, agg.count, (long long) agg.sum_int, agg.min, agg.max, agg.exact);
+
+  ret = jlite_get_json_array(&jsonobj, "array_test_obj", &size);
+  ret |= jlite_aggregate_field(&jsonobj, "obj_float_test", &agg);
+  jlite_release_json_array(&jsonobj);
+  printf("AGGREGATE FIELD RET %d COUNT %ld SUM %g MEAN %g SKIPPED %ld\r\n",
+      ret, agg.count, agg.sum, agg.mean, agg.skipped);
+
+  ret = jlite_get_json_array(&jsonobj, "array_test_str", &size);
+  ret |= jlite_aggregate_array(&jsonobj, &agg);
+  jlite_release_json_array(&jsonobj);
+  printf("AGGREGATE STRINGS RET %d COUNT %ld SKIPPED %ld FIRST %ld\r\n",
+      ret, agg.count, agg.skipped, agg.first_skipped);
+
+  jlite_column_t columns[4];
+  int64_t col_ints[4];
+  int64_t col_floats[4];
+  int32_t col_offsets[5];
+  char col_data[64];
+  uint8_t col_bools[1];
+  uint8_t col_validity[4][1];
+  int num_rows = 0;
+
+  memset(columns, 0, sizeof(columns));
+  columns[0].key = "obj_int_test";
+  columns[0].type = JLITE_COLUMN_INT64;
+  columns[0].values = col_ints;
+  columns[1].key = "obj_str_test";
+  columns[1].type = JLITE_COLUMN_STRING;
+  columns[1].values = col_offsets;
+  columns[1].data = col_data;
+  columns[1].data_size = sizeof(col_data);
+  columns[2].key = "obj_float_test";
+  columns[2].type = JLITE_COLUMN_INT64;
+  columns[2].values = col_floats;
+  columns[3].key = "missing";
+  columns[3].type = JLITE_COLUMN_BOOL;
+  columns[3].values = col_bools;
+  for (i = 0; i < 4; i++)
+  {
+    columns[i].validity = col_validity[i];
+  }
+  ret = jlite_get_json_array(&jsonobj, "array_test_obj", &size);
+  ret |= jlite_extract_columns(&jsonobj, columns, 4, 4, &num_rows);
+  jlite_release_json_array(&jsonobj);
+  printf("COLUMNS RET %d ROWS %d INTS %lld %lld %lld VALID %x\r\n", ret,
+      num_rows, (long long) col_ints[0], (long long) col_ints[1],
+      (long long) col_ints[2], col_validity[0][0]);
+  printf("COLUMNS STRINGS %.*s|%.*s OFFSETS %d %d\r\n",
+      (int) (col_offsets[1] - col_offsets[0]), col_data,
+      (int) (col_offsets[3] - col_offsets[2]), col_data + col_offsets[2],
+      (int) col_offsets[0], (int) col_offsets[3]);
+  printf("COLUMNS NULLS %ld %ld MISMATCHED %ld\r\n", columns[2].null_count,
+      columns[3].null_count, columns[2].mismatched);
+  columns[1].data_size = 16;
+  ret = jlite_get_json_array(&jsonobj, "array_test_obj", &size);
+  ret = jlite_extract_columns(&jsonobj, columns, 4, 4, &num_rows);
+  jlite_release_json_array(&jsonobj);
+  printf("COLUMNS SHORT DATA RET %d ROWS %d LEN %d\r\n", ret, num_rows,
+      (int) columns[1].data_len);
+#ifndef JSMN_STRICT
+  /* Bare words of lenient builds are mismatches, not null or false. */
+  char col_bare[] = "[{\"b\":fast,\"n\":nope},{\"b\":true,\"n\":null},"
+      "{\"b\":false,\"n\":1}]";
+  jlitetok_t col_tokens[32];
+  jliteobj_t col_obj;
+
+  columns[0].key = "b";
+  columns[0].type = JLITE_COLUMN_BOOL;
+  columns[0].values = col_bools;
+  columns[1].key = "n";
+  columns[1].type = JLITE_COLUMN_INT64;
+  columns[1].values = col_ints;
+  ret = jlite_parse_init(&col_obj, col_tokens, 32, col_bare,
+      (int) strlen(col_bare));
+  ret |= jlite_extract_columns(&col_obj, columns, 2, 4, &num_rows);
+  printf("COLUMNS BARE WORDS RET %d NULLS %ld %ld MISMATCHED %ld %ld "
+      "BOOLS %x\r\n", ret, columns[0].null_count, columns[1].null_count,
+      columns[0].mismatched, columns[1].mismatched, col_bools[0]);
+#endif
+
+  uint8_t msgpack[2048];
+  char msgpack_text[2048];
+  jlitetok_t msgpack_tokens[200];
+  jliteobj_t msgpack_obj;
+  size_t msgpack_len = 0;
+
+  jsonobj.cur_pos = 1;
+  ret = jlite_msgpack_encode(&jsonobj, msgpack, sizeof(msgpack),
+      &msgpack_len);
+  ret |= jlite_msgpack_parse_init(&msgpack_obj, msgpack_tokens, 200, msgpack,
+      msgpack_len, msgpack_text, sizeof(msgpack_text));
+  printf("MSGPACK RET %d LEN %d JSON %d TOKENS %d\r\n", ret,
+      (int) msgpack_len, j_str_len, (int) msgpack_obj.num_tokens);
+  ret = jlite_get_value_str(&msgpack_obj, "str_test", value_str, 50);
+  ret |= jlite_get_value_int(&msgpack_obj, "int_test", &value_int);
+  ret |= jlite_get_value_float(&msgpack_obj, "float_test", &value_float);
+  ret |= jlite_get_value_bool(&msgpack_obj, "bool_test", &bool_test);
+  printf("MSGPACK GET RET %d STR %s INT %d FLOAT %.2f BOOL %d\r\n", ret,
+      value_str, value_int, value_float, bool_test);
+  ret = jlite_get_json_object(&msgpack_obj, "test_obj");
+  ret |= jlite_get_json_array(&msgpack_obj, "array_test_float", &size);
+  ret |= jlite_get_json_array_element_float(&msgpack_obj, 2, &value_float);
+  printf("MSGPACK NESTED RET %d SIZE %d FLOAT %.4f\r\n", ret, size,
+      value_float);
+  ret = jlite_msgpack_parse_init(&msgpack_obj, msgpack_tokens, 200, msgpack,
+      msgpack_len - 1, msgpack_text, sizeof(msgpack_text));
+  printf("MSGPACK TRUNCATED RET %d\r\n", ret);
+#ifndef JSMN_STRICT
+  /* Lenient builds accept bare words, they are neither false nor null. */
+  char msgpack_bare[] = "{\"a\":foo,\"b\":nope}";
+
+  ret = jlite_parse_init(&msgpack_obj, msgpack_tokens, 200, msgpack_bare,
+      (int) strlen(msgpack_bare));
+  ret |= jlite_msgpack_encode(&msgpack_obj, msgpack, sizeof(msgpack),
+      &msgpack_len);
+  printf("MSGPACK BARE WORD RET %d\r\n", ret);
+#endif
+
+  uint8_t deflated[1024];
+  uLongf deflated_len = sizeof(deflated);
+  inflate_src_t inflate_src;
+
+  compress2(deflated, &deflated_len, (const Bytef *) j_str, j_str_len, 9);
+  ret = jlite_inflate_parse_buffer(&msgpack_obj, msgpack_tokens, 200,
+      msgpack_text, sizeof(msgpack_text), deflated, deflated_len, 0);
+  ret |= jlite_get_value_int(&msgpack_obj, "int_test", &value_int);
+  printf("INFLATE RET %d LEN %d TOKENS %d INT %d\r\n", ret,
+      (int) msgpack_obj.jsonstr_len, (int) msgpack_obj.num_tokens, value_int);
+  /* Large enough for the threaded pipeline to take over after a block. */
+  int inflate_docs = 2 * JLITE_INFLATE_BLOCK / j_str_len + 1;
+  int inflate_len = inflate_docs * (j_str_len + 1) + 1;
+  char *inflate_json = malloc((size_t) inflate_len);
+  char *inflate_text = malloc((size_t) inflate_len);
+  jlitetok_t *inflate_tokens = malloc(sizeof(jlitetok_t) * 137 *
+      (size_t) inflate_docs + sizeof(jlitetok_t));
+  uLongf inflate_deflated_len = compressBound((uLong) inflate_len);
+  uint8_t *inflate_deflated = malloc(inflate_deflated_len);
+  jliteobj_t inflate_obj;
+
+  inflate_json[0] = '[';
+  for (i = 0; i < inflate_docs; i++)
+  {
+    memcpy(inflate_json + 1 + i * (j_str_len + 1), j_str, (size_t) j_str_len);
+    inflate_json[(i + 1) * (j_str_len + 1)] = ',';
+  }
+  inflate_json[inflate_len - 1] = ']';
+  compress2(inflate_deflated, &inflate_deflated_len,
+      (const Bytef *) inflate_json, (uLong) inflate_len, 6);
+  inflate_src.buf = inflate_deflated;
+  inflate_src.len = inflate_deflated_len;
+  inflate_src.pos = 0;
+  ret = jlite_inflate_parse_init(&inflate_obj, inflate_tokens,
+      137 * inflate_docs + 1, inflate_text, inflate_len, inflate_read,
+      &inflate_src, JLITE_INFLATE_THREADED);
+  printf("INFLATE THREADED RET %d SAME TEXT %d TOKENS %d\r\n", ret,
+      inflate_obj.jsonstr_len == inflate_len &&
+      !memcmp(inflate_text, inflate_json, (size_t) inflate_len),
+      inflate_obj.num_tokens == 137 * inflate_docs + 1);
+  free(inflate_json);
+  free(inflate_text);
+  free(inflate_tokens);
+  free(inflate_deflated);
+  ret = jlite_inflate_parse_buffer(&msgpack_obj, msgpack_tokens, 200,
+      msgpack_text, sizeof(msgpack_text), deflated, deflated_len - 5, 0);
+  printf("INFLATE TRUNCATED RET %d\r\n", ret);
+  ret = jlite_inflate_parse_buffer(&msgpack_obj, msgpack_tokens, 200,
+      msgpack_text, 100, deflated, deflated_len, 0);
+  printf("INFLATE SHORT TEXT RET %d\r\n", ret);
+
+  char ingest_paths[3][32];
+  const char *ingest_list[4];
+  jlite_ingest_opts_t ingest_opts;
+  int ingest_results[8];
+  FILE *ingest_fp = NULL;
+
+  for (i = 0; i < 3; i++)
+  {
+    snprintf(ingest_paths[i], sizeof(ingest_paths[i]), "/tmp/jlite_ingest%d",
+        i);
+    ingest_fp = fopen(ingest_paths[i], "wb");
+    fwrite(j_str, 1, (size_t) (i == 1 ? 20 : j_str_len), ingest_fp);
+    fclose(ingest_fp);
+    ingest_list[i] = ingest_paths[i];
+  }
+  ingest_list[3] = "/tmp/jlite_ingest_missing";
+  memset(&ingest_opts, 0, sizeof(ingest_opts));
+  ingest_opts.arena = malloc(1 << 16);
+  ingest_opts.arena_size = 1 << 16;
+  ingest_opts.num_buffers = 4;
+  ingest_opts.queue_depth = 2;
+  for (i = 0; i < 3; i++)
+  {
+    /* io_uring or pread inline, pread with workers, io_uring with workers. */
+    ingest_opts.flags = i == 1 ? JLITE_INGEST_PREAD : 0;
+    ingest_opts.num_workers = i ? 2 : 0;
+    memset(ingest_results, 0, sizeof(ingest_results));
+    ret = jlite_ingest_files(&ingest_opts, ingest_list, 4, ingest_record,
+        ingest_results, NULL);
+    printf("INGEST %d RET %d FILES %d/%d %d/%d %d/%d %d/%d\r\n", i, ret,
+        ingest_results[0], ingest_results[1], ingest_results[2],
+        ingest_results[3], ingest_results[4], ingest_results[5],
+        ingest_results[6], ingest_results[7]);
+  }
+  ingest_opts.arena_size = 4096;
+  ret = jlite_ingest_files(&ingest_opts, ingest_list, 1, ingest_record,
+      ingest_results, NULL);
+  printf("INGEST SMALL SLOTS RET %d FILE %d\r\n", ret, ingest_results[0]);
+  free(ingest_opts.arena);
+  for (i = 0; i < 3; i++)
+  {
+    remove(ingest_paths[i]);
+  }
+
+  jlite_file_t file;
+  jliteobj_t file_obj;
+  jlitetok_t file_tokens[200];
+
+  ingest_fp = fopen("/tmp/jlite_file", "wb");
+  fwrite(j_str, 1, (size_t) j_str_len, ingest_fp);
+  fclose(ingest_fp);
+  ret = jlite_file_parse_init(&file_obj, file_tokens, 200, "/tmp/jlite_file",
+      &file);
+  ret |= jlite_get_value_int(&file_obj, "int_test", &value_int);
+  printf("FILE RET %d SIZE %d INT %d\r\n", ret, (int) file.size, value_int);
+  ret = jlite_file_unmap(&file);
+  ret |= jlite_file_map("/tmp/jlite_file_missing", &file);
+  printf("FILE MISSING RET %d\r\n", ret);
+  remove("/tmp/jlite_file");
+
+#ifdef JSMN_LARGE
+  /* 2.2 GB of 1 MB strings, the int after them is past 2^31. */
+  jlitetok_t *large_tokens = malloc(2200 * sizeof(jlitetok_t));
+  char *large_str = malloc(1 << 20);
+
+  memset(large_str, 'x', 1 << 20);
+  large_str[0] = '"';
+  large_str[(1 << 20) - 2] = '"';
+  large_str[(1 << 20) - 1] = ',';
+  ingest_fp = fopen("/tmp/jlite_file_large", "wb");
+  fputs("{\"pad\":[", ingest_fp);
+  for (i = 0; i < 2100; i++)
+  {
+    fwrite(large_str, 1, (size_t) (i == 2099 ? (1 << 20) - 1 : 1 << 20),
+        ingest_fp);
+  }
+  fputs("],\"tail\":42}", ingest_fp);
+  fclose(ingest_fp);
+  ret = jlite_file_parse_init(&file_obj, large_tokens, 2200,
+      "/tmp/jlite_file_large", &file);
+  ret |= jlite_get_value_int(&file_obj, "tail", &value_int);
+  printf("FILE LARGE RET %d TOKENS %d OFFSET %lld INT %d\r\n", ret,
+      (int) file_obj.num_tokens,
+      (long long) file_obj.tokens[file_obj.num_tokens - 1].start, value_int);
+  jlite_file_unmap(&file);
+  remove("/tmp/jlite_file_large");
+  free(large_str);
+  free(large_tokens);
+#endif
+
+  char kinds_str[] = "{\"t\":true,\"f\":false,\"n\":null,"
+      "\"i\":-9223372036854775808,\"w\":9223372036854775808,\"d\":1.5e3,"
+      "\"o\":nan,\"s\":\"1\"}";
+  jlite_number_t numbers[200];
+  jsmnkind_t kind = JSMN_KIND_NONE;
+  int64_t value_int64 = 0;
+  double value_double = 0;
+
+  ret = jlite_parse_init(&file_obj, file_tokens, 200, kinds_str,
+      (int) strlen(kinds_str));
+  printf("KINDS RET %d:", ret);
+  for (i = 0; i < file_obj.num_tokens; i++)
+  {
+    if (file_obj.tokens[i].type == JSMN_PRIMITIVE)
+    {
+      printf(" %d", file_obj.tokens[i].kind);
+    }
+  }
+  ret = jlite_get_value_kind(&file_obj, "s", &kind);
+  printf(" STRING %d %d\r\n", ret, kind);
+  for (i = 0; i < 2; i++)
+  {
+    /* Text conversion, then the number table. */
+    ret = i ? jlite_decode_numbers(&file_obj, numbers, 200) : JLITE_OK;
+    printf("NUMBERS %d RET %d", i, ret);
+    ret = jlite_get_value_int64(&file_obj, "i", &value_int64);
+    printf(" INT64 %d %lld", ret, (long long) value_int64);
+    ret = jlite_get_value_int64(&file_obj, "w", &value_int64);
+    printf(" WIDE %d", ret);
+    ret = jlite_get_value_double(&file_obj, "w", &value_double);
+    printf(" %d %g", ret, value_double);
+    ret = jlite_get_value_int(&file_obj, "d", &value_int);
+    printf(" INT %d %d", ret, value_int);
+    ret = jlite_get_value_int(&file_obj, "t", &value_int);
+    printf(" TRUE %d", ret);
+    ret = jlite_get_value_bool(&file_obj, "n", &bool_test);
+    printf(" NULL %d", ret);
+    ret = jlite_get_value_float(&file_obj, "o", &value_float);
+    printf(" OTHER %d\r\n", ret);
+  }
+  ret = jlite_decode_numbers(&file_obj, numbers, 10);
+  printf("NUMBERS SHORT RET %d\r\n", ret);
+
+  /* The lazy reader converts primitives like the tokenized getters. */
+  char lazy_kinds_str[] = "{\"t\":true,\"f\":false,\"n\":null,"
+      "\"i\":3000000000,\"d\":-1.5e3,\"l\":0.1234567890123456789012,"
+      "\"o\":nan,\"b\":1}";
+  const char *lazy_keys[] = { "t", "f", "n", "i", "d", "l", "o", "b" };
+  int lazy_int = 0;
+  int lazy_bool = 0;
+  float lazy_float = 0;
+  int lazy_rets[3];
+  int lazy_mismatches = 0;
+
+  ret = jlite_parse_init(&file_obj, file_tokens, 200, lazy_kinds_str,
+      (int) strlen(lazy_kinds_str));
+  ret |= jlite_lazy_init(&lazy_root, lazy_kinds_str,
+      (int) strlen(lazy_kinds_str));
+  printf("LAZY KINDS RET %d:", ret);
+  for (i = 0; i < 8; i++)
+  {
+    value_int = lazy_int = 0;
+    value_float = lazy_float = 0;
+    bool_test = lazy_bool = 0;
+    lazy_rets[0] = jlite_lazy_get_value_int(&lazy_root, lazy_keys[i],
+        &lazy_int);
+    lazy_rets[1] = jlite_lazy_get_value_float(&lazy_root, lazy_keys[i],
+        &lazy_float);
+    lazy_rets[2] = jlite_lazy_get_value_bool(&lazy_root, lazy_keys[i],
+        &lazy_bool);
+    lazy_mismatches +=
+        jlite_get_value_int(&file_obj, lazy_keys[i], &value_int) !=
+        lazy_rets[0] || value_int != lazy_int;
+    lazy_mismatches +=
+        jlite_get_value_float(&file_obj, lazy_keys[i], &value_float) !=
+        lazy_rets[1] || value_float != lazy_float;
+    lazy_mismatches +=
+        jlite_get_value_bool(&file_obj, lazy_keys[i], &bool_test) !=
+        lazy_rets[2] || bool_test != lazy_bool;
+    printf(" %s %d %d %d", lazy_keys[i], lazy_rets[0], lazy_rets[1],
+        lazy_rets[2]);
+  }
+  printf(" MISMATCHES %d\r\n", lazy_mismatches);
+
+  /* Elements of mixed shapes, each holding its own position. */
+  static char index_str[8192];
+  static jlitetok_t index_tokens[2048];
+  jsmnint_t index_mem[16];
+  jlite_index_t index;
+  int index_wrong[2] = {0, 0};
+  int index_len = 0;
+  int j = 0;
+
+  index_len = snprintf(index_str, sizeof(index_str), "{\"list\":[");
+  for (i = 0; i < 100; i++)
+  {
+    index_len += snprintf(index_str + index_len,
+        sizeof(index_str) - (size_t) index_len, i % 3 == 0 ?
+        "{\"n\":%d,\"x\":[1,{\"y\":[2]}]}," : i % 3 == 1 ? "[%d,[0,[0]]]," :
+        "%d,", i);
+  }
+  index_str[index_len - 1] = ']';
+  index_str[index_len++] = '}';
+  ret = jlite_parse_init(&file_obj, index_tokens, 2048, index_str, index_len);
+  ret |= jlite_get_json_array(&file_obj, "list", &size);
+  for (j = 0; j < 2; j++)
+  {
+    if (j)
+    {
+      ret |= jlite_index_build(&file_obj, &index, index_mem,
+          sizeof(index_mem), 0);
+    }
+    for (i = size - 1; i >= 0; i--)
+    {
+      value_int = -1;
+      if (i % 3 == 0)
+      {
+        ret |= jlite_get_array_element_object(&file_obj, i);
+        ret |= jlite_get_value_int(&file_obj, "n", &value_int);
+        ret |= jlite_release_array_element_object(&file_obj);
+      }
+      else if (i % 3 == 1)
+      {
+        ret |= jlite_get_array_element_array(&file_obj, i, &value_int);
+        ret |= jlite_get_json_array_element_int(&file_obj, 0, &value_int);
+        ret |= jlite_release_array_element_array(&file_obj);
+      }
+      else
+      {
+        ret |= jlite_get_json_array_element_int(&file_obj, i, &value_int);
+      }
+      index_wrong[j] += value_int != i;
+    }
+  }
+  printf("INDEX RET %d SIZE %d STRIDE %d ENTRIES %d WRONG %d %d\r\n", ret,
+      size, index.stride, index.num_entries, index_wrong[0], index_wrong[1]);
+  ret = jlite_get_json_array_element_int(&file_obj, size, &value_int);
+  printf("INDEX PAST END RET %d\r\n", ret);
+  ret = jlite_index_build(&file_obj, &index, index_mem, sizeof(index_mem),
+      5);
+  printf("INDEX SMALL STRIDE RET %d\r\n", ret);
+  ret = jlite_index_build(&file_obj, &index, index_mem, sizeof(index_mem),
+      10);
+  ret |= jlite_get_json_array_element_int(&file_obj, 98, &value_int);
+  printf("INDEX RETUNE RET %d STRIDE %d VALUE %d\r\n", ret, index.stride,
+      value_int);
+  ret = jlite_index_drop(&file_obj, &index);
+  printf("INDEX DROP RET %d", ret);
+  ret = jlite_index_drop(&file_obj, &index);
+  printf(" AGAIN %d\r\n", ret);
+
+  static const char *intern_records[] = {
+    "{\"id\":1,\"user\":{\"id\":7,\"name\":\"a\"},\"tags\":[\"id\"]}",
+    "{\"user\":{\"name\":\"b\",\"id\":8},\"id\":2}",
+    "{\"id\":3,\"extra\":true,\"user\":{\"id\":9}}"
+  };
+  jlite_intern_entry_t intern_entries[16];
+  jlite_key_id_t intern_ids[200];
+  char intern_keys[64];
+  jlite_intern_t intern;
+  jlite_intern_stats_t intern_stats;
+  jliteobj_t intern_obj;
+  const char *intern_key = NULL;
+  size_t intern_len = 0;
+  unsigned long intern_count = 0;
+  int intern_sum = 0;
+  int num_keys = 0;
+
+  ret = jlite_intern_init(&intern, intern_entries, 16, intern_keys,
+      sizeof(intern_keys));
+  for (i = 0; i < 3; i++)
+  {
+    ret |= jlite_parse_init(&intern_obj, tokens, 200,
+        (char *) intern_records[i], (int) strlen(intern_records[i]));
+    ret |= jlite_intern_document(&intern, &intern_obj, intern_ids, 200);
+    ret |= jlite_get_value_int(&intern_obj, "id", &value_int);
+    intern_sum += value_int;
+    ret |= jlite_get_json_object(&intern_obj, "user");
+    ret |= jlite_get_value_int(&intern_obj, "id", &value_int);
+    intern_sum += value_int * 10;
+    ret |= jlite_release_json_object(&intern_obj);
+  }
+  printf("INTERN RET %d SUM %d", ret, intern_sum);
+  ret = jlite_get_value_int(&intern_obj, "name", &value_int);
+  printf(" ABSENT %d", ret);
+  ret = jlite_get_value_int(&intern_obj, "never", &value_int);
+  printf(" UNKNOWN %d\r\n", ret);
+  ret = jlite_intern_get_key(&intern, jlite_intern_find(&intern, "id", 2),
+      &intern_key, &intern_len, &intern_count);
+  ret |= jlite_intern_get_stats(&intern, &intern_stats, &num_keys);
+  printf("INTERN KEY RET %d %.*s COUNT %lu KEYS %d DOCS %lu TOTAL %lu\r\n",
+      ret, (int) intern_len, intern_key, intern_count, num_keys,
+      intern_stats.documents, intern_stats.keys);
+  ret = jlite_intern_init(&intern, intern_entries, 4, intern_keys, 4);
+  ret |= jlite_intern_document(&intern, &intern_obj, intern_ids, 200);
+  printf("INTERN FULL RET %d", ret);
+  ret = jlite_get_value_int(&intern_obj, "id", &value_int);
+  printf(" SCAN %d %d\r\n", ret, value_int);
+
+  jsmn_parser parser;
+  jsmntok_compact_t compact[200];
+
+  jsmn_init(&parser);
+  ret = jsmn_parse_count(&parser, j_str, j_str_len, NULL, 0);
+  printf("TOKENIZE COUNT %d\r\n", ret);
+
+  jsmn_init(&parser);
+  ret = jsmn_parse_compact(&parser, j_str, j_str_len, compact, 200);
+  printf("TOKENIZE COMPACT %d ROOT TYPE %d SIZE %d\r\n", ret,
+      JSMN_COMPACT_TYPE(&compact[0]), JSMN_COMPACT_SIZE(&compact[0]));
+
+  jsmn_init(&parser);
+  ret = jsmn_parse_strict(&parser, "{\"a\":x}", 7, tokens, 200);
+  printf("TOKENIZE STRICT BARE WORD %d\r\n", ret);
+
+  /* Rejected by -DJSMN_STRICT builds only, as jsmn_parse does. */
+  char bare_word[] = "{\"a\": xyz}";
+  jliteobj_t bare_obj;
+
+  ret = jlite_parse_init(&bare_obj, tokens, 200, bare_word,
+      (int) strlen(bare_word));
+  printf("PARSE BARE WORD %d", ret);
+  deflated_len = sizeof(deflated);
+  compress2(deflated, &deflated_len, (const Bytef *) bare_word,
+      strlen(bare_word), 9);
+  ret = jlite_inflate_parse_buffer(&bare_obj, tokens, 200, msgpack_text,
+      sizeof(msgpack_text), deflated, deflated_len, 0);
+  printf(" INFLATE %d\r\n", ret);
+
+#if JLITE_STATS
+  jlite_stats_t stats;
+
+  ret = jlite_get_stats(&jsonobj, &stats);
+  if (ret != JLITE_OK)
+  {
+    printf("Get stats ret %d\r\n", ret);
+  }
+  else
+  {
+    printf("STATS tokens %lu bytes %lu lookups %lu visited %lu max %lu "
+        "cmps %lu skips %lu depth %lu walks %lu\r\n", stats.tokens_produced,
+        stats.parse_bytes, stats.lookups, stats.tokens_visited,
+        stats.max_lookup_tokens, stats.key_comparisons, stats.skip_calls,
+        stats.max_skip_depth, stats.array_walks);
+  }
+#endif
+
   return 0;
 }
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cstring>
+#include "../jlite/jlite.hpp"
+#include "../jlite/jlite_bind.hpp"
+
+#define TEST_J_STR "{\"name\":\"johndoe\",\"id\":9007199254740993,\"ratio\":0.25,\"ok\":true,\"nested\":{\"list\":[[1,2],{\"a\":1},3]},\"tags\":[\"x\",\"y\",\"z\"],\"small\":300}"
+
+#define TEST_BIND_STR "{\"name\":\"tri\",\"unknown\":{\"x\":[1]},\"points\":[{\"x\":1,\"y\":2},{\"y\":4,\"x\":3},{\"x\":5,\"y\":6}],\"scale\":1.5,\"origin\":null}"
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct shape
+{
+  std::string name;
+  std::vector<point> points;
+  std::optional<double> scale;
+  std::optional<point> origin;
+};
+
+JLITE_BIND(point, x, y)
+JLITE_BIND(shape, name, points, scale, origin)
+
+int main(void)
+{
+  jlite::fixed_document<64> doc;
+  int ret = 0;
+
+  ret = doc.parse(TEST_J_STR);
+  if (ret != JLITE_OK)
+  {
+    printf("PARSE INIT RET IS %d\r\n", ret);
+    return 1;
+  }
+
+  std::string_view name = doc["name"].get_or<std::string_view>("");
+  printf("name %.*s\r\n", (int)name.size(), name.data());
+  printf("id %lld\r\n", (long long)doc["id"].get_or<int64_t>(0));
+  printf("ratio %g\r\n", doc["ratio"].get_or(0.0));
+  printf("ok %d\r\n", doc["ok"].get_or(false));
+  printf("nested list[2] %d\r\n", doc["nested"]["list"][2].get_or(0));
+  printf("nested list[1].a %d\r\n", doc["nested"]["list"][1]["a"].get_or(0));
+
+  /* Errors are reported as jlite error codes. */
+  printf("missing key ret %d\r\n", doc["nope"]["deeper"].get<int>().error());
+  printf("name as int ret %d\r\n", doc["name"].get<int>().error());
+  printf("small as int8 ret %d\r\n", doc["small"].get<int8_t>().error());
+  printf("kinds %d %d %d %d\r\n", doc["id"].kind(), doc["ratio"].kind(),
+      doc["ok"].kind(), doc["name"].kind());
+
+  printf("tags:");
+  for (jlite::value tag : doc["tags"])
+  {
+    std::string_view s = tag.get_or<std::string_view>("");
+    printf(" %.*s", (int)s.size(), s.data());
+  }
+  printf("\r\n");
+
+  printf("keys:");
+  for (const jlite::member &m : doc.root().members())
+  {
+    printf(" %.*s", (int)m.key().size(), m.key().data());
+  }
+  printf("\r\n");
+
+  jlite::fixed_document<64> bind_doc;
+  shape s;
+
+  ret = bind_doc.parse(TEST_BIND_STR);
+  if (ret == JLITE_OK)
+  {
+    ret = jlite::decode(bind_doc, s);
+  }
+  printf("bind ret %d name %s scale %g origin %d points:", ret, s.name.c_str(),
+      s.scale.value_or(0), (int)s.origin.has_value());
+  for (const point &p : s.points)
+  {
+    printf(" (%d,%d)", p.x, p.y);
+  }
+  printf("\r\n");
+
+  jlite_intern_entry_t intern_entries[16];
+  jlite_key_id_t intern_ids[64];
+  char intern_keys[64];
+  jlite_intern_t intern;
+  shape interned;
+
+  ret = jlite_intern_init(&intern, intern_entries, 16, intern_keys,
+      sizeof(intern_keys));
+  ret |= jlite_intern_document(&intern, bind_doc.c_obj(), intern_ids, 64);
+  ret |= jlite::decode(bind_doc, interned);
+  printf("bind interned ret %d name %s points %d last (%d,%d) find %d\r\n",
+      ret, interned.name.c_str(), (int)interned.points.size(),
+      interned.points.back().x, interned.points.back().y,
+      bind_doc.root()["scale"].get_or<double>(0) == 1.5);
+
+  return 0;
+}
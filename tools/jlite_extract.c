@@ -0,0 +1,595 @@
+/*
+ * @file jlite_extract.c
+ * @brief Extract fields from NDJSON files with compiled JSONPath queries.
+ *
+ * Build from the repository root by compiling this file with every .c file
+ * of jlite/ and jlite/jsmn/, see README.md.
+ *
+ * The input is mapped read-only and cut into blocks of whole records. Worker
+ * threads take blocks in order, parse every record with jlite_parse_init()
+ * and run each query with jlite_query_run(), keeping the first match. Each
+ * block is formatted into its own buffer and written with one write() in
+ * block order, so the output is the same for any thread count. At most
+ * EXTRACT_SLOTS_PER_THREAD blocks per thread are in flight, which bounds
+ * memory however large the input is.
+ *
+ * Output is one line per record: tab-separated raw values (strings without
+ * their quotes, escapes kept, an empty field for no match), or with -j a
+ * JSON object keyed by the query text (null for no match). Records which do
+ * not parse are skipped and counted; -v prints the counts and throughput on
+ * stderr.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "../jlite/jlite.h"
+#include "../jlite/jlite_query.h"
+
+#define EXTRACT_MAX_QUERIES 64
+#define EXTRACT_MAX_THREADS 256
+#define EXTRACT_SLOTS_PER_THREAD 2
+#define EXTRACT_DEFAULT_BLOCK (4 << 20)
+#define EXTRACT_INITIAL_TOKENS 1024
+
+typedef struct
+{
+  char *data;
+  size_t len;
+  size_t cap;
+} extract_buf_t;
+
+typedef struct
+{
+  extract_buf_t out;
+  int ready;
+  long records;
+  long errors;
+} extract_slot_t;
+
+typedef struct
+{
+  const char *map;
+  size_t size;
+  size_t block_size;
+  long num_blocks;
+  jlite_query_t queries[EXTRACT_MAX_QUERIES];
+  char *labels[EXTRACT_MAX_QUERIES];
+  int num_queries;
+  int json_lines;
+
+  /* Shared between the workers and the writer, under lock. */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  long next_block;
+  long written;
+  int failed;
+  extract_slot_t *slots;
+  int num_slots;
+} extract_ctx_t;
+
+typedef struct
+{
+  jliteobj_t obj;
+  jlitetok_t *tokens;
+  int max_tokens;
+} extract_worker_t;
+
+static uint64_t extract_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static int extract_reserve(extract_buf_t *buf, size_t len)
+{
+  size_t cap = buf->cap ? buf->cap : 1 << 16;
+  char *data = NULL;
+
+  if (buf->len + len <= buf->cap)
+  {
+    return 0;
+  }
+  while (cap < buf->len + len)
+  {
+    cap *= 2;
+  }
+  data = realloc(buf->data, cap);
+  if (!data)
+  {
+    return -1;
+  }
+  buf->data = data;
+  buf->cap = cap;
+  return 0;
+}
+
+static int extract_append(extract_buf_t *buf, const char *str, size_t len)
+{
+  if (extract_reserve(buf, len) != 0)
+  {
+    return -1;
+  }
+  memcpy(buf->data + buf->len, str, len);
+  buf->len += len;
+  return 0;
+}
+
+/*
+ * Offset of the first record starting at or after off: the start of the
+ * file or the byte after a newline. Blocks are cut there, so every worker
+ * finds its records without looking at the others.
+ */
+static size_t extract_record_start(const char *map, size_t size, size_t off)
+{
+  const char *nl = NULL;
+
+  if (off == 0 || off >= size)
+  {
+    return off < size ? off : size;
+  }
+  nl = memchr(map + off - 1, '\n', size - (off - 1));
+  return nl ? (size_t) (nl - map) + 1 : size;
+}
+
+/* Query callback: keep the first match and stop. */
+static int extract_first_match(jliteobj_t *jsonobj, int pos, void *ctx)
+{
+  (void) jsonobj;
+  *(int *) ctx = pos;
+  return 1;
+}
+
+/*
+ * Parse one record, growing the token buffer until it fits. Returns
+ * JLITE_OK or the errcode of the parse.
+ */
+static int extract_parse(extract_worker_t *w, const char *rec, int len)
+{
+  jlitetok_t *tokens = NULL;
+  int ret = 0;
+
+  for (;;)
+  {
+    ret = jlite_parse_init(&w->obj, w->tokens, w->max_tokens, (char *) rec,
+        len);
+    if (ret == JLITE_OK || (int) w->obj.j_parser.toknext < w->max_tokens)
+    {
+      return ret;
+    }
+    tokens = realloc(w->tokens, sizeof(*tokens) * (size_t) w->max_tokens * 2);
+    if (!tokens)
+    {
+      return -JLITE_E_NO_BUFFER_MEM;
+    }
+    w->tokens = tokens;
+    w->max_tokens *= 2;
+  }
+}
+
+static int extract_value(extract_ctx_t *ctx, extract_worker_t *w, int pos,
+    extract_buf_t *out)
+{
+  const jlitetok_t *tok = &w->obj.tokens[pos];
+  const char *str = w->obj.jsonstr + tok->start;
+  size_t len = (size_t) (tok->end - tok->start);
+
+  /* JSON output keeps strings quoted, tab-separated output drops quotes. */
+  if (ctx->json_lines && tok->type == JSMN_STRING)
+  {
+    str--;
+    len += 2;
+  }
+  return extract_append(out, str, len);
+}
+
+static int extract_record(extract_ctx_t *ctx, extract_worker_t *w,
+    extract_buf_t *out)
+{
+  int match = 0;
+  int ret = 0;
+  int q = 0;
+
+  for (q = 0; q < ctx->num_queries; q++)
+  {
+    if (ctx->json_lines)
+    {
+      ret |= extract_append(out, q ? "," : "{", 1);
+      ret |= extract_append(out, ctx->labels[q], strlen(ctx->labels[q]));
+    }
+    else if (q)
+    {
+      ret |= extract_append(out, "\t", 1);
+    }
+
+    match = -1;
+    w->obj.cur_pos = 1;
+    jlite_query_run(&ctx->queries[q], &w->obj, extract_first_match, &match,
+        NULL);
+    if (match >= 0)
+    {
+      ret |= extract_value(ctx, w, match, out);
+    }
+    else if (ctx->json_lines)
+    {
+      ret |= extract_append(out, "null", 4);
+    }
+  }
+  ret |= extract_append(out, ctx->json_lines ? "}\n" : "\n",
+      ctx->json_lines ? 2 : 1);
+  return ret;
+}
+
+static int extract_block(extract_ctx_t *ctx, extract_worker_t *w, long block,
+    extract_slot_t *slot)
+{
+  size_t off = extract_record_start(ctx->map, ctx->size,
+      (size_t) block * ctx->block_size);
+  size_t end = extract_record_start(ctx->map, ctx->size,
+      (size_t) (block + 1) * ctx->block_size);
+  const char *rec = NULL;
+  const char *nl = NULL;
+  int len = 0;
+
+  slot->out.len = 0;
+  slot->records = 0;
+  slot->errors = 0;
+  while (off < end)
+  {
+    rec = ctx->map + off;
+    nl = memchr(rec, '\n', end - off);
+    len = (int) (nl ? nl - rec : (long) (end - off));
+    off += (size_t) len + 1;
+    if (len > 0 && rec[len - 1] == '\r')
+    {
+      len--;
+    }
+    if (len == 0)
+    {
+      continue;
+    }
+
+    slot->records++;
+    if (extract_parse(w, rec, len) != JLITE_OK)
+    {
+      slot->errors++;
+      continue;
+    }
+    if (extract_record(ctx, w, &slot->out) != 0)
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void *extract_worker(void *arg)
+{
+  extract_ctx_t *ctx = arg;
+  extract_worker_t w;
+  extract_slot_t *slot = NULL;
+  long block = 0;
+  int ret = 0;
+
+  memset(&w, 0, sizeof(w));
+  w.max_tokens = EXTRACT_INITIAL_TOKENS;
+  w.tokens = malloc(sizeof(*w.tokens) * (size_t) w.max_tokens);
+
+  for (;;)
+  {
+    pthread_mutex_lock(&ctx->lock);
+    block = ctx->next_block++;
+    /* Wait until the writer has drained the slot of this block. */
+    while (!ctx->failed && block < ctx->num_blocks &&
+        block - ctx->written >= ctx->num_slots)
+    {
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    }
+    if (ctx->failed || block >= ctx->num_blocks)
+    {
+      pthread_mutex_unlock(&ctx->lock);
+      break;
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    slot = &ctx->slots[block % ctx->num_slots];
+    ret = w.tokens ? extract_block(ctx, &w, block, slot) : -1;
+
+    pthread_mutex_lock(&ctx->lock);
+    if (ret != 0)
+    {
+      ctx->failed = 1;
+    }
+    slot->ready = 1;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+  }
+
+  free(w.tokens);
+  return NULL;
+}
+
+static int extract_write(int fd, const char *data, size_t len)
+{
+  ssize_t n = 0;
+
+  while (len)
+  {
+    n = write(fd, data, len);
+    if (n < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (n <= 0)
+    {
+      return -1;
+    }
+    data += n;
+    len -= (size_t) n;
+  }
+  return 0;
+}
+
+/* Write the blocks in order as the workers finish them. */
+static int extract_drain(extract_ctx_t *ctx, int fd, long *records,
+    long *errors)
+{
+  extract_slot_t *slot = NULL;
+  long block = 0;
+  int ret = 0;
+
+  for (block = 0; block < ctx->num_blocks && !ret; block++)
+  {
+    slot = &ctx->slots[block % ctx->num_slots];
+    pthread_mutex_lock(&ctx->lock);
+    while (!slot->ready && !ctx->failed)
+    {
+      pthread_cond_wait(&ctx->cond, &ctx->lock);
+    }
+    ret = ctx->failed ? -1 : 0;
+    pthread_mutex_unlock(&ctx->lock);
+
+    if (!ret)
+    {
+      ret = extract_write(fd, slot->out.data, slot->out.len);
+      *records += slot->records;
+      *errors += slot->errors;
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    slot->ready = 0;
+    ctx->written = block + 1;
+    if (ret)
+    {
+      ctx->failed = 1;
+    }
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+  }
+  return ret;
+}
+
+/* JSON object key for a query: its text, quoted and escaped. */
+static char *extract_label(const char *expr)
+{
+  size_t len = strlen(expr);
+  char *label = malloc(len * 2 + 4);
+  char *p = label;
+
+  if (!label)
+  {
+    return NULL;
+  }
+  *p++ = '"';
+  for (; *expr; expr++)
+  {
+    if (*expr == '"' || *expr == '\\')
+    {
+      *p++ = '\\';
+    }
+    *p++ = *expr;
+  }
+  *p++ = '"';
+  *p++ = ':';
+  *p = '\0';
+  return label;
+}
+
+static void extract_usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-t threads] [-b block_kb] [-j] [-o out] [-v] "
+      "file query [query...]\n"
+      "  queries are JSONPath, e.g. '$.user.id' or '$..name'\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+  static extract_ctx_t ctx;
+  pthread_t threads[EXTRACT_MAX_THREADS];
+  const char *out_path = NULL;
+  struct stat st;
+  uint64_t t0 = 0;
+  double secs = 0;
+  long records = 0;
+  long errors = 0;
+  long block_kb = 0;
+  int num_threads = 0;
+  int verbose = 0;
+  int err_offset = 0;
+  int started = 0;
+  int out_fd = STDOUT_FILENO;
+  int fd = -1;
+  int ret = 0;
+  int opt = 0;
+  int i = 0;
+
+  num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  ctx.block_size = EXTRACT_DEFAULT_BLOCK;
+  while ((opt = getopt(argc, argv, "t:b:jo:vh")) != -1)
+  {
+    switch (opt)
+    {
+      case 't':
+        num_threads = atoi(optarg);
+        break;
+      case 'b':
+        block_kb = atol(optarg);
+        if (block_kb <= 0)
+        {
+          extract_usage(argv[0]);
+          return 2;
+        }
+        ctx.block_size = (size_t) block_kb << 10;
+        break;
+      case 'j':
+        ctx.json_lines = 1;
+        break;
+      case 'o':
+        out_path = optarg;
+        break;
+      case 'v':
+        verbose = 1;
+        break;
+      default:
+        extract_usage(argv[0]);
+        return opt == 'h' ? 0 : 2;
+    }
+  }
+
+  if (argc - optind < 2 || argc - optind - 1 > EXTRACT_MAX_QUERIES)
+  {
+    extract_usage(argv[0]);
+    return 2;
+  }
+  if (num_threads < 1)
+  {
+    num_threads = 1;
+  }
+  if (num_threads > EXTRACT_MAX_THREADS)
+  {
+    num_threads = EXTRACT_MAX_THREADS;
+  }
+
+  for (i = optind + 1; i < argc; i++)
+  {
+    ret = jlite_query_compile(&ctx.queries[ctx.num_queries], argv[i],
+        &err_offset);
+    if (ret != JLITE_OK)
+    {
+      fprintf(stderr, "bad query %s at offset %d\n", argv[i], err_offset);
+      return 2;
+    }
+    ctx.labels[ctx.num_queries] = extract_label(argv[i]);
+    if (!ctx.labels[ctx.num_queries])
+    {
+      return 1;
+    }
+    ctx.num_queries++;
+  }
+
+  fd = open(argv[optind], O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) != 0)
+  {
+    fprintf(stderr, "cannot open %s\n", argv[optind]);
+    return 1;
+  }
+  ctx.size = (size_t) st.st_size;
+  if (ctx.size)
+  {
+    ctx.map = mmap(NULL, ctx.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ctx.map == MAP_FAILED)
+    {
+      fprintf(stderr, "cannot map %s\n", argv[optind]);
+      return 1;
+    }
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise((void *) ctx.map, ctx.size, POSIX_MADV_SEQUENTIAL);
+#endif
+  }
+  close(fd);
+
+  if (out_path)
+  {
+    out_fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0)
+    {
+      fprintf(stderr, "cannot open %s\n", out_path);
+      return 1;
+    }
+  }
+
+  ctx.num_blocks = (long) ((ctx.size + ctx.block_size - 1) / ctx.block_size);
+  ctx.num_slots = num_threads * EXTRACT_SLOTS_PER_THREAD;
+  ctx.slots = calloc((size_t) ctx.num_slots, sizeof(*ctx.slots));
+  if (!ctx.slots)
+  {
+    return 1;
+  }
+  pthread_mutex_init(&ctx.lock, NULL);
+  pthread_cond_init(&ctx.cond, NULL);
+
+  t0 = extract_now_ns();
+  for (started = 0; started < num_threads; started++)
+  {
+    if (pthread_create(&threads[started], NULL, extract_worker, &ctx) != 0)
+    {
+      break;
+    }
+  }
+  if (started)
+  {
+    ret = extract_drain(&ctx, out_fd, &records, &errors);
+  }
+  else
+  {
+    ret = -1;
+  }
+  for (i = 0; i < started; i++)
+  {
+    pthread_join(threads[i], NULL);
+  }
+  secs = (double) (extract_now_ns() - t0) / 1e9;
+
+  if (ret != 0)
+  {
+    fprintf(stderr, "extraction failed: %s\n", started ? "write or memory" :
+        "cannot start threads");
+  }
+  if (verbose)
+  {
+    fprintf(stderr, "%ld records, %ld not parsed, %zu bytes in %.3f s "
+        "(%.1f MB/s, %d threads)\n", records, errors, ctx.size, secs,
+        secs > 0 ? (double) ctx.size / secs / 1e6 : 0.0, started);
+  }
+
+  for (i = 0; i < ctx.num_slots; i++)
+  {
+    free(ctx.slots[i].out.data);
+  }
+  free(ctx.slots);
+  for (i = 0; i < ctx.num_queries; i++)
+  {
+    free(ctx.labels[i]);
+  }
+  if (ctx.size)
+  {
+    munmap((void *) ctx.map, ctx.size);
+  }
+  if (out_fd != STDOUT_FILENO)
+  {
+    close(out_fd);
+  }
+  return ret ? 1 : 0;
+}